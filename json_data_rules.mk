@@ -1,15 +1,22 @@
 # JSON files are run through jsonproc, which is a tool that converts JSON data to an output file
 # based on an Inja template. https://github.com/pantor/inja
 
-AUTO_GEN_TARGETS += $(DATA_C_SUBDIR)/items.h
+JSON_OUTPUTS := $(DATA_C_SUBDIR)/items.h $(DATA_C_SUBDIR)/wild_encounters.h
+AUTO_GEN_TARGETS += $(JSON_OUTPUTS)
 
-$(DATA_C_SUBDIR)/items.h: $(DATA_C_SUBDIR)/items.json $(DATA_C_SUBDIR)/items.json.txt
-	$(JSONPROC) $^ $@
+# Both headers are rendered by one jsonproc --batch run. jsonproc only
+# rewrites a header whose text changes, so touching a JSON file without
+# changing what it renders doesn't rebuild the objects that include it; the
+# stamp records that the run happened, so it isn't repeated on every make.
+JSON_STAMP := $(C_BUILDDIR)/json_data.stamp
 
-$(C_BUILDDIR)/item.o: c_dep += $(DATA_C_SUBDIR)/items.h
+$(JSON_STAMP): $(DATA_C_SUBDIR)/items.json $(DATA_C_SUBDIR)/items.json.txt $(DATA_C_SUBDIR)/wild_encounters.json $(DATA_C_SUBDIR)/wild_encounters.json.txt
+	$(JSONPROC) --batch $(DATA_C_SUBDIR)/items.json $(DATA_C_SUBDIR)/items.json.txt $(DATA_C_SUBDIR)/items.h \
+		$(DATA_C_SUBDIR)/wild_encounters.json $(DATA_C_SUBDIR)/wild_encounters.json.txt $(DATA_C_SUBDIR)/wild_encounters.h
+	@touch $@
+$(JSON_OUTPUTS): $(JSON_STAMP) ;
 
-AUTO_GEN_TARGETS += $(DATA_C_SUBDIR)/wild_encounters.h
-$(DATA_C_SUBDIR)/wild_encounters.h: $(DATA_C_SUBDIR)/wild_encounters.json $(DATA_C_SUBDIR)/wild_encounters.json.txt
-	$(JSONPROC) $^ $@
-
-$(C_BUILDDIR)/wild_encounter.o: c_dep += $(DATA_C_SUBDIR)/wild_encounters.h
+# As with the map outputs, rerun jsonproc if a header has been deleted.
+ifneq ($(filter-out $(wildcard $(JSON_OUTPUTS)),$(JSON_OUTPUTS)),)
+.PHONY: $(JSON_STAMP)
+endif
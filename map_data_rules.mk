@@ -3,15 +3,26 @@
 MAPS_DIR = $(DATA_ASM_SUBDIR)/maps
 LAYOUTS_DIR = $(DATA_ASM_SUBDIR)/layouts
 
-MAP_DIRS := $(dir $(wildcard $(MAPS_DIR)/*/map.json))
+MAP_JSONS := $(wildcard $(MAPS_DIR)/*/map.json)
+MAP_DIRS := $(dir $(MAP_JSONS))
 MAP_CONNECTIONS := $(patsubst $(MAPS_DIR)/%/,$(MAPS_DIR)/%/connections.inc,$(MAP_DIRS))
 MAP_EVENTS := $(patsubst $(MAPS_DIR)/%/,$(MAPS_DIR)/%/events.inc,$(MAP_DIRS))
 MAP_HEADERS := $(patsubst $(MAPS_DIR)/%/,$(MAPS_DIR)/%/header.inc,$(MAP_DIRS))
 
-$(MAPS_DIR)/%/header.inc: $(MAPS_DIR)/%/map.json
-	$(MAPJSON) map firered $< $(LAYOUTS_DIR)/layouts.json
-$(MAPS_DIR)/%/events.inc: $(MAPS_DIR)/%/header.inc ;
-$(MAPS_DIR)/%/connections.inc: $(MAPS_DIR)/%/events.inc ;
+# All maps are generated by one mapjson run, which reads layouts.json once.
+MAPS_STAMP := $(DATA_ASM_BUILDDIR)/maps.stamp
+
+$(MAPS_STAMP): $(MAP_JSONS) $(LAYOUTS_DIR)/layouts.json
+	$(MAPJSON) maps firered $(LAYOUTS_DIR)/layouts.json $(MAP_JSONS)
+	@touch $@
+$(MAP_HEADERS) $(MAP_EVENTS) $(MAP_CONNECTIONS): $(MAPS_STAMP) ;
+
+# The outputs have no recipe of their own, so if any has been deleted, rerun
+# mapjson even though the stamp is up to date.
+MAP_OUTPUTS := $(MAP_HEADERS) $(MAP_EVENTS) $(MAP_CONNECTIONS)
+ifneq ($(filter-out $(wildcard $(MAP_OUTPUTS)),$(MAP_OUTPUTS)),)
+.PHONY: $(MAPS_STAMP)
+endif
 
 $(MAPS_DIR)/groups.inc: $(MAPS_DIR)/map_groups.json
 	$(MAPJSON) groups firered $<
@@ -1,829 +1,288 @@
 STD_REVERB = 50
 
+# mid2agb writes each song's object file itself. With MIDI_ASM=1 it writes
+# assembly for the assembler instead, as it used to. Both give the same bytes;
+# tools/mid2agb/objcheck.sh compares them.
+ifeq ($(MIDI_ASM),1)
 $(MID_BUILDDIR)/%.o: $(MID_SUBDIR)/%.s
 	$(AS) $(ASFLAGS) -I sound -o $@ $<
-
-$(MID_SUBDIR)/mus_rocket_hideout.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G133 -V090
-
-$(MID_SUBDIR)/mus_follow_me.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G131 -V068
-
-$(MID_SUBDIR)/mus_rs_vs_trainer.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G011 -V080 -P1
-
-$(MID_SUBDIR)/mus_rs_vs_gym_leader.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G010 -V080
-
-$(MID_SUBDIR)/mus_victory_road.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G154 -V090
-
-$(MID_SUBDIR)/mus_cycling.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G141 -V090
-
-$(MID_SUBDIR)/mus_intro_fight.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G136 -V090
-
-$(MID_SUBDIR)/mus_hall_of_fame.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G145 -V079
-
-$(MID_SUBDIR)/mus_encounter_deoxys.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G184 -V079
-
-$(MID_SUBDIR)/mus_dummy.s: %.s: %.mid
-	$(MID) $< $@ -E -R40
-
-$(MID_SUBDIR)/mus_credits.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G149 -V090
-
-$(MID_SUBDIR)/mus_encounter_gym_leader.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G144 -V090
-
-$(MID_SUBDIR)/mus_dex_rating.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G175 -V070 -P5
-
-$(MID_SUBDIR)/mus_obtain_key_item.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G178 -V077 -P5
-
-$(MID_SUBDIR)/mus_caught_intro.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G179 -V094 -P5
-
-$(MID_SUBDIR)/mus_level_up.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_obtain_item.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_evolved.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_caught.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G170 -V100
-
-$(MID_SUBDIR)/mus_cinnabar.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G138 -V090
-
-$(MID_SUBDIR)/mus_gym.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G134 -V090
-
-$(MID_SUBDIR)/mus_fuchsia.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G167 -V090
-
-$(MID_SUBDIR)/mus_poke_jump.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G132 -V090
-
-$(MID_SUBDIR)/mus_heal_unused.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G140 -V090
-
-$(MID_SUBDIR)/mus_oak_lab.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G160 -V075
-
-$(MID_SUBDIR)/mus_berry_pick.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G132 -V090
-
-$(MID_SUBDIR)/mus_vermillion.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G172 -V090
-
-$(MID_SUBDIR)/mus_route1.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G150 -V079
-
-$(MID_SUBDIR)/mus_route3.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G152 -V083
-
-$(MID_SUBDIR)/mus_route11.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G153 -V090
-
-$(MID_SUBDIR)/mus_pallet.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G159 -V100
-
-$(MID_SUBDIR)/mus_heal.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_slots_jackpot.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V100 -P5
-
-$(MID_SUBDIR)/mus_slots_win.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V100 -P5
-
-$(MID_SUBDIR)/mus_obtain_badge.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_obtain_berry.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_photo.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G180 -V100 -P5
-
-$(MID_SUBDIR)/mus_evolution_intro.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G009 -V080 -P1
-
-$(MID_SUBDIR)/mus_move_deleted.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_obtain_tmhm.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_too_bad.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G008 -V090 -P5
-
-$(MID_SUBDIR)/mus_surf.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G164 -V071
-
-$(MID_SUBDIR)/mus_sevii_123.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G173 -V084
-
-$(MID_SUBDIR)/mus_sevii_45.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G188 -V084
-
-$(MID_SUBDIR)/mus_sevii_67.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G189 -V084
-
-$(MID_SUBDIR)/mus_sevii_cave.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G147 -V090
-
-$(MID_SUBDIR)/mus_sevii_dungeon.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G146 -V090
-
-$(MID_SUBDIR)/mus_sevii_route.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G187 -V080
-
-$(MID_SUBDIR)/mus_net_center.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G162 -V096
-
-$(MID_SUBDIR)/mus_pewter.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G173 -V084
-
-$(MID_SUBDIR)/mus_oak.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G161 -V086
-
-$(MID_SUBDIR)/mus_mystery_gift.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G183 -V100
-
-$(MID_SUBDIR)/mus_route24.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G151 -V086
-
-$(MID_SUBDIR)/mus_teachy_tv_show.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G131 -V068
-
-$(MID_SUBDIR)/mus_mt_moon.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G147 -V090
-
-$(MID_SUBDIR)/mus_school.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G012 -V100 -P1
-
-$(MID_SUBDIR)/mus_poke_tower.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G165 -V090
-
-$(MID_SUBDIR)/mus_poke_center.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G162 -V096
-
-$(MID_SUBDIR)/mus_poke_flute.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G165 -V048 -P5
-
-$(MID_SUBDIR)/mus_poke_mansion.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G148 -V090
-
-$(MID_SUBDIR)/mus_jigglypuff.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G135 -V068 -P5
-
-$(MID_SUBDIR)/mus_encounter_rival.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G174 -V079
-
-$(MID_SUBDIR)/mus_rival_exit.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G174 -V079
-
-$(MID_SUBDIR)/mus_encounter_rocket.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G142 -V096
-
-$(MID_SUBDIR)/mus_ss_anne.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G163 -V090
-
-$(MID_SUBDIR)/mus_new_game_exit.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G182 -V088
-
-$(MID_SUBDIR)/mus_new_game_intro.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G182 -V088
-
-$(MID_SUBDIR)/mus_evolution.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G009 -V080 -P1
-
-$(MID_SUBDIR)/mus_lavender.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G139 -V090
-
-$(MID_SUBDIR)/mus_silph.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G166 -V076
-
-$(MID_SUBDIR)/mus_encounter_girl.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G143 -V051
-
-$(MID_SUBDIR)/mus_encounter_boy.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G144 -V090
-
-$(MID_SUBDIR)/mus_game_corner.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G132 -V090
-
-$(MID_SUBDIR)/mus_slow_pallet.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G159 -V092
-
-$(MID_SUBDIR)/mus_new_game_instruct.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G182 -V085
-
-$(MID_SUBDIR)/mus_viridian_forest.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G146 -V090
-
-$(MID_SUBDIR)/mus_trainer_tower.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G134 -V090
-
-$(MID_SUBDIR)/mus_celadon.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G168 -V070
-
-$(MID_SUBDIR)/mus_title.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G137 -V090
-
-$(MID_SUBDIR)/mus_game_freak.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G181 -V075
-
-$(MID_SUBDIR)/mus_teachy_tv_menu.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G186 -V059
-
-$(MID_SUBDIR)/mus_union_room.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G132 -V090
-
-$(MID_SUBDIR)/mus_vs_legend.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G157 -V090
-
-$(MID_SUBDIR)/mus_vs_deoxys.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G185 -V080
-
-$(MID_SUBDIR)/mus_vs_gym_leader.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G155 -V090
-
-$(MID_SUBDIR)/mus_vs_champion.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G158 -V090
-
-$(MID_SUBDIR)/mus_vs_mewtwo.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G157 -V090
-
-$(MID_SUBDIR)/mus_vs_trainer.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G156 -V090
-
-$(MID_SUBDIR)/mus_vs_wild.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G157 -V090
-
-$(MID_SUBDIR)/se_door.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G129 -V100 -P5
-
-$(MID_SUBDIR)/mus_victory_gym_leader.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G171 -V090
-
-$(MID_SUBDIR)/mus_victory_trainer.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G169 -V089
-
-$(MID_SUBDIR)/mus_victory_wild.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G170 -V090
-
-$(MID_SUBDIR)/ph_choice_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_choice_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_choice_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_cloth_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_cloth_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_cloth_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_cure_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_cure_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_cure_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_dress_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_dress_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_dress_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_face_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_face_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_face_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_fleece_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_fleece_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_fleece_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_foot_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_foot_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_foot_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_goat_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_goat_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_goat_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_goose_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_goose_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_goose_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_kit_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_kit_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_kit_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_lot_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_lot_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_lot_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_mouth_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_mouth_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_mouth_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_nurse_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_nurse_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_nurse_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_price_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_price_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_price_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_strut_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_strut_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_strut_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_thought_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_thought_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_thought_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_trap_blend.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_trap_held.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/ph_trap_solo.s: %.s: %.mid
-	$(MID) $< $@ -E -G130 -P4
-
-$(MID_SUBDIR)/se_bang.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_taillow_wing_flap.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V105 -P5
-
-$(MID_SUBDIR)/se_glass_flute.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V105 -P5
-
-$(MID_SUBDIR)/se_boo.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P4
-
-$(MID_SUBDIR)/se_ball.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V070 -P4
-
-$(MID_SUBDIR)/se_ball_open.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_mugshot.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P5
-
-$(MID_SUBDIR)/se_contest_heart.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P5
-
-$(MID_SUBDIR)/se_contest_curtain_fall.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V070 -P5
-
-$(MID_SUBDIR)/se_contest_curtain_rise.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V070 -P5
-
-$(MID_SUBDIR)/se_contest_icon_change.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P5
-
-$(MID_SUBDIR)/se_contest_mons_turn.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P5
-
-$(MID_SUBDIR)/se_contest_icon_clear.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P5
-
-$(MID_SUBDIR)/se_card.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P4
-
-$(MID_SUBDIR)/se_ledge.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P4
-
-$(MID_SUBDIR)/se_itemfinder.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P5
-
-$(MID_SUBDIR)/se_applause.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P5
-
-$(MID_SUBDIR)/se_field_poison.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P5
-
-$(MID_SUBDIR)/se_rs_door.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V080 -P5
-
-$(MID_SUBDIR)/se_elevator.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_escalator.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_exp.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V080 -P5
-
-$(MID_SUBDIR)/se_exp_max.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V094 -P5
-
-$(MID_SUBDIR)/se_fu_zaku.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V120 -P4
-
-$(MID_SUBDIR)/se_contest_condition_lose.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P4
-
-$(MID_SUBDIR)/se_lavaridge_fall_warp.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -P4
-
-$(MID_SUBDIR)/se_balloon_red.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V105 -P4
-
-$(MID_SUBDIR)/se_balloon_blue.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V105 -P4
-
-$(MID_SUBDIR)/se_balloon_yellow.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V105 -P4
-
-$(MID_SUBDIR)/se_bridge_walk.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V095 -P4
-
-$(MID_SUBDIR)/se_failure.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V120 -P4
-
-$(MID_SUBDIR)/se_rotating_gate.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P4
-
-$(MID_SUBDIR)/se_low_health.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P3
-
-$(MID_SUBDIR)/se_sliding_door.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V095 -P4
-
-$(MID_SUBDIR)/se_vend.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_bike_hop.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P4
-
-$(MID_SUBDIR)/se_bike_bell.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P4
-
-$(MID_SUBDIR)/se_contest_place.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P4
-
-$(MID_SUBDIR)/se_exit.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V120 -P5
-
-$(MID_SUBDIR)/se_use_item.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_unlock.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_ball_bounce_1.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_ball_bounce_2.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_ball_bounce_3.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_ball_bounce_4.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_super_effective.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P5
-
-$(MID_SUBDIR)/se_not_effective.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P5
-
-$(MID_SUBDIR)/se_effective.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P5
-
-$(MID_SUBDIR)/se_puddle.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V020 -P4
-
-$(MID_SUBDIR)/se_berry_blender.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P4
-
-$(MID_SUBDIR)/se_switch.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P4
-
-$(MID_SUBDIR)/se_ball_throw.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V120 -P5
-
-$(MID_SUBDIR)/se_ship.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V075 -P4
-
-$(MID_SUBDIR)/se_flee.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P5
-
-$(MID_SUBDIR)/se_intro_blast.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_pc_login.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_pc_off.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_pc_on.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_pin.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V060 -P4
-
-$(MID_SUBDIR)/se_ding_dong.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P5
-
-$(MID_SUBDIR)/se_pokenav_off.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_pokenav_on.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_faint.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P5
-
-$(MID_SUBDIR)/se_shiny.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V095 -P5
-
-$(MID_SUBDIR)/se_rs_shop.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P5
-
-$(MID_SUBDIR)/se_ice_crack.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P4
-
-$(MID_SUBDIR)/se_ice_stairs.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P4
-
-$(MID_SUBDIR)/se_ice_break.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_fall.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_save.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V080 -P5
-
-$(MID_SUBDIR)/se_success.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V080 -P4
-
-$(MID_SUBDIR)/se_select.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V080 -P5
-
-$(MID_SUBDIR)/se_ball_trade.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_thunderstorm.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V080 -P2
-
-$(MID_SUBDIR)/se_thunderstorm_stop.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V080 -P2
-
-$(MID_SUBDIR)/se_thunder.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P3
-
-$(MID_SUBDIR)/se_thunder2.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P3
-
-$(MID_SUBDIR)/se_rain.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V080 -P2
-
-$(MID_SUBDIR)/se_rain_stop.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V080 -P2
-
-$(MID_SUBDIR)/se_downpour.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P2
-
-$(MID_SUBDIR)/se_downpour_stop.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P2
-
-$(MID_SUBDIR)/se_orb.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P5
-
-$(MID_SUBDIR)/se_egg_hatch.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V120 -P5
-
-$(MID_SUBDIR)/se_roulette_ball.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P2
-
-$(MID_SUBDIR)/se_roulette_ball2.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P2
-
-$(MID_SUBDIR)/se_ball_tray_exit.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V100 -P5
-
-$(MID_SUBDIR)/se_ball_tray_ball.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P5
-
-$(MID_SUBDIR)/se_ball_tray_enter.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P5
-
-$(MID_SUBDIR)/se_click.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V110 -P4
-
-$(MID_SUBDIR)/se_warp_in.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P4
-
-$(MID_SUBDIR)/se_warp_out.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P4
-
-$(MID_SUBDIR)/se_note_a.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_note_b.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_note_c.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_note_c_high.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_note_d.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_mud_ball.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_note_e.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_note_f.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_note_g.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_breakable_door.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_truck_door.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_truck_unload.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -P4
-
-$(MID_SUBDIR)/se_truck_move.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -P4
-
-$(MID_SUBDIR)/se_truck_stop.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -P4
-
-$(MID_SUBDIR)/se_repel.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -V090 -P4
-
-$(MID_SUBDIR)/se_m_double_slap.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_comet_punch.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V120 -P4
-
-$(MID_SUBDIR)/se_m_pay_day.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V095 -P4
-
-$(MID_SUBDIR)/se_m_fire_punch.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_scratch.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_vicegrip.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_razor_wind.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_razor_wind2.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P4
-
-$(MID_SUBDIR)/se_m_swords_dance.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_m_cut.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V120 -P4
-
-$(MID_SUBDIR)/se_m_gust.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_gust2.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_wing_attack.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V105 -P4
-
-$(MID_SUBDIR)/se_m_fly.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_bind.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V100 -P4
-
-$(MID_SUBDIR)/se_m_mega_kick.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V090 -P4
-
-$(MID_SUBDIR)/se_m_mega_kick2.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_jump_kick.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_sand_attack.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_headbutt.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_horn_attack.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_take_down.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V105 -P4
-
-$(MID_SUBDIR)/se_m_tail_whip.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_m_leer.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G128 -V110 -P4
-
-$(MID_SUBDIR)/se_dex_search.s: %.s: %.mid
-	$(MID) $< $@ -E -R$(STD_REVERB) -G127 -v100 -P5
+else
+$(MID_BUILDDIR)/%.o: $(MID_SUBDIR)/%.mid
+	$(MID) $< $@ $(MID_FLAGS)
+endif
+
+$(MID_BUILDDIR)/mus_rocket_hideout.o $(MID_SUBDIR)/mus_rocket_hideout.s: MID_FLAGS := -E -R$(STD_REVERB) -G133 -V090
+$(MID_BUILDDIR)/mus_follow_me.o $(MID_SUBDIR)/mus_follow_me.s: MID_FLAGS := -E -R$(STD_REVERB) -G131 -V068
+$(MID_BUILDDIR)/mus_rs_vs_trainer.o $(MID_SUBDIR)/mus_rs_vs_trainer.s: MID_FLAGS := -E -R$(STD_REVERB) -G011 -V080 -P1
+$(MID_BUILDDIR)/mus_rs_vs_gym_leader.o $(MID_SUBDIR)/mus_rs_vs_gym_leader.s: MID_FLAGS := -E -R$(STD_REVERB) -G010 -V080
+$(MID_BUILDDIR)/mus_victory_road.o $(MID_SUBDIR)/mus_victory_road.s: MID_FLAGS := -E -R$(STD_REVERB) -G154 -V090
+$(MID_BUILDDIR)/mus_cycling.o $(MID_SUBDIR)/mus_cycling.s: MID_FLAGS := -E -R$(STD_REVERB) -G141 -V090
+$(MID_BUILDDIR)/mus_intro_fight.o $(MID_SUBDIR)/mus_intro_fight.s: MID_FLAGS := -E -R$(STD_REVERB) -G136 -V090
+$(MID_BUILDDIR)/mus_hall_of_fame.o $(MID_SUBDIR)/mus_hall_of_fame.s: MID_FLAGS := -E -R$(STD_REVERB) -G145 -V079
+$(MID_BUILDDIR)/mus_encounter_deoxys.o $(MID_SUBDIR)/mus_encounter_deoxys.s: MID_FLAGS := -E -R$(STD_REVERB) -G184 -V079
+$(MID_BUILDDIR)/mus_dummy.o $(MID_SUBDIR)/mus_dummy.s: MID_FLAGS := -E -R40
+$(MID_BUILDDIR)/mus_credits.o $(MID_SUBDIR)/mus_credits.s: MID_FLAGS := -E -R$(STD_REVERB) -G149 -V090
+$(MID_BUILDDIR)/mus_encounter_gym_leader.o $(MID_SUBDIR)/mus_encounter_gym_leader.s: MID_FLAGS := -E -R$(STD_REVERB) -G144 -V090
+$(MID_BUILDDIR)/mus_dex_rating.o $(MID_SUBDIR)/mus_dex_rating.s: MID_FLAGS := -E -R$(STD_REVERB) -G175 -V070 -P5
+$(MID_BUILDDIR)/mus_obtain_key_item.o $(MID_SUBDIR)/mus_obtain_key_item.s: MID_FLAGS := -E -R$(STD_REVERB) -G178 -V077 -P5
+$(MID_BUILDDIR)/mus_caught_intro.o $(MID_SUBDIR)/mus_caught_intro.s: MID_FLAGS := -E -R$(STD_REVERB) -G179 -V094 -P5
+$(MID_BUILDDIR)/mus_level_up.o $(MID_SUBDIR)/mus_level_up.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_obtain_item.o $(MID_SUBDIR)/mus_obtain_item.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_evolved.o $(MID_SUBDIR)/mus_evolved.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_caught.o $(MID_SUBDIR)/mus_caught.s: MID_FLAGS := -E -R$(STD_REVERB) -G170 -V100
+$(MID_BUILDDIR)/mus_cinnabar.o $(MID_SUBDIR)/mus_cinnabar.s: MID_FLAGS := -E -R$(STD_REVERB) -G138 -V090
+$(MID_BUILDDIR)/mus_gym.o $(MID_SUBDIR)/mus_gym.s: MID_FLAGS := -E -R$(STD_REVERB) -G134 -V090
+$(MID_BUILDDIR)/mus_fuchsia.o $(MID_SUBDIR)/mus_fuchsia.s: MID_FLAGS := -E -R$(STD_REVERB) -G167 -V090
+$(MID_BUILDDIR)/mus_poke_jump.o $(MID_SUBDIR)/mus_poke_jump.s: MID_FLAGS := -E -R$(STD_REVERB) -G132 -V090
+$(MID_BUILDDIR)/mus_heal_unused.o $(MID_SUBDIR)/mus_heal_unused.s: MID_FLAGS := -E -R$(STD_REVERB) -G140 -V090
+$(MID_BUILDDIR)/mus_oak_lab.o $(MID_SUBDIR)/mus_oak_lab.s: MID_FLAGS := -E -R$(STD_REVERB) -G160 -V075
+$(MID_BUILDDIR)/mus_berry_pick.o $(MID_SUBDIR)/mus_berry_pick.s: MID_FLAGS := -E -R$(STD_REVERB) -G132 -V090
+$(MID_BUILDDIR)/mus_vermillion.o $(MID_SUBDIR)/mus_vermillion.s: MID_FLAGS := -E -R$(STD_REVERB) -G172 -V090
+$(MID_BUILDDIR)/mus_route1.o $(MID_SUBDIR)/mus_route1.s: MID_FLAGS := -E -R$(STD_REVERB) -G150 -V079
+$(MID_BUILDDIR)/mus_route3.o $(MID_SUBDIR)/mus_route3.s: MID_FLAGS := -E -R$(STD_REVERB) -G152 -V083
+$(MID_BUILDDIR)/mus_route11.o $(MID_SUBDIR)/mus_route11.s: MID_FLAGS := -E -R$(STD_REVERB) -G153 -V090
+$(MID_BUILDDIR)/mus_pallet.o $(MID_SUBDIR)/mus_pallet.s: MID_FLAGS := -E -R$(STD_REVERB) -G159 -V100
+$(MID_BUILDDIR)/mus_heal.o $(MID_SUBDIR)/mus_heal.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_slots_jackpot.o $(MID_SUBDIR)/mus_slots_jackpot.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V100 -P5
+$(MID_BUILDDIR)/mus_slots_win.o $(MID_SUBDIR)/mus_slots_win.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V100 -P5
+$(MID_BUILDDIR)/mus_obtain_badge.o $(MID_SUBDIR)/mus_obtain_badge.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_obtain_berry.o $(MID_SUBDIR)/mus_obtain_berry.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_photo.o $(MID_SUBDIR)/mus_photo.s: MID_FLAGS := -E -R$(STD_REVERB) -G180 -V100 -P5
+$(MID_BUILDDIR)/mus_evolution_intro.o $(MID_SUBDIR)/mus_evolution_intro.s: MID_FLAGS := -E -R$(STD_REVERB) -G009 -V080 -P1
+$(MID_BUILDDIR)/mus_move_deleted.o $(MID_SUBDIR)/mus_move_deleted.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_obtain_tmhm.o $(MID_SUBDIR)/mus_obtain_tmhm.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_too_bad.o $(MID_SUBDIR)/mus_too_bad.s: MID_FLAGS := -E -R$(STD_REVERB) -G008 -V090 -P5
+$(MID_BUILDDIR)/mus_surf.o $(MID_SUBDIR)/mus_surf.s: MID_FLAGS := -E -R$(STD_REVERB) -G164 -V071
+$(MID_BUILDDIR)/mus_sevii_123.o $(MID_SUBDIR)/mus_sevii_123.s: MID_FLAGS := -E -R$(STD_REVERB) -G173 -V084
+$(MID_BUILDDIR)/mus_sevii_45.o $(MID_SUBDIR)/mus_sevii_45.s: MID_FLAGS := -E -R$(STD_REVERB) -G188 -V084
+$(MID_BUILDDIR)/mus_sevii_67.o $(MID_SUBDIR)/mus_sevii_67.s: MID_FLAGS := -E -R$(STD_REVERB) -G189 -V084
+$(MID_BUILDDIR)/mus_sevii_cave.o $(MID_SUBDIR)/mus_sevii_cave.s: MID_FLAGS := -E -R$(STD_REVERB) -G147 -V090
+$(MID_BUILDDIR)/mus_sevii_dungeon.o $(MID_SUBDIR)/mus_sevii_dungeon.s: MID_FLAGS := -E -R$(STD_REVERB) -G146 -V090
+$(MID_BUILDDIR)/mus_sevii_route.o $(MID_SUBDIR)/mus_sevii_route.s: MID_FLAGS := -E -R$(STD_REVERB) -G187 -V080
+$(MID_BUILDDIR)/mus_net_center.o $(MID_SUBDIR)/mus_net_center.s: MID_FLAGS := -E -R$(STD_REVERB) -G162 -V096
+$(MID_BUILDDIR)/mus_pewter.o $(MID_SUBDIR)/mus_pewter.s: MID_FLAGS := -E -R$(STD_REVERB) -G173 -V084
+$(MID_BUILDDIR)/mus_oak.o $(MID_SUBDIR)/mus_oak.s: MID_FLAGS := -E -R$(STD_REVERB) -G161 -V086
+$(MID_BUILDDIR)/mus_mystery_gift.o $(MID_SUBDIR)/mus_mystery_gift.s: MID_FLAGS := -E -R$(STD_REVERB) -G183 -V100
+$(MID_BUILDDIR)/mus_route24.o $(MID_SUBDIR)/mus_route24.s: MID_FLAGS := -E -R$(STD_REVERB) -G151 -V086
+$(MID_BUILDDIR)/mus_teachy_tv_show.o $(MID_SUBDIR)/mus_teachy_tv_show.s: MID_FLAGS := -E -R$(STD_REVERB) -G131 -V068
+$(MID_BUILDDIR)/mus_mt_moon.o $(MID_SUBDIR)/mus_mt_moon.s: MID_FLAGS := -E -R$(STD_REVERB) -G147 -V090
+$(MID_BUILDDIR)/mus_school.o $(MID_SUBDIR)/mus_school.s: MID_FLAGS := -E -R$(STD_REVERB) -G012 -V100 -P1
+$(MID_BUILDDIR)/mus_poke_tower.o $(MID_SUBDIR)/mus_poke_tower.s: MID_FLAGS := -E -R$(STD_REVERB) -G165 -V090
+$(MID_BUILDDIR)/mus_poke_center.o $(MID_SUBDIR)/mus_poke_center.s: MID_FLAGS := -E -R$(STD_REVERB) -G162 -V096
+$(MID_BUILDDIR)/mus_poke_flute.o $(MID_SUBDIR)/mus_poke_flute.s: MID_FLAGS := -E -R$(STD_REVERB) -G165 -V048 -P5
+$(MID_BUILDDIR)/mus_poke_mansion.o $(MID_SUBDIR)/mus_poke_mansion.s: MID_FLAGS := -E -R$(STD_REVERB) -G148 -V090
+$(MID_BUILDDIR)/mus_jigglypuff.o $(MID_SUBDIR)/mus_jigglypuff.s: MID_FLAGS := -E -R$(STD_REVERB) -G135 -V068 -P5
+$(MID_BUILDDIR)/mus_encounter_rival.o $(MID_SUBDIR)/mus_encounter_rival.s: MID_FLAGS := -E -R$(STD_REVERB) -G174 -V079
+$(MID_BUILDDIR)/mus_rival_exit.o $(MID_SUBDIR)/mus_rival_exit.s: MID_FLAGS := -E -R$(STD_REVERB) -G174 -V079
+$(MID_BUILDDIR)/mus_encounter_rocket.o $(MID_SUBDIR)/mus_encounter_rocket.s: MID_FLAGS := -E -R$(STD_REVERB) -G142 -V096
+$(MID_BUILDDIR)/mus_ss_anne.o $(MID_SUBDIR)/mus_ss_anne.s: MID_FLAGS := -E -R$(STD_REVERB) -G163 -V090
+$(MID_BUILDDIR)/mus_new_game_exit.o $(MID_SUBDIR)/mus_new_game_exit.s: MID_FLAGS := -E -R$(STD_REVERB) -G182 -V088
+$(MID_BUILDDIR)/mus_new_game_intro.o $(MID_SUBDIR)/mus_new_game_intro.s: MID_FLAGS := -E -R$(STD_REVERB) -G182 -V088
+$(MID_BUILDDIR)/mus_evolution.o $(MID_SUBDIR)/mus_evolution.s: MID_FLAGS := -E -R$(STD_REVERB) -G009 -V080 -P1
+$(MID_BUILDDIR)/mus_lavender.o $(MID_SUBDIR)/mus_lavender.s: MID_FLAGS := -E -R$(STD_REVERB) -G139 -V090
+$(MID_BUILDDIR)/mus_silph.o $(MID_SUBDIR)/mus_silph.s: MID_FLAGS := -E -R$(STD_REVERB) -G166 -V076
+$(MID_BUILDDIR)/mus_encounter_girl.o $(MID_SUBDIR)/mus_encounter_girl.s: MID_FLAGS := -E -R$(STD_REVERB) -G143 -V051
+$(MID_BUILDDIR)/mus_encounter_boy.o $(MID_SUBDIR)/mus_encounter_boy.s: MID_FLAGS := -E -R$(STD_REVERB) -G144 -V090
+$(MID_BUILDDIR)/mus_game_corner.o $(MID_SUBDIR)/mus_game_corner.s: MID_FLAGS := -E -R$(STD_REVERB) -G132 -V090
+$(MID_BUILDDIR)/mus_slow_pallet.o $(MID_SUBDIR)/mus_slow_pallet.s: MID_FLAGS := -E -R$(STD_REVERB) -G159 -V092
+$(MID_BUILDDIR)/mus_new_game_instruct.o $(MID_SUBDIR)/mus_new_game_instruct.s: MID_FLAGS := -E -R$(STD_REVERB) -G182 -V085
+$(MID_BUILDDIR)/mus_viridian_forest.o $(MID_SUBDIR)/mus_viridian_forest.s: MID_FLAGS := -E -R$(STD_REVERB) -G146 -V090
+$(MID_BUILDDIR)/mus_trainer_tower.o $(MID_SUBDIR)/mus_trainer_tower.s: MID_FLAGS := -E -R$(STD_REVERB) -G134 -V090
+$(MID_BUILDDIR)/mus_celadon.o $(MID_SUBDIR)/mus_celadon.s: MID_FLAGS := -E -R$(STD_REVERB) -G168 -V070
+$(MID_BUILDDIR)/mus_title.o $(MID_SUBDIR)/mus_title.s: MID_FLAGS := -E -R$(STD_REVERB) -G137 -V090
+$(MID_BUILDDIR)/mus_game_freak.o $(MID_SUBDIR)/mus_game_freak.s: MID_FLAGS := -E -R$(STD_REVERB) -G181 -V075
+$(MID_BUILDDIR)/mus_teachy_tv_menu.o $(MID_SUBDIR)/mus_teachy_tv_menu.s: MID_FLAGS := -E -R$(STD_REVERB) -G186 -V059
+$(MID_BUILDDIR)/mus_union_room.o $(MID_SUBDIR)/mus_union_room.s: MID_FLAGS := -E -R$(STD_REVERB) -G132 -V090
+$(MID_BUILDDIR)/mus_vs_legend.o $(MID_SUBDIR)/mus_vs_legend.s: MID_FLAGS := -E -R$(STD_REVERB) -G157 -V090
+$(MID_BUILDDIR)/mus_vs_deoxys.o $(MID_SUBDIR)/mus_vs_deoxys.s: MID_FLAGS := -E -R$(STD_REVERB) -G185 -V080
+$(MID_BUILDDIR)/mus_vs_gym_leader.o $(MID_SUBDIR)/mus_vs_gym_leader.s: MID_FLAGS := -E -R$(STD_REVERB) -G155 -V090
+$(MID_BUILDDIR)/mus_vs_champion.o $(MID_SUBDIR)/mus_vs_champion.s: MID_FLAGS := -E -R$(STD_REVERB) -G158 -V090
+$(MID_BUILDDIR)/mus_vs_mewtwo.o $(MID_SUBDIR)/mus_vs_mewtwo.s: MID_FLAGS := -E -R$(STD_REVERB) -G157 -V090
+$(MID_BUILDDIR)/mus_vs_trainer.o $(MID_SUBDIR)/mus_vs_trainer.s: MID_FLAGS := -E -R$(STD_REVERB) -G156 -V090
+$(MID_BUILDDIR)/mus_vs_wild.o $(MID_SUBDIR)/mus_vs_wild.s: MID_FLAGS := -E -R$(STD_REVERB) -G157 -V090
+$(MID_BUILDDIR)/se_door.o $(MID_SUBDIR)/se_door.s: MID_FLAGS := -E -R$(STD_REVERB) -G129 -V100 -P5
+$(MID_BUILDDIR)/mus_victory_gym_leader.o $(MID_SUBDIR)/mus_victory_gym_leader.s: MID_FLAGS := -E -R$(STD_REVERB) -G171 -V090
+$(MID_BUILDDIR)/mus_victory_trainer.o $(MID_SUBDIR)/mus_victory_trainer.s: MID_FLAGS := -E -R$(STD_REVERB) -G169 -V089
+$(MID_BUILDDIR)/mus_victory_wild.o $(MID_SUBDIR)/mus_victory_wild.s: MID_FLAGS := -E -R$(STD_REVERB) -G170 -V090
+$(MID_BUILDDIR)/ph_choice_blend.o $(MID_SUBDIR)/ph_choice_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_choice_held.o $(MID_SUBDIR)/ph_choice_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_choice_solo.o $(MID_SUBDIR)/ph_choice_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_cloth_blend.o $(MID_SUBDIR)/ph_cloth_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_cloth_held.o $(MID_SUBDIR)/ph_cloth_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_cloth_solo.o $(MID_SUBDIR)/ph_cloth_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_cure_blend.o $(MID_SUBDIR)/ph_cure_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_cure_held.o $(MID_SUBDIR)/ph_cure_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_cure_solo.o $(MID_SUBDIR)/ph_cure_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_dress_blend.o $(MID_SUBDIR)/ph_dress_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_dress_held.o $(MID_SUBDIR)/ph_dress_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_dress_solo.o $(MID_SUBDIR)/ph_dress_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_face_blend.o $(MID_SUBDIR)/ph_face_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_face_held.o $(MID_SUBDIR)/ph_face_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_face_solo.o $(MID_SUBDIR)/ph_face_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_fleece_blend.o $(MID_SUBDIR)/ph_fleece_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_fleece_held.o $(MID_SUBDIR)/ph_fleece_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_fleece_solo.o $(MID_SUBDIR)/ph_fleece_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_foot_blend.o $(MID_SUBDIR)/ph_foot_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_foot_held.o $(MID_SUBDIR)/ph_foot_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_foot_solo.o $(MID_SUBDIR)/ph_foot_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_goat_blend.o $(MID_SUBDIR)/ph_goat_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_goat_held.o $(MID_SUBDIR)/ph_goat_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_goat_solo.o $(MID_SUBDIR)/ph_goat_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_goose_blend.o $(MID_SUBDIR)/ph_goose_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_goose_held.o $(MID_SUBDIR)/ph_goose_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_goose_solo.o $(MID_SUBDIR)/ph_goose_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_kit_blend.o $(MID_SUBDIR)/ph_kit_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_kit_held.o $(MID_SUBDIR)/ph_kit_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_kit_solo.o $(MID_SUBDIR)/ph_kit_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_lot_blend.o $(MID_SUBDIR)/ph_lot_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_lot_held.o $(MID_SUBDIR)/ph_lot_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_lot_solo.o $(MID_SUBDIR)/ph_lot_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_mouth_blend.o $(MID_SUBDIR)/ph_mouth_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_mouth_held.o $(MID_SUBDIR)/ph_mouth_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_mouth_solo.o $(MID_SUBDIR)/ph_mouth_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_nurse_blend.o $(MID_SUBDIR)/ph_nurse_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_nurse_held.o $(MID_SUBDIR)/ph_nurse_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_nurse_solo.o $(MID_SUBDIR)/ph_nurse_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_price_blend.o $(MID_SUBDIR)/ph_price_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_price_held.o $(MID_SUBDIR)/ph_price_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_price_solo.o $(MID_SUBDIR)/ph_price_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_strut_blend.o $(MID_SUBDIR)/ph_strut_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_strut_held.o $(MID_SUBDIR)/ph_strut_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_strut_solo.o $(MID_SUBDIR)/ph_strut_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_thought_blend.o $(MID_SUBDIR)/ph_thought_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_thought_held.o $(MID_SUBDIR)/ph_thought_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_thought_solo.o $(MID_SUBDIR)/ph_thought_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_trap_blend.o $(MID_SUBDIR)/ph_trap_blend.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_trap_held.o $(MID_SUBDIR)/ph_trap_held.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/ph_trap_solo.o $(MID_SUBDIR)/ph_trap_solo.s: MID_FLAGS := -E -G130 -P4
+$(MID_BUILDDIR)/se_bang.o $(MID_SUBDIR)/se_bang.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_taillow_wing_flap.o $(MID_SUBDIR)/se_taillow_wing_flap.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V105 -P5
+$(MID_BUILDDIR)/se_glass_flute.o $(MID_SUBDIR)/se_glass_flute.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V105 -P5
+$(MID_BUILDDIR)/se_boo.o $(MID_SUBDIR)/se_boo.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P4
+$(MID_BUILDDIR)/se_ball.o $(MID_SUBDIR)/se_ball.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V070 -P4
+$(MID_BUILDDIR)/se_ball_open.o $(MID_SUBDIR)/se_ball_open.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_mugshot.o $(MID_SUBDIR)/se_mugshot.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P5
+$(MID_BUILDDIR)/se_contest_heart.o $(MID_SUBDIR)/se_contest_heart.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P5
+$(MID_BUILDDIR)/se_contest_curtain_fall.o $(MID_SUBDIR)/se_contest_curtain_fall.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V070 -P5
+$(MID_BUILDDIR)/se_contest_curtain_rise.o $(MID_SUBDIR)/se_contest_curtain_rise.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V070 -P5
+$(MID_BUILDDIR)/se_contest_icon_change.o $(MID_SUBDIR)/se_contest_icon_change.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P5
+$(MID_BUILDDIR)/se_contest_mons_turn.o $(MID_SUBDIR)/se_contest_mons_turn.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P5
+$(MID_BUILDDIR)/se_contest_icon_clear.o $(MID_SUBDIR)/se_contest_icon_clear.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P5
+$(MID_BUILDDIR)/se_card.o $(MID_SUBDIR)/se_card.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P4
+$(MID_BUILDDIR)/se_ledge.o $(MID_SUBDIR)/se_ledge.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P4
+$(MID_BUILDDIR)/se_itemfinder.o $(MID_SUBDIR)/se_itemfinder.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P5
+$(MID_BUILDDIR)/se_applause.o $(MID_SUBDIR)/se_applause.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P5
+$(MID_BUILDDIR)/se_field_poison.o $(MID_SUBDIR)/se_field_poison.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P5
+$(MID_BUILDDIR)/se_rs_door.o $(MID_SUBDIR)/se_rs_door.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V080 -P5
+$(MID_BUILDDIR)/se_elevator.o $(MID_SUBDIR)/se_elevator.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_escalator.o $(MID_SUBDIR)/se_escalator.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_exp.o $(MID_SUBDIR)/se_exp.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V080 -P5
+$(MID_BUILDDIR)/se_exp_max.o $(MID_SUBDIR)/se_exp_max.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V094 -P5
+$(MID_BUILDDIR)/se_fu_zaku.o $(MID_SUBDIR)/se_fu_zaku.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V120 -P4
+$(MID_BUILDDIR)/se_contest_condition_lose.o $(MID_SUBDIR)/se_contest_condition_lose.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P4
+$(MID_BUILDDIR)/se_lavaridge_fall_warp.o $(MID_SUBDIR)/se_lavaridge_fall_warp.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -P4
+$(MID_BUILDDIR)/se_balloon_red.o $(MID_SUBDIR)/se_balloon_red.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V105 -P4
+$(MID_BUILDDIR)/se_balloon_blue.o $(MID_SUBDIR)/se_balloon_blue.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V105 -P4
+$(MID_BUILDDIR)/se_balloon_yellow.o $(MID_SUBDIR)/se_balloon_yellow.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V105 -P4
+$(MID_BUILDDIR)/se_bridge_walk.o $(MID_SUBDIR)/se_bridge_walk.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V095 -P4
+$(MID_BUILDDIR)/se_failure.o $(MID_SUBDIR)/se_failure.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V120 -P4
+$(MID_BUILDDIR)/se_rotating_gate.o $(MID_SUBDIR)/se_rotating_gate.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P4
+$(MID_BUILDDIR)/se_low_health.o $(MID_SUBDIR)/se_low_health.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P3
+$(MID_BUILDDIR)/se_sliding_door.o $(MID_SUBDIR)/se_sliding_door.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V095 -P4
+$(MID_BUILDDIR)/se_vend.o $(MID_SUBDIR)/se_vend.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_bike_hop.o $(MID_SUBDIR)/se_bike_hop.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P4
+$(MID_BUILDDIR)/se_bike_bell.o $(MID_SUBDIR)/se_bike_bell.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P4
+$(MID_BUILDDIR)/se_contest_place.o $(MID_SUBDIR)/se_contest_place.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P4
+$(MID_BUILDDIR)/se_exit.o $(MID_SUBDIR)/se_exit.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V120 -P5
+$(MID_BUILDDIR)/se_use_item.o $(MID_SUBDIR)/se_use_item.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_unlock.o $(MID_SUBDIR)/se_unlock.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_ball_bounce_1.o $(MID_SUBDIR)/se_ball_bounce_1.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_ball_bounce_2.o $(MID_SUBDIR)/se_ball_bounce_2.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_ball_bounce_3.o $(MID_SUBDIR)/se_ball_bounce_3.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_ball_bounce_4.o $(MID_SUBDIR)/se_ball_bounce_4.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_super_effective.o $(MID_SUBDIR)/se_super_effective.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P5
+$(MID_BUILDDIR)/se_not_effective.o $(MID_SUBDIR)/se_not_effective.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P5
+$(MID_BUILDDIR)/se_effective.o $(MID_SUBDIR)/se_effective.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P5
+$(MID_BUILDDIR)/se_puddle.o $(MID_SUBDIR)/se_puddle.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V020 -P4
+$(MID_BUILDDIR)/se_berry_blender.o $(MID_SUBDIR)/se_berry_blender.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P4
+$(MID_BUILDDIR)/se_switch.o $(MID_SUBDIR)/se_switch.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P4
+$(MID_BUILDDIR)/se_ball_throw.o $(MID_SUBDIR)/se_ball_throw.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V120 -P5
+$(MID_BUILDDIR)/se_ship.o $(MID_SUBDIR)/se_ship.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V075 -P4
+$(MID_BUILDDIR)/se_flee.o $(MID_SUBDIR)/se_flee.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P5
+$(MID_BUILDDIR)/se_intro_blast.o $(MID_SUBDIR)/se_intro_blast.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_pc_login.o $(MID_SUBDIR)/se_pc_login.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_pc_off.o $(MID_SUBDIR)/se_pc_off.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_pc_on.o $(MID_SUBDIR)/se_pc_on.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_pin.o $(MID_SUBDIR)/se_pin.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V060 -P4
+$(MID_BUILDDIR)/se_ding_dong.o $(MID_SUBDIR)/se_ding_dong.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P5
+$(MID_BUILDDIR)/se_pokenav_off.o $(MID_SUBDIR)/se_pokenav_off.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_pokenav_on.o $(MID_SUBDIR)/se_pokenav_on.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_faint.o $(MID_SUBDIR)/se_faint.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P5
+$(MID_BUILDDIR)/se_shiny.o $(MID_SUBDIR)/se_shiny.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V095 -P5
+$(MID_BUILDDIR)/se_rs_shop.o $(MID_SUBDIR)/se_rs_shop.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P5
+$(MID_BUILDDIR)/se_ice_crack.o $(MID_SUBDIR)/se_ice_crack.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P4
+$(MID_BUILDDIR)/se_ice_stairs.o $(MID_SUBDIR)/se_ice_stairs.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P4
+$(MID_BUILDDIR)/se_ice_break.o $(MID_SUBDIR)/se_ice_break.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_fall.o $(MID_SUBDIR)/se_fall.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_save.o $(MID_SUBDIR)/se_save.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V080 -P5
+$(MID_BUILDDIR)/se_success.o $(MID_SUBDIR)/se_success.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V080 -P4
+$(MID_BUILDDIR)/se_select.o $(MID_SUBDIR)/se_select.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V080 -P5
+$(MID_BUILDDIR)/se_ball_trade.o $(MID_SUBDIR)/se_ball_trade.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_thunderstorm.o $(MID_SUBDIR)/se_thunderstorm.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V080 -P2
+$(MID_BUILDDIR)/se_thunderstorm_stop.o $(MID_SUBDIR)/se_thunderstorm_stop.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V080 -P2
+$(MID_BUILDDIR)/se_thunder.o $(MID_SUBDIR)/se_thunder.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P3
+$(MID_BUILDDIR)/se_thunder2.o $(MID_SUBDIR)/se_thunder2.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P3
+$(MID_BUILDDIR)/se_rain.o $(MID_SUBDIR)/se_rain.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V080 -P2
+$(MID_BUILDDIR)/se_rain_stop.o $(MID_SUBDIR)/se_rain_stop.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V080 -P2
+$(MID_BUILDDIR)/se_downpour.o $(MID_SUBDIR)/se_downpour.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P2
+$(MID_BUILDDIR)/se_downpour_stop.o $(MID_SUBDIR)/se_downpour_stop.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P2
+$(MID_BUILDDIR)/se_orb.o $(MID_SUBDIR)/se_orb.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P5
+$(MID_BUILDDIR)/se_egg_hatch.o $(MID_SUBDIR)/se_egg_hatch.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V120 -P5
+$(MID_BUILDDIR)/se_roulette_ball.o $(MID_SUBDIR)/se_roulette_ball.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P2
+$(MID_BUILDDIR)/se_roulette_ball2.o $(MID_SUBDIR)/se_roulette_ball2.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P2
+$(MID_BUILDDIR)/se_ball_tray_exit.o $(MID_SUBDIR)/se_ball_tray_exit.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V100 -P5
+$(MID_BUILDDIR)/se_ball_tray_ball.o $(MID_SUBDIR)/se_ball_tray_ball.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P5
+$(MID_BUILDDIR)/se_ball_tray_enter.o $(MID_SUBDIR)/se_ball_tray_enter.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P5
+$(MID_BUILDDIR)/se_click.o $(MID_SUBDIR)/se_click.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V110 -P4
+$(MID_BUILDDIR)/se_warp_in.o $(MID_SUBDIR)/se_warp_in.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P4
+$(MID_BUILDDIR)/se_warp_out.o $(MID_SUBDIR)/se_warp_out.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P4
+$(MID_BUILDDIR)/se_note_a.o $(MID_SUBDIR)/se_note_a.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_note_b.o $(MID_SUBDIR)/se_note_b.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_note_c.o $(MID_SUBDIR)/se_note_c.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_note_c_high.o $(MID_SUBDIR)/se_note_c_high.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_note_d.o $(MID_SUBDIR)/se_note_d.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_mud_ball.o $(MID_SUBDIR)/se_mud_ball.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_note_e.o $(MID_SUBDIR)/se_note_e.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_note_f.o $(MID_SUBDIR)/se_note_f.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_note_g.o $(MID_SUBDIR)/se_note_g.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_breakable_door.o $(MID_SUBDIR)/se_breakable_door.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_truck_door.o $(MID_SUBDIR)/se_truck_door.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_truck_unload.o $(MID_SUBDIR)/se_truck_unload.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -P4
+$(MID_BUILDDIR)/se_truck_move.o $(MID_SUBDIR)/se_truck_move.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -P4
+$(MID_BUILDDIR)/se_truck_stop.o $(MID_SUBDIR)/se_truck_stop.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -P4
+$(MID_BUILDDIR)/se_repel.o $(MID_SUBDIR)/se_repel.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -V090 -P4
+$(MID_BUILDDIR)/se_m_double_slap.o $(MID_SUBDIR)/se_m_double_slap.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_comet_punch.o $(MID_SUBDIR)/se_m_comet_punch.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V120 -P4
+$(MID_BUILDDIR)/se_m_pay_day.o $(MID_SUBDIR)/se_m_pay_day.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V095 -P4
+$(MID_BUILDDIR)/se_m_fire_punch.o $(MID_SUBDIR)/se_m_fire_punch.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_scratch.o $(MID_SUBDIR)/se_m_scratch.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_vicegrip.o $(MID_SUBDIR)/se_m_vicegrip.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_razor_wind.o $(MID_SUBDIR)/se_m_razor_wind.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_razor_wind2.o $(MID_SUBDIR)/se_m_razor_wind2.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P4
+$(MID_BUILDDIR)/se_m_swords_dance.o $(MID_SUBDIR)/se_m_swords_dance.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_m_cut.o $(MID_SUBDIR)/se_m_cut.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V120 -P4
+$(MID_BUILDDIR)/se_m_gust.o $(MID_SUBDIR)/se_m_gust.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_gust2.o $(MID_SUBDIR)/se_m_gust2.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_wing_attack.o $(MID_SUBDIR)/se_m_wing_attack.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V105 -P4
+$(MID_BUILDDIR)/se_m_fly.o $(MID_SUBDIR)/se_m_fly.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_bind.o $(MID_SUBDIR)/se_m_bind.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V100 -P4
+$(MID_BUILDDIR)/se_m_mega_kick.o $(MID_SUBDIR)/se_m_mega_kick.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V090 -P4
+$(MID_BUILDDIR)/se_m_mega_kick2.o $(MID_SUBDIR)/se_m_mega_kick2.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_jump_kick.o $(MID_SUBDIR)/se_m_jump_kick.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_sand_attack.o $(MID_SUBDIR)/se_m_sand_attack.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_headbutt.o $(MID_SUBDIR)/se_m_headbutt.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_horn_attack.o $(MID_SUBDIR)/se_m_horn_attack.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_take_down.o $(MID_SUBDIR)/se_m_take_down.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V105 -P4
+$(MID_BUILDDIR)/se_m_tail_whip.o $(MID_SUBDIR)/se_m_tail_whip.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_m_leer.o $(MID_SUBDIR)/se_m_leer.s: MID_FLAGS := -E -R$(STD_REVERB) -G128 -V110 -P4
+$(MID_BUILDDIR)/se_dex_search.o $(MID_SUBDIR)/se_dex_search.s: MID_FLAGS := -E -R$(STD_REVERB) -G127 -v100 -P5
@@ -0,0 +1,274 @@
+// Copyright(c) 2016 huderlem
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "delta.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define HAVE_SSE2
+#endif
+
+// This is a table of deltas between sample values in compressed PCM data.
+const int gDeltaEncodingTable[16] = {
+	0, 1, 4, 9, 16, 25, 36, 49,
+	-64, -49, -36, -25, -16, -9, -4, -1,
+};
+
+unsigned long delta_encoded_size(unsigned long num_samples)
+{
+	unsigned long size = num_samples / 64 * 33;
+	unsigned long extra = num_samples % 64;
+
+	if (extra)
+	{
+		// The first sample is stored whole and the second gets a byte to
+		// itself; the rest are two to a byte.
+		size += 1 + (extra >= 2) + (extra - 1) / 2;
+	}
+
+	return size;
+}
+
+static int get_delta_index(uint8_t sample, uint8_t prev_sample)
+{
+	int best_error = INT_MAX;
+	int best_index = -1;
+
+	for (int i = 0; i < 16; i++)
+	{
+		uint8_t new_sample = prev_sample + gDeltaEncodingTable[i];
+		int error = sample > new_sample ? sample - new_sample : new_sample - sample;
+
+		if (error < best_error)
+		{
+			best_error = error;
+			best_index = i;
+		}
+	}
+
+	return best_index;
+}
+
+#ifdef HAVE_SSE2
+
+// Tries all 16 deltas at once. Ties go to the lowest index, as in the loop
+// above.
+static int get_delta_index_sse2(uint8_t sample, uint8_t prev_sample)
+{
+	const __m128i table = _mm_setr_epi8(0, 1, 4, 9, 16, 25, 36, 49, -64, -49, -36, -25, -16, -9, -4, -1);
+	__m128i target = _mm_set1_epi8((char)sample);
+	__m128i candidates = _mm_add_epi8(_mm_set1_epi8((char)prev_sample), table);
+	__m128i errors = _mm_or_si128(_mm_subs_epu8(target, candidates), _mm_subs_epu8(candidates, target));
+
+	__m128i min = _mm_min_epu8(errors, _mm_shuffle_epi32(errors, 0x4E));
+	min = _mm_min_epu8(min, _mm_shuffle_epi32(min, 0xB1));
+	min = _mm_min_epu8(min, _mm_shufflelo_epi16(min, 0xB1));
+	min = _mm_min_epu8(min, _mm_srli_epi16(min, 8));
+
+	int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_set1_epi8((char)_mm_cvtsi128_si32(min))));
+
+	return __builtin_ctz(mask);
+}
+
+#endif // HAVE_SSE2
+
+static inline int choose_delta_index(uint8_t sample, uint8_t prev_sample, bool simd)
+{
+#ifdef HAVE_SSE2
+	if (simd)
+	{
+		return get_delta_index_sse2(sample, prev_sample);
+	}
+#endif
+	(void)simd;
+	return get_delta_index(sample, prev_sample);
+}
+
+unsigned long delta_encode(const uint8_t *pcm, unsigned long num_samples, uint8_t *delta, enum DeltaKernel kernel)
+{
+	bool simd = kernel == DELTA_KERNEL_AUTO;
+	unsigned long i = 0;
+	unsigned long j = 0;
+	int k;
+	uint8_t base;
+	int delta_index;
+
+	while (i < num_samples)
+	{
+		base = pcm[i++];
+		delta[j++] = base;
+
+		if (i >= num_samples)
+		{
+			break;
+		}
+		delta_index = choose_delta_index(pcm[i++], base, simd);
+		base += gDeltaEncodingTable[delta_index];
+		delta[j++] = delta_index;
+
+		for (k = 0; k < 31; k++)
+		{
+			if (i >= num_samples)
+			{
+				break;
+			}
+			delta_index = choose_delta_index(pcm[i++], base, simd);
+			base += gDeltaEncodingTable[delta_index];
+			delta[j] = (delta_index << 4);
+
+			// When the samples run out on a high nibble, that byte is left
+			// out of the length, as it always has been.
+			if (i >= num_samples)
+			{
+				break;
+			}
+			delta_index = choose_delta_index(pcm[i++], base, simd);
+			base += gDeltaEncodingTable[delta_index];
+			delta[j++] |= delta_index;
+		}
+	}
+
+	return j;
+}
+
+#ifdef HAVE_SSE2
+
+#define DELTA(n) ((uint8_t)((n) < 8 ? (n) * (n) : -(16 - (n)) * (16 - (n))))
+#define PAIR(x) (DELTA((x) >> 4) | DELTA((x) & 0xf) << 8)
+#define PAIRS4(x) PAIR(x), PAIR((x) + 1), PAIR((x) + 2), PAIR((x) + 3)
+#define PAIRS16(x) PAIRS4(x), PAIRS4((x) + 4), PAIRS4((x) + 8), PAIRS4((x) + 12)
+
+// The two deltas a byte holds, high nibble first in memory.
+static const uint16_t s_delta_pairs[256] = {
+	PAIRS16(0x00), PAIRS16(0x10), PAIRS16(0x20), PAIRS16(0x30),
+	PAIRS16(0x40), PAIRS16(0x50), PAIRS16(0x60), PAIRS16(0x70),
+	PAIRS16(0x80), PAIRS16(0x90), PAIRS16(0xa0), PAIRS16(0xb0),
+	PAIRS16(0xc0), PAIRS16(0xd0), PAIRS16(0xe0), PAIRS16(0xf0),
+};
+
+// Decodes a whole block: each sample is the running sum of the first byte
+// and the deltas up to it, which is a prefix sum over 64 bytes.
+static void decode_block_sse2(const uint8_t *delta, uint8_t *pcm)
+{
+	uint8_t steps[64];
+
+	steps[0] = delta[0];
+	steps[1] = s_delta_pairs[delta[1]] >> 8;
+	for (int k = 0; k < 31; k++)
+	{
+		memcpy(&steps[2 + 2 * k], &s_delta_pairs[delta[2 + k]], 2);
+	}
+
+	__m128i carry = _mm_setzero_si128();
+
+	for (int k = 0; k < 64; k += 16)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i *)&steps[k]);
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi8(x, carry);
+		_mm_storeu_si128((__m128i *)&pcm[k], x);
+
+		// Broadcast the last sample for the next 16.
+		carry = _mm_unpackhi_epi8(x, x);
+		carry = _mm_unpackhi_epi16(carry, carry);
+		carry = _mm_shuffle_epi32(carry, 0xFF);
+	}
+}
+
+#endif // HAVE_SSE2
+
+unsigned long delta_decode(const uint8_t *delta, unsigned long length, uint8_t *pcm, unsigned long max_samples, enum DeltaKernel kernel)
+{
+	uint8_t hi, lo;
+	unsigned long i = 0;
+	unsigned long j = 0;
+	int k;
+	uint8_t base;
+
+#ifdef HAVE_SSE2
+	if (kernel == DELTA_KERNEL_AUTO)
+	{
+		for (; i + 33 <= length && j + 64 <= max_samples; i += 33, j += 64)
+		{
+			decode_block_sse2(&delta[i], &pcm[j]);
+		}
+	}
+#else
+	(void)kernel;
+#endif
+
+	// The rest a sample at a time.
+	while (i < length && j < max_samples)
+	{
+		base = delta[i++];
+		pcm[j++] = base;
+		if (i >= length)
+		{
+			break;
+		}
+		if (j >= max_samples)
+		{
+			break;
+		}
+		lo = delta[i] & 0xf;
+		base += gDeltaEncodingTable[lo];
+		pcm[j++] = base;
+		i++;
+		if (i >= length)
+		{
+			break;
+		}
+		if (j >= max_samples)
+		{
+			break;
+		}
+		for (k = 0; k < 31; k++)
+		{
+			hi = (delta[i] >> 4) & 0xf;
+			base += gDeltaEncodingTable[hi];
+			pcm[j++] = base;
+			if (j >= max_samples)
+			{
+				break;
+			}
+			lo = delta[i] & 0xf;
+			base += gDeltaEncodingTable[lo];
+			pcm[j++] = base;
+			i++;
+			if (i >= length)
+			{
+				break;
+			}
+			if (j >= max_samples)
+			{
+				break;
+			}
+		}
+	}
+
+	return j;
+}
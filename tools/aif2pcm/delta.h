@@ -0,0 +1,51 @@
+// Copyright(c) 2016 huderlem
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stdint.h>
+
+// The delta (DPCM) encoding of the GBA sound engine's compressed samples.
+// Samples come in blocks of 64: a raw byte for the first, then a 4-bit
+// index into gDeltaEncodingTable for each of the other 63, the first of them
+// in the low nibble of the block's second byte and the rest paired up,
+// high nibble first.
+
+extern const int gDeltaEncodingTable[16];
+
+enum DeltaKernel
+{
+	DELTA_KERNEL_AUTO,   // the SIMD kernel where there is one
+	DELTA_KERNEL_SCALAR,
+};
+
+// The most bytes delta_encode writes for num_samples samples.
+unsigned long delta_encoded_size(unsigned long num_samples);
+
+// Encodes the samples, choosing for each one the delta that comes closest to
+// it from the previous decoded sample. Returns the number of bytes written.
+unsigned long delta_encode(const uint8_t *pcm, unsigned long num_samples, uint8_t *delta, enum DeltaKernel kernel);
+
+// Decodes up to max_samples samples. pcm must have room for max_samples.
+// Returns the number of samples written.
+unsigned long delta_decode(const uint8_t *delta, unsigned long length, uint8_t *pcm, unsigned long max_samples, enum DeltaKernel kernel);
+
+#endif // DELTA_H
@@ -0,0 +1,307 @@
+// Copyright(c) 2016 huderlem
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks the delta codec and measures it. For synthetic signals of many
+// lengths, and for any files named on the command line (taken as raw 8-bit
+// samples), it checks that:
+//  - both encoder kernels give exactly the bytes of the encoder aif2pcm
+//    always had, which is copied below;
+//  - decoding with either kernel gives back exactly the samples that
+//    encoder was tracking as it went, i.e. what the GBA will play.
+// Then it reports the speed of each kernel.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include "delta.h"
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int reference_delta_index(uint8_t sample, uint8_t prev_sample)
+{
+	int best_error = INT_MAX;
+	int best_index = -1;
+
+	for (int i = 0; i < 16; i++)
+	{
+		uint8_t new_sample = prev_sample + gDeltaEncodingTable[i];
+		int error = sample > new_sample ? sample - new_sample : new_sample - sample;
+
+		if (error < best_error)
+		{
+			best_error = error;
+			best_index = i;
+		}
+	}
+
+	return best_index;
+}
+
+// The original delta_compress, which also records each decoded sample.
+static unsigned long reference_encode(const uint8_t *pcm, unsigned long length, uint8_t *delta, uint8_t *decoded)
+{
+	unsigned long i = 0;
+	unsigned long j = 0;
+	int k;
+	uint8_t base;
+	int delta_index;
+
+	while (i < length)
+	{
+		base = pcm[i];
+		decoded[i++] = base;
+		delta[j++] = base;
+
+		if (i >= length)
+		{
+			break;
+		}
+		delta_index = reference_delta_index(pcm[i], base);
+		base += gDeltaEncodingTable[delta_index];
+		decoded[i++] = base;
+		delta[j++] = delta_index;
+
+		for (k = 0; k < 31; k++)
+		{
+			if (i >= length)
+			{
+				break;
+			}
+			delta_index = reference_delta_index(pcm[i], base);
+			base += gDeltaEncodingTable[delta_index];
+			decoded[i++] = base;
+			delta[j] = (delta_index << 4);
+
+			if (i >= length)
+			{
+				break;
+			}
+			delta_index = reference_delta_index(pcm[i], base);
+			base += gDeltaEncodingTable[delta_index];
+			decoded[i++] = base;
+			delta[j++] |= delta_index;
+		}
+	}
+
+	return j;
+}
+
+static const char *s_kernel_names[] = { "auto", "scalar" };
+
+// Returns true if the codec agrees with the reference on these samples.
+static bool check(const char *name, const uint8_t *pcm, unsigned long length)
+{
+	unsigned long size = delta_encoded_size(length);
+	uint8_t *expected = malloc(size + 33);
+	uint8_t *decoded = malloc(length + 1);
+	uint8_t *delta = malloc(size + 33);
+	uint8_t *out = malloc(length + 1);
+	unsigned long expected_length = reference_encode(pcm, length, expected, decoded);
+	bool ok = true;
+
+	if (expected_length > size)
+	{
+		fprintf(stderr, "%s: encoded size %lu is over the estimate %lu\n", name, expected_length, size);
+		ok = false;
+	}
+
+	for (int kernel = DELTA_KERNEL_AUTO; kernel <= DELTA_KERNEL_SCALAR; kernel++)
+	{
+		unsigned long delta_length = delta_encode(pcm, length, delta, kernel);
+
+		if (delta_length != expected_length || memcmp(delta, expected, delta_length) != 0)
+		{
+			fprintf(stderr, "%s: %s encoder differs from the reference\n", name, s_kernel_names[kernel]);
+			ok = false;
+		}
+
+		// When the samples run out on a high nibble, the encoder drops
+		// that byte, and its sample with it.
+		unsigned long decoded_length = length;
+		if (length % 64 > 2 && length % 2 == 1)
+		{
+			decoded_length--;
+		}
+
+		unsigned long out_length = delta_decode(expected, expected_length, out, length, kernel);
+
+		if (out_length != decoded_length || memcmp(out, decoded, out_length) != 0)
+		{
+			fprintf(stderr, "%s: %s decoder doesn't round-trip\n", name, s_kernel_names[kernel]);
+			ok = false;
+		}
+	}
+
+	free(expected);
+	free(decoded);
+	free(delta);
+	free(out);
+	return ok;
+}
+
+static uint32_t s_rng = 12345;
+
+static uint8_t random_byte(void)
+{
+	s_rng = s_rng * 1103515245 + 12345;
+	return s_rng >> 16;
+}
+
+// Fills the buffer with one of several kinds of signal.
+static void synthesize(uint8_t *pcm, unsigned long length, int kind)
+{
+	int value = 0;
+
+	for (unsigned long i = 0; i < length; i++)
+	{
+		switch (kind)
+		{
+		case 0: // noise
+			pcm[i] = random_byte();
+			break;
+		case 1: // random walk with small steps, like most recorded sound
+			value += (random_byte() % 17) - 8;
+			pcm[i] = value;
+			break;
+		case 2: // square wave at the extremes
+			pcm[i] = (i / 5) % 2 ? 0x7f : 0x80;
+			break;
+		case 3: // silence
+			pcm[i] = 0;
+			break;
+		}
+	}
+}
+
+static uint8_t *read_file(const char *filename, unsigned long *length)
+{
+	FILE *f = fopen(filename, "rb");
+
+	if (!f)
+	{
+		fprintf(stderr, "Failed to open '%s' for reading!\n", filename);
+		exit(1);
+	}
+	fseek(f, 0, SEEK_END);
+	*length = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	uint8_t *data = malloc(*length + 1);
+	if (fread(data, 1, *length, f) != *length)
+	{
+		fprintf(stderr, "Failed to read data from '%s'!\n", filename);
+		exit(1);
+	}
+	fclose(f);
+	return data;
+}
+
+static void bench(const uint8_t *pcm, unsigned long length)
+{
+	uint8_t *delta = malloc(delta_encoded_size(length) + 33);
+	uint8_t *out = malloc(length);
+	unsigned long delta_length = delta_encode(pcm, length, delta, DELTA_KERNEL_SCALAR);
+	int iterations = 1 + (64 << 20) / length;
+
+	for (int kernel = DELTA_KERNEL_AUTO; kernel <= DELTA_KERNEL_SCALAR; kernel++)
+	{
+		double start = now();
+		for (int i = 0; i < iterations; i++)
+		{
+			delta_encode(pcm, length, delta, kernel);
+		}
+		double encode_time = now() - start;
+
+		start = now();
+		for (int i = 0; i < iterations; i++)
+		{
+			delta_decode(delta, delta_length, out, length, kernel);
+		}
+		double decode_time = now() - start;
+
+		double mib = (double)length * iterations / (1 << 20);
+		printf("%-8s encode %8.1f MiB/s   decode %8.1f MiB/s\n", s_kernel_names[kernel], mib / encode_time, mib / decode_time);
+	}
+
+	free(delta);
+	free(out);
+}
+
+int main(int argc, char **argv)
+{
+	bool ok = true;
+	int checked = 0;
+	char name[64];
+	uint8_t *pcm = malloc(4096);
+
+	for (int kind = 0; kind < 4; kind++)
+	{
+		for (unsigned long length = 0; length <= 4096; length = length < 200 ? length + 1 : length * 2)
+		{
+			synthesize(pcm, length, kind);
+			snprintf(name, sizeof(name), "signal %d, %lu samples", kind, length);
+			ok &= check(name, pcm, length);
+			checked++;
+		}
+	}
+	free(pcm);
+
+	unsigned long corpus_length = 0;
+	uint8_t *corpus = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		unsigned long length;
+		uint8_t *data = read_file(argv[i], &length);
+
+		ok &= check(argv[i], data, length);
+		checked++;
+
+		corpus = realloc(corpus, corpus_length + length);
+		memcpy(corpus + corpus_length, data, length);
+		corpus_length += length;
+		free(data);
+	}
+
+	printf("%d inputs checked, %s\n", checked, ok ? "all match" : "MISMATCHES");
+
+	if (corpus_length == 0)
+	{
+		corpus_length = 1 << 20;
+		corpus = malloc(corpus_length);
+		synthesize(corpus, corpus_length, 1);
+	}
+	bench(corpus, corpus_length);
+	free(corpus);
+
+	return ok ? 0 : 1;
+}
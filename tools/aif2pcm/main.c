@@ -18,12 +18,16 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "delta.h"
 
 /* extended.c */
 void ieee754_write_extended (double, uint8_t*);
@@ -345,165 +349,19 @@ void read_aif(struct Bytes *aif, AifData *aif_data)
 	}
 }
 
-// This is a table of deltas between sample values in compressed PCM data.
-const int gDeltaEncodingTable[] = {
-	0, 1, 4, 9, 16, 25, 36, 49,
-	-64, -49, -36, -25, -16, -9, -4, -1,
-};
-
 struct Bytes *delta_decompress(struct Bytes *delta, unsigned int expected_length)
 {
 	struct Bytes *pcm = malloc(sizeof(struct Bytes));
-	pcm->length = expected_length;
-	pcm->data = malloc(pcm->length + 0x40);
-
-	uint8_t hi, lo;
-	unsigned int i = 0;
-	unsigned int j = 0;
-	int k;
-	int8_t base;
-	while (i < delta->length)
-	{
-		base = (int8_t)delta->data[i++];
-		pcm->data[j++] = (uint8_t)base;
-		if (i >= delta->length)
-		{
-			break;
-		}
-		if (j >= pcm->length)
-		{
-			break;
-		}
-		lo = delta->data[i] & 0xf;
-		base += gDeltaEncodingTable[lo];
-		pcm->data[j++] = base;
-		i++;
-		if (i >= delta->length)
-		{
-			break;
-		}
-		if (j >= pcm->length)
-		{
-			break;
-		}
-		for (k = 0; k < 31; k++)
-		{
-			hi = (delta->data[i] >> 4) & 0xf;
-			base += gDeltaEncodingTable[hi];
-			pcm->data[j++] = base;
-			if (j >= pcm->length)
-			{
-				break;
-			}
-			lo = delta->data[i] & 0xf;
-			base += gDeltaEncodingTable[lo];
-			pcm->data[j++] = base;
-			i++;
-			if (i >= delta->length)
-			{
-				break;
-			}
-			if (j >= pcm->length)
-			{
-				break;
-			}
-		}
-		if (j >= pcm->length)
-		{
-			break;
-		}
-	}
-
-	pcm->length = j;
+	pcm->data = malloc(expected_length + 0x40);
+	pcm->length = delta_decode(delta->data, delta->length, pcm->data, expected_length, DELTA_KERNEL_AUTO);
 	return pcm;
 }
 
-int get_delta_index(uint8_t sample, uint8_t prev_sample)
-{
-	int best_error = INT_MAX;
-	int best_index = -1;
-
-	for (int i = 0; i < 16; i++)
-	{
-		uint8_t new_sample = prev_sample + gDeltaEncodingTable[i];
-		int error = sample > new_sample ? sample - new_sample : new_sample - sample;
-
-		if (error < best_error)
-		{
-			best_error = error;
-			best_index = i;
-		}
-	}
-
-	return best_index;
-}
-
 struct Bytes *delta_compress(struct Bytes *pcm)
 {
 	struct Bytes *delta = malloc(sizeof(struct Bytes));
-	// estimate the length so we can malloc
-	int num_blocks = pcm->length / 64;
-	delta->length = num_blocks * 33;
-
-	int extra = pcm->length % 64;
-	if (extra)
-	{
-		delta->length += 1;
-		extra -= 1;
-	}
-	if (extra)
-	{
-		delta->length += 1;
-		extra -= 1;
-	}
-	if (extra)
-	{
-		delta->length += (extra + 1) / 2;
-	}
-
-	delta->data = malloc(delta->length + 33);
-
-	unsigned int i = 0;
-	unsigned int j = 0;
-	int k;
-	uint8_t base;
-	int delta_index;
-
-	while (i < pcm->length)
-	{
-		base = pcm->data[i++];
-		delta->data[j++] = base;
-
-		if (i >= pcm->length)
-		{
-			break;
-		}
-		delta_index = get_delta_index(pcm->data[i++], base);
-		base += gDeltaEncodingTable[delta_index];
-		delta->data[j++] = delta_index;
-
-		for (k = 0; k < 31; k++)
-		{
-			if (i >= pcm->length)
-			{
-				break;
-			}
-			delta_index = get_delta_index(pcm->data[i++], base);
-			base += gDeltaEncodingTable[delta_index];
-			delta->data[j] = (delta_index << 4);
-
-			if (i >= pcm->length)
-			{
-				break;
-			}
-			delta_index = get_delta_index(pcm->data[i++], base);
-			base += gDeltaEncodingTable[delta_index];
-			delta->data[j++] |= delta_index;
-		}
-	}
-
-	delta->length = j;
-
+	delta->data = malloc(delta_encoded_size(pcm->length) + 33);
+	delta->length = delta_encode(pcm->data, pcm->length, delta->data, DELTA_KERNEL_AUTO);
 	return delta;
 }
 
@@ -566,6 +424,10 @@ void aif2pcm(const char *aif_filename, const char *pcm_filename, bool compress)
 
 	free(aif->data);
 	free(aif);
+	if (compress)
+	{
+		free(pcm->data);
+	}
 	free(pcm);
 	free(output.data);
 	free(aif_data.samples);
@@ -825,21 +687,26 @@ void usage(void)
 {
 	fprintf(stderr, "Usage: aif2pcm bin_file [aif_file]\n");
 	fprintf(stderr, "       aif2pcm aif_file [bin_file] [--compress]\n");
+	fprintf(stderr, "       aif2pcm --batch [-j threads] list_file\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "--batch converts each line of list_file, which holds the arguments for one\n");
+	fprintf(stderr, "file as above, on several threads.\n");
 }
 
-int main(int argc, char **argv)
+// Converts one file. argv[1] is the input file, and the optional output
+// file and flags follow, as on the command line.
+void convert(int argc, char **argv)
 {
-	if (argc < 2)
-	{
-		usage();
-		exit(1);
-	}
-
 	char *input_file = argv[1];
 	char *extension = get_file_extension(input_file);
 	char *output_file;
 	bool compressed = false;
 
+	if (!extension)
+	{
+		extension = "";
+	}
+
 	if (argc > 3)
 	{
 		for (int i = 3; i < argc; i++)
@@ -883,6 +750,151 @@ int main(int argc, char **argv)
 	{
 		FATAL_ERROR("Input file must be .aif or .bin: '%s'\n", input_file);
 	}
+}
+
+#define MAX_BATCH_ARGS 8
+
+struct BatchJob {
+	int argc;
+	char *argv[MAX_BATCH_ARGS];
+};
+
+struct Batch {
+	struct BatchJob *jobs;
+	int num_jobs;
+	int next_job;
+	pthread_mutex_t mutex;
+};
+
+void *batch_worker(void *arg)
+{
+	struct Batch *batch = arg;
+
+	for (;;)
+	{
+		pthread_mutex_lock(&batch->mutex);
+		int job = batch->next_job++;
+		pthread_mutex_unlock(&batch->mutex);
+
+		if (job >= batch->num_jobs)
+		{
+			return NULL;
+		}
+		convert(batch->jobs[job].argc, batch->jobs[job].argv);
+	}
+}
+
+// Runs every line of the list file through convert(), splitting the lines
+// into arguments in place.
+void run_batch(const char *list_filename, long num_threads)
+{
+	struct Bytes *list = read_bytearray(list_filename);
+	struct Batch batch = {0};
+	char *text = malloc(list->length + 1);
+
+	memcpy(text, list->data, list->length);
+	text[list->length] = '\0';
+
+	int num_lines = 1;
+	for (unsigned long i = 0; i < list->length; i++)
+	{
+		if (text[i] == '\n')
+		{
+			num_lines++;
+		}
+	}
+	batch.jobs = malloc(num_lines * sizeof(struct BatchJob));
+
+	char *line_save;
+
+	for (char *line = strtok_r(text, "\n", &line_save); line; line = strtok_r(NULL, "\n", &line_save))
+	{
+		struct BatchJob *job = &batch.jobs[batch.num_jobs];
+		char *save;
+
+		job->argc = 1;
+		job->argv[0] = "aif2pcm";
+		for (char *word = strtok_r(line, " \t\r", &save); word; word = strtok_r(NULL, " \t\r", &save))
+		{
+			if (job->argc == MAX_BATCH_ARGS)
+			{
+				FATAL_ERROR("Too many arguments in line %d of '%s'!\n", batch.num_jobs + 1, list_filename);
+			}
+			job->argv[job->argc++] = word;
+		}
+		if (job->argc > 1)
+		{
+			batch.num_jobs++;
+		}
+	}
+
+	if (num_threads == 0)
+	{
+		num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (num_threads > batch.num_jobs)
+	{
+		num_threads = batch.num_jobs;
+	}
+	if (num_threads < 1)
+	{
+		num_threads = 1;
+	}
+
+	pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+	pthread_mutex_init(&batch.mutex, NULL);
+
+	for (long i = 0; i < num_threads; i++)
+	{
+		if (pthread_create(&threads[i], NULL, batch_worker, &batch) != 0)
+		{
+			FATAL_ERROR("Failed to create thread!\n");
+		}
+	}
+	for (long i = 0; i < num_threads; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	pthread_mutex_destroy(&batch.mutex);
+	free(threads);
+	free(batch.jobs);
+	free(text);
+	free_bytearray(list);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		usage();
+		exit(1);
+	}
+
+	if (strcmp(argv[1], "--batch") == 0)
+	{
+		long num_threads = 0;
+		int arg = 2;
+
+		if (arg + 1 < argc && strcmp(argv[arg], "-j") == 0)
+		{
+			num_threads = strtol(argv[arg + 1], NULL, 10);
+			if (num_threads < 1)
+			{
+				FATAL_ERROR("-j needs a positive number of threads!\n");
+			}
+			arg += 2;
+		}
+		if (arg + 1 != argc)
+		{
+			usage();
+			exit(1);
+		}
+		run_batch(argv[arg], num_threads);
+		return 0;
+	}
+
+	convert(argc, argv);
 
 	return 0;
 }
@@ -1,11 +1,14 @@
 // Copyright (c) 2015 YamaArashi
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 #include <png.h>
 #include "global.h"
 #include "convert_png.h"
 #include "gfx.h"
+#include "util.h"
 
 static FILE *PngReadOpen(char *path, png_structp *pngStruct, png_infop *pngInfo)
 {
@@ -185,12 +188,44 @@ void SetPngPalette(png_structp png_ptr, png_infop info_ptr, struct Palette *pale
     free(colors);
 }
 
-void WritePng(char *path, struct Image *image)
+// The PNG is encoded into memory so that it goes through WriteWholeFile.
+struct PngBuffer
 {
-    FILE *fp = fopen(path, "wb");
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+};
 
-    if (fp == NULL)
-        FATAL_ERROR("Failed to open \"%s\" for writing.\n", path);
+static void WritePngData(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+    struct PngBuffer *buffer = png_get_io_ptr(png_ptr);
+
+    if (buffer->size + length > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+
+        while (capacity < buffer->size + length)
+            capacity *= 2;
+
+        buffer->data = realloc(buffer->data, capacity);
+
+        if (buffer->data == NULL)
+            FATAL_ERROR("Failed to allocate PNG output buffer.\n");
+
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->size, data, length);
+    buffer->size += length;
+}
+
+static void FlushPngData(png_structp png_ptr)
+{
+    (void)png_ptr;
+}
+
+void WritePng(char *path, struct Image *image)
+{
+    struct PngBuffer buffer = {NULL, 0, 0};
 
     png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
 
@@ -205,7 +240,7 @@ void WritePng(char *path, struct Image *image)
     if (setjmp(png_jmpbuf(png_ptr)))
         FATAL_ERROR("Failed to init I/O for writing \"%s\".\n", path);
 
-    png_init_io(png_ptr, fp);
+    png_set_write_fn(png_ptr, &buffer, WritePngData, FlushPngData);
 
     if (setjmp(png_jmpbuf(png_ptr)))
         FATAL_ERROR("Error writing header for \"%s\".\n", path);
@@ -247,7 +282,8 @@ void WritePng(char *path, struct Image *image)
 
     png_write_end(png_ptr, NULL);
 
-    fclose(fp);
+    WriteWholeFile(path, buffer.data, buffer.size);
+    free(buffer.data);
 
     png_destroy_write_struct(&png_ptr, &info_ptr);
     free(row_pointers);
@@ -8,6 +8,7 @@
 #include "global.h"
 #include "gfx.h"
 #include "util.h"
+#include "tiles.h"
 
 #define GET_GBA_PAL_RED(x)   (((x) >>  0) & 0x1F)
 #define GET_GBA_PAL_GREEN(x) (((x) >>  5) & 0x1F)
@@ -19,191 +20,6 @@
 
 #define DOWNCONVERT_BIT_DEPTH(x) ((x) / 8)
 
-static void AdvanceMetatilePosition(int *subTileX, int *subTileY, int *metatileX, int *metatileY, int metatilesWide, int metatileWidth, int metatileHeight)
-{
-	(*subTileX)++;
-	if (*subTileX == metatileWidth) {
-		*subTileX = 0;
-		(*subTileY)++;
-		if (*subTileY == metatileHeight) {
-			*subTileY = 0;
-			(*metatileX)++;
-			if (*metatileX == metatilesWide) {
-				*metatileX = 0;
-				(*metatileY)++;
-			}
-		}
-	}
-}
-
-static void ConvertFromTiles1Bpp(unsigned char *src, unsigned char *dest, int numTiles, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors)
-{
-	int subTileX = 0;
-	int subTileY = 0;
-	int metatileX = 0;
-	int metatileY = 0;
-	int pitch = metatilesWide * metatileWidth;
-
-	for (int i = 0; i < numTiles; i++) {
-		for (int j = 0; j < 8; j++) {
-			int destY = (metatileY * metatileHeight + subTileY) * 8 + j;
-			int destX = metatileX * metatileWidth + subTileX;
-			unsigned char srcPixelOctet = *src++;
-			unsigned char *destPixelOctet = &dest[destY * pitch + destX];
-
-			for (int k = 0; k < 8; k++) {
-				*destPixelOctet <<= 1;
-				*destPixelOctet |= (srcPixelOctet & 1) ^ invertColors;
-				srcPixelOctet >>= 1;
-			}
-		}
-
-		AdvanceMetatilePosition(&subTileX, &subTileY, &metatileX, &metatileY, metatilesWide, metatileWidth, metatileHeight);
-	}
-}
-
-static void ConvertFromTiles4Bpp(unsigned char *src, unsigned char *dest, int numTiles, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors)
-{
-	int subTileX = 0;
-	int subTileY = 0;
-	int metatileX = 0;
-	int metatileY = 0;
-	int pitch = (metatilesWide * metatileWidth) * 4;
-
-	for (int i = 0; i < numTiles; i++) {
-		for (int j = 0; j < 8; j++) {
-			int destY = (metatileY * metatileHeight + subTileY) * 8 + j;
-
-			for (int k = 0; k < 4; k++) {
-				int destX = (metatileX * metatileWidth + subTileX) * 4 + k;
-				unsigned char srcPixelPair = *src++;
-				unsigned char leftPixel = srcPixelPair & 0xF;
-				unsigned char rightPixel = srcPixelPair >> 4;
-
-				if (invertColors) {
-					leftPixel = 15 - leftPixel;
-					rightPixel = 15 - rightPixel;
-				}
-
-				dest[destY * pitch + destX] = (leftPixel << 4) | rightPixel;
-			}
-		}
-
-		AdvanceMetatilePosition(&subTileX, &subTileY, &metatileX, &metatileY, metatilesWide, metatileWidth, metatileHeight);
-	}
-}
-
-static void ConvertFromTiles8Bpp(unsigned char *src, unsigned char *dest, int numTiles, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors)
-{
-	int subTileX = 0;
-	int subTileY = 0;
-	int metatileX = 0;
-	int metatileY = 0;
-	int pitch = (metatilesWide * metatileWidth) * 8;
-
-	for (int i = 0; i < numTiles; i++) {
-		for (int j = 0; j < 8; j++) {
-			int destY = (metatileY * metatileHeight + subTileY) * 8 + j;
-
-			for (int k = 0; k < 8; k++) {
-				int destX = (metatileX * metatileWidth + subTileX) * 8 + k;
-				unsigned char srcPixel = *src++;
-
-				if (invertColors)
-					srcPixel = 255 - srcPixel;
-
-				dest[destY * pitch + destX] = srcPixel;
-			}
-		}
-
-		AdvanceMetatilePosition(&subTileX, &subTileY, &metatileX, &metatileY, metatilesWide, metatileWidth, metatileHeight);
-	}
-}
-
-static void ConvertToTiles1Bpp(unsigned char *src, unsigned char *dest, int numTiles, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors)
-{
-	int subTileX = 0;
-	int subTileY = 0;
-	int metatileX = 0;
-	int metatileY = 0;
-	int pitch = metatilesWide * metatileWidth;
-
-	for (int i = 0; i < numTiles; i++) {
-		for (int j = 0; j < 8; j++) {
-			int srcY = (metatileY * metatileHeight + subTileY) * 8 + j;
-			int srcX = metatileX * metatileWidth + subTileX;
-			unsigned char srcPixelOctet = src[srcY * pitch + srcX];
-			unsigned char *destPixelOctet = dest++;
-
-			for (int k = 0; k < 8; k++) {
-				*destPixelOctet <<= 1;
-				*destPixelOctet |= (srcPixelOctet & 1) ^ invertColors;
-				srcPixelOctet >>= 1;
-			}
-		}
-
-		AdvanceMetatilePosition(&subTileX, &subTileY, &metatileX, &metatileY, metatilesWide, metatileWidth, metatileHeight);
-	}
-}
-
-static void ConvertToTiles4Bpp(unsigned char *src, unsigned char *dest, int numTiles, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors)
-{
-	int subTileX = 0;
-	int subTileY = 0;
-	int metatileX = 0;
-	int metatileY = 0;
-	int pitch = (metatilesWide * metatileWidth) * 4;
-
-	for (int i = 0; i < numTiles; i++) {
-		for (int j = 0; j < 8; j++) {
-			int srcY = (metatileY * metatileHeight + subTileY) * 8 + j;
-
-			for (int k = 0; k < 4; k++) {
-				int srcX = (metatileX * metatileWidth + subTileX) * 4 + k;
-				unsigned char srcPixelPair = src[srcY * pitch + srcX];
-				unsigned char leftPixel = srcPixelPair >> 4;
-				unsigned char rightPixel = srcPixelPair & 0xF;
-
-				if (invertColors) {
-					leftPixel = 15 - leftPixel;
-					rightPixel = 15 - rightPixel;
-				}
-
-				*dest++ = (rightPixel << 4) | leftPixel;
-			}
-		}
-
-		AdvanceMetatilePosition(&subTileX, &subTileY, &metatileX, &metatileY, metatilesWide, metatileWidth, metatileHeight);
-	}
-}
-
-static void ConvertToTiles8Bpp(unsigned char *src, unsigned char *dest, int numTiles, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors)
-{
-	int subTileX = 0;
-	int subTileY = 0;
-	int metatileX = 0;
-	int metatileY = 0;
-	int pitch = (metatilesWide * metatileWidth) * 8;
-
-	for (int i = 0; i < numTiles; i++) {
-		for (int j = 0; j < 8; j++) {
-			int srcY = (metatileY * metatileHeight + subTileY) * 8 + j;
-
-			for (int k = 0; k < 8; k++) {
-				int srcX = (metatileX * metatileWidth + subTileX) * 8 + k;
-				unsigned char srcPixel = src[srcY * pitch + srcX];
-
-				if (invertColors)
-					srcPixel = 255 - srcPixel;
-
-				*dest++ = srcPixel;
-			}
-		}
-
-		AdvanceMetatilePosition(&subTileX, &subTileY, &metatileX, &metatileY, metatilesWide, metatileWidth, metatileHeight);
-	}
-}
-
 static void DecodeAffineTilemap(unsigned char *input, unsigned char *output, unsigned char *tilemap, int tileSize, int numTiles)
 {
     for (int i = 0; i < numTiles; i++)
@@ -382,17 +198,7 @@ void ReadImage(char *path, int tilesWidth, int bitDepth, int metatileWidth, int
 
 	int metatilesWide = tilesWidth / metatileWidth;
 
-	switch (bitDepth) {
-	case 1:
-		ConvertFromTiles1Bpp(buffer, image->pixels, numTiles, metatilesWide, metatileWidth, metatileHeight, invertColors);
-		break;
-	case 4:
-		ConvertFromTiles4Bpp(buffer, image->pixels, numTiles, metatilesWide, metatileWidth, metatileHeight, invertColors);
-		break;
-	case 8:
-		ConvertFromTiles8Bpp(buffer, image->pixels, numTiles, metatilesWide, metatileWidth, metatileHeight, invertColors);
-		break;
-	}
+	ConvertFromTiles(buffer, image->pixels, numTiles, bitDepth, metatilesWide, metatileWidth, metatileHeight, invertColors, TILE_KERNEL_BEST);
 
 	free(buffer);
 }
@@ -431,23 +237,190 @@ void WriteImage(char *path, int numTiles, int bitDepth, int metatileWidth, int m
 
 	int metatilesWide = tilesWidth / metatileWidth;
 
-	switch (bitDepth) {
-	case 1:
-		ConvertToTiles1Bpp(image->pixels, buffer, numTiles, metatilesWide, metatileWidth, metatileHeight, invertColors);
-		break;
-	case 4:
-		ConvertToTiles4Bpp(image->pixels, buffer, numTiles, metatilesWide, metatileWidth, metatileHeight, invertColors);
-		break;
-	case 8:
-		ConvertToTiles8Bpp(image->pixels, buffer, numTiles, metatilesWide, metatileWidth, metatileHeight, invertColors);
-		break;
-	}
+	ConvertToTiles(image->pixels, buffer, numTiles, bitDepth, metatilesWide, metatileWidth, metatileHeight, invertColors, TILE_KERNEL_BEST);
 
 	WriteWholeFile(path, buffer, bufferSize);
 
 	free(buffer);
 }
 
+// Hash index over the distinct tiles found so far, for deduplication.
+struct TileIndex
+{
+	unsigned char *tiles;
+	int tileSize;
+	int numTiles;
+	int *slots;
+	int mask;
+};
+
+static unsigned int HashTile(unsigned char *tile, int tileSize)
+{
+	unsigned int hash = 2166136261u;
+
+	for (int i = 0; i < tileSize; i++)
+		hash = (hash ^ tile[i]) * 16777619u;
+
+	return hash;
+}
+
+static int FindTile(struct TileIndex *index, unsigned char *tile)
+{
+	for (unsigned int slot = HashTile(tile, index->tileSize) & index->mask; index->slots[slot] != -1; slot = (slot + 1) & index->mask) {
+		if (memcmp(&index->tiles[index->slots[slot] * index->tileSize], tile, index->tileSize) == 0)
+			return index->slots[slot];
+	}
+
+	return -1;
+}
+
+static int AddTile(struct TileIndex *index, unsigned char *tile)
+{
+	unsigned int slot = HashTile(tile, index->tileSize) & index->mask;
+
+	while (index->slots[slot] != -1)
+		slot = (slot + 1) & index->mask;
+
+	memcpy(&index->tiles[index->numTiles * index->tileSize], tile, index->tileSize);
+	index->slots[slot] = index->numTiles;
+	return index->numTiles++;
+}
+
+// Writes only the distinct tiles of the image, along with a tilemap that
+// rebuilds the image from them, in the format that ReadImage decodes. For
+// non-affine maps, tiles that match an earlier tile when flipped
+// horizontally and/or vertically reuse it with the flip flags set. The
+// pixels must be 8 bits each. For 4bpp output with paletteBanks set, the top
+// nibble of each pixel selects the palette (as 15 - palette number, like
+// DecodeNonAffineTilemap) and the bottom nibble the color within it. Tiles
+// that differ only in palette then share their tile data.
+void WriteImageWithTilemap(char *path, char *tilemapPath, int numTiles, int bitDepth, int metatileWidth, int metatileHeight, struct Image *image, bool isAffine, bool paletteBanks, bool invertColors)
+{
+	if (bitDepth != 4 && bitDepth != 8)
+		FATAL_ERROR("Tilemaps can only be generated for 4bpp or 8bpp images.\n");
+
+	if (isAffine && bitDepth != 8)
+		FATAL_ERROR("affine maps are necessarily 8bpp\n");
+
+	if (image->width % 8 != 0)
+		FATAL_ERROR("The width in pixels (%d) isn't a multiple of 8.\n", image->width);
+
+	if (image->height % 8 != 0)
+		FATAL_ERROR("The height in pixels (%d) isn't a multiple of 8.\n", image->height);
+
+	int tilesWidth = image->width / 8;
+	int tilesHeight = image->height / 8;
+
+	if (tilesWidth % metatileWidth != 0)
+		FATAL_ERROR("The width in tiles (%d) isn't a multiple of the specified metatile width (%d)", tilesWidth, metatileWidth);
+
+	if (tilesHeight % metatileHeight != 0)
+		FATAL_ERROR("The height in tiles (%d) isn't a multiple of the specified metatile height (%d)", tilesHeight, metatileHeight);
+
+	int maxNumTiles = tilesWidth * tilesHeight;
+
+	if (numTiles == 0)
+		numTiles = maxNumTiles;
+	else if (numTiles > maxNumTiles)
+		FATAL_ERROR("The specified number of tiles (%d) is greater than the maximum possible value (%d).\n", numTiles, maxNumTiles);
+
+	int tileSize = bitDepth * 8;
+	int mapEntrySize = isAffine ? 1 : 2;
+	int maxTileIndex = isAffine ? 0xFF : 0x3FF;
+	unsigned char *pixelTiles = malloc(numTiles * 64);
+	unsigned char *tilemap = malloc(numTiles * mapEntrySize);
+	struct TileIndex index;
+
+	index.tileSize = tileSize;
+	index.numTiles = 0;
+	index.tiles = malloc(numTiles * tileSize);
+	index.mask = 1;
+
+	while (index.mask < numTiles * 2)
+		index.mask *= 2;
+
+	index.slots = malloc(index.mask * sizeof(int));
+	index.mask--;
+
+	if (pixelTiles == NULL || tilemap == NULL || index.tiles == NULL || index.slots == NULL)
+		FATAL_ERROR("Failed to allocate memory for tiles.\n");
+
+	for (int i = 0; i <= index.mask; i++)
+		index.slots[i] = -1;
+
+	int metatilesWide = tilesWidth / metatileWidth;
+
+	ConvertToTiles(image->pixels, pixelTiles, numTiles, 8, metatilesWide, metatileWidth, metatileHeight, invertColors, TILE_KERNEL_BEST);
+
+	for (int i = 0; i < numTiles; i++) {
+		unsigned char *pixels = &pixelTiles[i * 64];
+		unsigned char tile[64];
+		int palette = 0;
+
+		if (bitDepth == 4) {
+			int bank = pixels[0] >> 4;
+
+			memset(tile, 0, 32);
+
+			for (int j = 0; j < 64; j++) {
+				if (paletteBanks && (pixels[j] >> 4) != bank)
+					FATAL_ERROR("Tile %d uses colors from more than one palette.\n", i);
+				tile[j / 2] |= (pixels[j] & 0xF) << ((j & 1) * 4);
+			}
+
+			if (paletteBanks)
+				palette = 15 - bank;
+		} else {
+			memcpy(tile, pixels, 64);
+		}
+
+		int tileIndex = -1;
+		int flip;
+
+		for (flip = 0; flip < (isAffine ? 1 : 4); flip++) {
+			unsigned char flipped[64];
+
+			memcpy(flipped, tile, tileSize);
+
+			if (flip & 1)
+				HflipTile(flipped, bitDepth);
+
+			if (flip & 2)
+				VflipTile(flipped, bitDepth);
+
+			tileIndex = FindTile(&index, flipped);
+
+			if (tileIndex != -1)
+				break;
+		}
+
+		if (tileIndex == -1) {
+			tileIndex = AddTile(&index, tile);
+			flip = 0;
+		}
+
+		if (tileIndex > maxTileIndex)
+			FATAL_ERROR("The image has more than %d distinct tiles.\n", maxTileIndex + 1);
+
+		if (isAffine) {
+			tilemap[i] = tileIndex;
+		} else {
+			int entry = tileIndex | (flip << 10) | (palette << 12);
+
+			tilemap[i * 2] = entry;
+			tilemap[i * 2 + 1] = entry >> 8;
+		}
+	}
+
+	WriteWholeFile(path, index.tiles, index.numTiles * tileSize);
+	WriteWholeFile(tilemapPath, tilemap, numTiles * mapEntrySize);
+
+	free(index.slots);
+	free(index.tiles);
+	free(tilemap);
+	free(pixelTiles);
+}
+
 void FreeImage(struct Image *image)
 {
 	if (image->tilemap.data.affine != NULL)
@@ -487,10 +460,7 @@ void ReadGbaPalette(char *path, struct Palette *palette)
 
 void WriteGbaPalette(char *path, struct Palette *palette)
 {
-	FILE *fp = fopen(path, "wb");
-
-	if (fp == NULL)
-		FATAL_ERROR("Failed to open \"%s\" for writing.\n", path);
+	unsigned char data[256 * 2];
 
 	for (int i = 0; i < palette->numColors; i++) {
 		unsigned char red = DOWNCONVERT_BIT_DEPTH(palette->colors[i].red);
@@ -499,9 +469,9 @@ void WriteGbaPalette(char *path, struct Palette *palette)
 
 		uint16_t paletteEntry = SET_GBA_PAL(red, green, blue);
 
-		fputc(paletteEntry & 0xFF, fp);
-		fputc(paletteEntry >> 8, fp);
+		data[i * 2] = paletteEntry & 0xFF;
+		data[i * 2 + 1] = paletteEntry >> 8;
 	}
 
-	fclose(fp);
+	WriteWholeFile(path, data, palette->numColors * 2);
 }
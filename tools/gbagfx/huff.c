@@ -1,217 +1,330 @@
 #include <stdbool.h>
 #include <string.h>
-#include <assert.h>
 #include <stdio.h>
 #include <stdint.h>
 #include "global.h"
 #include "huff.h"
 
-static int cmp_tree(const void * a0, const void * b0) {
-    return ((struct HuffData *)a0)->value - ((struct HuffData *)b0)->value;
+/*
+ * Format (as read by the BIOS's HuffUnComp):
+ *
+ *  0     0x20 | bit depth (4 or 8)
+ *  1-3   uncompressed size
+ *  4     tree size / 2 - 1, where the tree size counts this byte
+ *  5     the tree, starting with the root node
+ *  ...   the bitstream, in 32-bit little-endian words read from the top bit
+ *
+ * Each internal node's children are stored as a pair of nodes, at
+ * (address of the node & ~1) + offset * 2 + 2, where the offset is the low
+ * 6 bits of the node. A 0 bit takes the first child and a 1 bit the second.
+ * Bits 7 and 6 say whether the first and second child are leaves, which
+ * hold a symbol. Symbols make up the uncompressed data from the lowest bits
+ * of each word up.
+ */
+
+#define MAX_SYMBOLS 256
+#define MAX_NODES (2 * MAX_SYMBOLS - 1)
+#define MAX_OFFSET 0x3F
+#define TREE_START 5
+
+// Codes this long or shorter are decoded with a single table lookup.
+#define TABLE_BITS 10
+
+struct HuffCode {
+    uint64_t bits;
+    int length;
+};
+
+struct HuffTree {
+    int numNodes;
+    bool isLeaf[MAX_NODES];
+    unsigned char symbol[MAX_NODES];
+    int children[MAX_NODES][2];
+    int numLeaves[MAX_NODES]; // in the subtree
+};
+
+/*
+=======================================
+TREE CONSTRUCTION
+=======================================
+ */
+
+struct HeapEntry {
+    uint32_t freq;
+    int node;
+};
+
+static bool HeapLess(struct HeapEntry * a, struct HeapEntry * b) {
+    return a->freq < b->freq || (a->freq == b->freq && a->node < b->node);
 }
 
-typedef int (*cmpfun)(const void *, const void *);
-
-int msort_r(void * data, size_t count, size_t size, cmpfun cmp, void * buffer) {
-    /*
-     * Out-of-place mergesort (stable sort)
-     * Returns 1 on success, 0 on failure
-     */
-    void * leftPtr;
-    void * rightPtr;
-    void * leftEnd;
-    void * rightEnd;
-    int i;
-
-    switch (count) {
-    case 0:
-        // Should never be here
-        return 0;
-
-    case 1:
-        // Nothing to do here
-        break;
-
-    case 2:
-        // Swap the two entries if the right one compares higher.
-        if (cmp(data, data + size) > 0) {
-            memcpy(buffer, data, size);
-            memcpy(data, data + size, size);
-            memcpy(data + size, buffer, size);
-        }
-        break;
-    default:
-        // Merge sort out-of-place.
-        leftPtr = data;
-        leftEnd = rightPtr = data + count / 2 * size;
-        rightEnd = data + count * size;
-
-        // Sort the left half
-        if (!msort_r(leftPtr, count / 2, size, cmp, buffer))
-            return 0;
-
-        // Sort the right half
-        if (!msort_r(rightPtr, count / 2 + (count & 1), size, cmp, buffer))
-            return 0;
-
-        // Merge the sorted halves out of place
-        i = 0;
-        do {
-            if (cmp(leftPtr, rightPtr) <= 0) {
-                memcpy(buffer + i * size, leftPtr, size);
-                leftPtr += size;
-            } else {
-                memcpy(buffer + i * size, rightPtr, size);
-                rightPtr += size;
-            }
+static void HeapPush(struct HeapEntry * heap, int * size, struct HeapEntry entry) {
+    int i = (*size)++;
 
-        } while (++i < count && leftPtr < leftEnd && rightPtr < rightEnd);
+    while (i > 0 && HeapLess(&entry, &heap[(i - 1) / 2])) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
 
-        // Copy the remainder
-        if (i < count) {
-            if (leftPtr < leftEnd) {
-                memcpy(buffer + i * size, leftPtr, leftEnd - leftPtr);
-            }
-            else {
-                memcpy(buffer + i * size, rightPtr, rightEnd - rightPtr);
-            }
-        }
+    heap[i] = entry;
+}
+
+static struct HeapEntry HeapPop(struct HeapEntry * heap, int * size) {
+    struct HeapEntry top = heap[0];
+    struct HeapEntry last = heap[--(*size)];
+    int i = 0;
 
-        // Copy the merged data back
-        memcpy(data, buffer, count * size);
-        break;
+    for (;;) {
+        int child = i * 2 + 1;
+        if (child >= *size)
+            break;
+        if (child + 1 < *size && HeapLess(&heap[child + 1], &heap[child]))
+            child++;
+        if (!HeapLess(&heap[child], &last))
+            break;
+        heap[i] = heap[child];
+        i = child;
     }
 
-    return 1;
+    heap[i] = last;
+    return top;
 }
 
-int msort(void * data, size_t count, size_t size, cmpfun cmp) {
-    void * buffer = malloc(count * size);
-    if (buffer == NULL) return 0;
-    int result = msort_r(data, count, size, cmp, buffer);
-    free(buffer);
-    return result;
+// Computes Huffman code lengths for the symbols with nonzero frequency,
+// merging the two least frequent nodes with a binary heap.
+static void BuildCodeLengths(uint32_t * freqs, int nitems, int * lengths) {
+    struct HeapEntry heap[MAX_SYMBOLS];
+    uint32_t nodeFreqs[MAX_NODES];
+    int parents[MAX_NODES];
+    int heapSize = 0;
+    int numNodes = nitems;
+
+    for (int i = 0; i < nitems; i++) {
+        lengths[i] = 0;
+        nodeFreqs[i] = freqs[i];
+        if (freqs[i] != 0)
+            HeapPush(heap, &heapSize, (struct HeapEntry){ freqs[i], i });
+    }
+
+    if (heapSize < 2)
+        return;
+
+    while (heapSize > 1) {
+        struct HeapEntry a = HeapPop(heap, &heapSize);
+        struct HeapEntry b = HeapPop(heap, &heapSize);
+        int node = numNodes++;
+
+        nodeFreqs[node] = a.freq + b.freq;
+        parents[a.node] = node;
+        parents[b.node] = node;
+        HeapPush(heap, &heapSize, (struct HeapEntry){ nodeFreqs[node], node });
+    }
+
+    // Nodes are created after their children, so walking back from the
+    // root gives each node's depth from its parent's.
+    int depths[MAX_NODES];
+    int root = numNodes - 1;
+
+    depths[root] = 0;
+    for (int node = root - 1; node >= 0; node--) {
+        if (node >= nitems || freqs[node] != 0)
+            depths[node] = depths[parents[node]] + 1;
+    }
+
+    for (int i = 0; i < nitems; i++) {
+        if (freqs[i] != 0)
+            lengths[i] = depths[i];
+    }
 }
 
-static void write_tree(unsigned char * dest, HuffNode_t * tree, int nitems, struct BitEncoding * encoding) {
-    /*
-     * The example used to guide this function encodes the tree in a
-     * breadth-first manner.  We attempt to emulate that here.
-     */
-
-    int i, j, k;
-
-    // There are (2 * nitems - 1) nodes in the binary tree.  Allocate that.
-    HuffNode_t * traversal = calloc(2 * nitems - 1, sizeof(HuffNode_t));
-    if (traversal == NULL)
-        FATAL_ERROR("Fatal error while compressing Huff file.\n");
-
-    // The first node is the root of the tree.
-    traversal[0] = *tree;
-    i = 1;
-
-    // Copy the tree into a breadth-first ordering using brute force.
-    for (int depth = 1; i < 2 * nitems - 1; depth++) {
-        // Consider every possible path up to the current depth.
-        for (j = 0; i < 2 * nitems - 1 && j < 1 << depth; j++) {
-            // The index of the path is used to encode the path itself.
-            // Start from the most significant relevant bit and work our way down.
-            // Keep track of the current and previous nodes.
-            HuffNode_t * currNode = traversal;
-            HuffNode_t * parent = NULL;
-            for (k = 0; k < depth; k++) {
-                if (currNode->header.isLeaf)
-                    break;
-                parent = currNode;
-                if ((j >> (depth - k - 1)) & 1)
-                    currNode = currNode->branch.right;
-                else
-                    currNode = currNode->branch.left;
-            }
-            // Check that the length of the current path equals the current depth.
-            if (k == depth) {
-                // Make sure we can encode the current branch.
-                // Bail here if we cannot.
-                // This is only applicable for 8-bit encodings.
-                if (traversal + i - parent > 128)
-                    FATAL_ERROR("Fatal error while compressing Huff file: unable to encode binary tree.\n");
-                // Copy the current node, and update its parent.
-                traversal[i] = *currNode;
-                if (parent != NULL) {
-                    if ((j & 1) == 1)
-                        parent->branch.right = traversal + i;
-                    else
-                        parent->branch.left = traversal + i;
-                }
-                // Encode the path through the tree in the lookup table
-                if (traversal[i].header.isLeaf) {
-                    encoding[traversal[i].leaf.key].nbits = depth;
-                    encoding[traversal[i].leaf.key].bitstring = j;
-                }
-                i++;
+// Builds the canonical tree for the code lengths: at every depth the leaves
+// come first, in symbol order, followed by the internal nodes.
+static void BuildCanonicalTree(int * lengths, int nitems, struct HuffTree * tree) {
+    int level[MAX_SYMBOLS];
+    int levelSize = 1;
+    int maxLength = 0;
+
+    for (int i = 0; i < nitems; i++) {
+        if (lengths[i] > maxLength)
+            maxLength = lengths[i];
+    }
+
+    tree->numNodes = 1;
+    tree->isLeaf[0] = false;
+    level[0] = 0;
+
+    for (int depth = 1; depth <= maxLength; depth++) {
+        int nextLevel[MAX_SYMBOLS];
+        int nextLevelSize = 0;
+        int symbol = 0;
+
+        for (int i = 0; i < levelSize * 2; i++) {
+            int node = tree->numNodes++;
+
+            tree->children[level[i / 2]][i % 2] = node;
+
+            while (symbol < nitems && lengths[symbol] != depth)
+                symbol++;
+
+            if (symbol < nitems) {
+                tree->isLeaf[node] = true;
+                tree->symbol[node] = symbol++;
+            } else {
+                tree->isLeaf[node] = false;
+                nextLevel[nextLevelSize++] = node;
             }
         }
+
+        memcpy(level, nextLevel, nextLevelSize * sizeof(int));
+        levelSize = nextLevelSize;
     }
 
-    // Encode the size of the tree.
-    // This is used by the decompressor to skip the tree.
-    dest[4] = nitems - 1;
+    if (levelSize != 0)
+        FATAL_ERROR("Fatal error while compressing Huff file: invalid code lengths.\n");
 
-    // Encode each node in the tree.
-    for (i = 0; i < 2 * nitems - 1; i++) {
-        HuffNode_t * currNode = traversal + i;
-        if (currNode->header.isLeaf) {
-            dest[5 + i] = traversal[i].leaf.key;
-        } else {
-            dest[5 + i] = (((currNode->branch.right - traversal - i) / 2) - 1);
-            if (currNode->branch.left->header.isLeaf)
-                dest[5 + i] |= 0x80;
-            if (currNode->branch.right->header.isLeaf)
-                dest[5 + i] |= 0x40;
-        }
+    for (int node = tree->numNodes - 1; node >= 0; node--) {
+        if (tree->isLeaf[node])
+            tree->numLeaves[node] = 1;
+        else
+            tree->numLeaves[node] = tree->numLeaves[tree->children[node][0]] + tree->numLeaves[tree->children[node][1]];
     }
+}
 
-    free(traversal);
+static void AssignCodes(struct HuffTree * tree, int node, uint64_t bits, int length, struct HuffCode * codes) {
+    if (tree->isLeaf[node]) {
+        codes[tree->symbol[node]].bits = bits;
+        codes[tree->symbol[node]].length = length;
+    } else {
+        AssignCodes(tree, tree->children[node][0], bits << 1, length + 1, codes);
+        AssignCodes(tree, tree->children[node][1], (bits << 1) | 1, length + 1, codes);
+    }
 }
 
-static inline void write_32_le(unsigned char * dest, int * destPos, uint32_t * buff, int * buffPos) {
-    dest[*destPos] = *buff;
-    dest[*destPos + 1] = *buff >> 8;
-    dest[*destPos + 2] = *buff >> 16;
-    dest[*destPos + 3] = *buff >> 24;
-    *destPos += 4;
-    *buff = 0;
-    *buffPos = 0;
+/*
+=======================================
+TREE LAYOUT
+=======================================
+ */
+
+struct PendingNode {
+    int node;
+    int pair; // index of the pair holding the node, -1 for the root
+    int address;
+};
+
+// Whether every pending node (other than the one at index skip) can still
+// get its children within reach if the next pair is nextPair and
+// numNewNodes more internal nodes from pair nextPair - 1 join the queue.
+static bool CanPlaceAll(struct PendingNode * pending, int numPending, int skip, int nextPair, int numNewNodes) {
+    int k = 0;
+
+    for (int i = 0; i < numPending; i++) {
+        if (i == skip)
+            continue;
+        if (nextPair + k > pending[i].pair + MAX_OFFSET + 1)
+            return false;
+        k++;
+    }
+
+    return numNewNodes == 0 || nextPair + k + numNewNodes - 1 <= nextPair - 1 + MAX_OFFSET + 1;
 }
 
-static inline void read_32_le(unsigned char * src, int * srcPos, uint32_t * buff) {
-    uint32_t tmp = src[*srcPos];
-    tmp |= src[*srcPos + 1] << 8;
-    tmp |= src[*srcPos + 2] << 16;
-    tmp |= src[*srcPos + 3] << 24;
-    *srcPos += 4;
-    *buff = tmp;
+// Lays out the tree in the table, choosing at each step which pending node
+// gets the next pair of slots for its children. The offset field only
+// reaches 63 pairs ahead, which a plain breadth-first layout exceeds on large
+// 8-bit trees. So the nodes with the smallest subtrees go first, which keeps
+// the queue short, unless some other node would then fall out of reach.
+static bool LayOutTree(struct HuffTree * tree, unsigned char * table, bool smallestFirst) {
+    struct PendingNode pending[MAX_SYMBOLS];
+    int numPending = 1;
+
+    pending[0] = (struct PendingNode){ 0, -1, TREE_START };
+
+    for (int pair = 0; numPending != 0; pair++) {
+        int best = -1;
+
+        for (int i = 0; i < numPending; i++) {
+            struct PendingNode * p = &pending[i];
+            int numNewNodes = !tree->isLeaf[tree->children[p->node][0]] + !tree->isLeaf[tree->children[p->node][1]];
+
+            if (pair > p->pair + MAX_OFFSET + 1 || !CanPlaceAll(pending, numPending, i, pair + 1, numNewNodes))
+                continue;
+
+            if (best == -1) {
+                best = i;
+                if (!smallestFirst)
+                    break;
+            } else if (tree->numLeaves[p->node] < tree->numLeaves[pending[best].node]) {
+                best = i;
+            }
+        }
+
+        if (best == -1)
+            return false;
+
+        struct PendingNode parent = pending[best];
+
+        memmove(&pending[best], &pending[best + 1], (numPending - best - 1) * sizeof(struct PendingNode));
+        numPending--;
+
+        int childAddress = TREE_START + 1 + pair * 2;
+
+        table[parent.address] = pair - parent.pair - 1;
+
+        for (int i = 0; i < 2; i++) {
+            int child = tree->children[parent.node][i];
+
+            if (tree->isLeaf[child]) {
+                table[parent.address] |= 0x80 >> i;
+                table[childAddress + i] = tree->symbol[child];
+            } else {
+                pending[numPending++] = (struct PendingNode){ child, pair, childAddress + i };
+            }
+        }
+    }
+
+    return true;
 }
 
-static void write_bits(unsigned char * dest, int * destPos, struct BitEncoding * encoding, int value, uint32_t * buff, int * buffBits) {
-    int nbits = encoding[value].nbits;
-    uint32_t bitstring = encoding[value].bitstring;
-
-    if (*buffBits + nbits >= 32) {
-        int diff = *buffBits + nbits - 32;
-        *buff <<= nbits - diff;
-        *buff |= bitstring >> diff;
-        bitstring &= ~(1 << diff);
-        nbits = diff;
-        write_32_le(dest, destPos, buff, buffBits);
+/*
+=======================================
+BIT I/O
+=======================================
+ */
+
+struct BitWriter {
+    unsigned char * dest;
+    int destPos;
+    uint64_t buffer;
+    int count;
+};
+
+static inline void PutBits(struct BitWriter * writer, uint64_t bits, int length) {
+    if (length > 32) {
+        PutBits(writer, bits >> 32, length - 32);
+        bits &= 0xFFFFFFFF;
+        length = 32;
     }
-    if (nbits != 0) {
-        *buff <<= nbits;
-        *buff |= bitstring;
-        *buffBits += nbits;
+
+    writer->buffer = (writer->buffer << length) | bits;
+    writer->count += length;
+
+    if (writer->count >= 32) {
+        writer->count -= 32;
+        uint32_t word = writer->buffer >> writer->count;
+        writer->dest[writer->destPos++] = word;
+        writer->dest[writer->destPos++] = word >> 8;
+        writer->dest[writer->destPos++] = word >> 16;
+        writer->dest[writer->destPos++] = word >> 24;
+        writer->buffer &= (1ULL << writer->count) - 1;
     }
 }
 
+static void FlushBits(struct BitWriter * writer) {
+    if (writer->count != 0)
+        PutBits(writer, 0, 32 - writer->count);
+}
+
 /*
 =======================================
 MAIN COMPRESSION/DECOMPRESSION ROUTINES
@@ -219,131 +332,181 @@ MAIN COMPRESSION/DECOMPRESSION ROUTINES
  */
 
 unsigned char * HuffCompress(unsigned char * src, int srcSize, int * compressedSize_p, int bitDepth) {
-    if (srcSize <= 0)
-        goto fail;
-
-    int worstCaseDestSize = 4 + (2 << bitDepth) + srcSize * 3;
-
-    unsigned char *dest = malloc(worstCaseDestSize);
-    if (dest == NULL)
+    if (srcSize <= 0 || (bitDepth != 4 && bitDepth != 8))
         goto fail;
 
+    // The data is encoded a word at a time, so pad it with zeros.
+    int paddedSize = (srcSize + 3) & ~3;
     int nitems = 1 << bitDepth;
+    uint32_t freqs[MAX_SYMBOLS] = {0};
 
-    HuffNode_t * freqs = calloc(nitems, sizeof(HuffNode_t));
-    if (freqs == NULL)
-        goto fail;
-
-    struct BitEncoding * encoding = calloc(nitems, sizeof(struct BitEncoding));
-    if (encoding == NULL)
-        goto fail;
-
-    // Set up the frequencies table.  This will inform the tree.
-    for (int i = 0; i < nitems; i++) {
-        freqs[i].header.isLeaf = 1;
-        freqs[i].header.value = 0;
-        freqs[i].leaf.key = i;
-    }
-
-    // Count each nybble or byte.
     for (int i = 0; i < srcSize; i++) {
         if (bitDepth == 8) {
-            freqs[src[i]].header.value++;
+            freqs[src[i]]++;
         } else {
-            freqs[src[i] >> 4].header.value++;
-            freqs[src[i] & 0xF].header.value++;
+            freqs[src[i] & 0xF]++;
+            freqs[src[i] >> 4]++;
         }
     }
 
+    freqs[0] += (paddedSize - srcSize) * (8 / bitDepth);
+
 #ifdef DEBUG
     for (int i = 0; i < nitems; i++) {
-        fprintf(stderr, "%d: %d\n", i, freqs[i].header.value);
+        fprintf(stderr, "%d: %u\n", i, freqs[i]);
     }
 #endif // DEBUG
 
-    // Sort the frequency table.
-    if (!msort(freqs, nitems, sizeof(HuffNode_t), cmp_tree))
-        goto fail;
+    int lengths[MAX_SYMBOLS];
+    int numUsed = 0;
 
-    // Prune zero-frequency values.
     for (int i = 0; i < nitems; i++) {
-        if (freqs[i].header.value != 0) {
-            if (i > 0) {
-                for (int j = i; j < nitems; j++) {
-                    freqs[j - i] = freqs[j];
-                }
-                nitems -= i;
+        if (freqs[i] != 0)
+            numUsed++;
+    }
+
+    BuildCodeLengths(freqs, nitems, lengths);
+
+    // The root is always an internal node, so a lone symbol still needs a
+    // one-bit code, paired with an unused one.
+    if (numUsed == 1) {
+        for (int i = 0; i < nitems; i++) {
+            if (freqs[i] != 0) {
+                lengths[i] = 1;
+                lengths[i ^ 1] = 1;
+                break;
             }
-            break;
         }
-        // This should never happen:
-        if (i == nitems - 1)
-            goto fail;
+        numUsed = 2;
     }
 
-    HuffNode_t * tree = calloc(nitems * 2 - 1, sizeof(HuffNode_t));
-    if (tree == NULL)
+    struct HuffTree tree;
+    struct HuffCode codes[MAX_SYMBOLS] = {{0}};
+
+    BuildCanonicalTree(lengths, nitems, &tree);
+    AssignCodes(&tree, 0, 0, 0, codes);
+
+    // The tree has 2 * numUsed - 1 nodes plus the size byte. Round it up so
+    // that the bitstream is word-aligned.
+    int treeSize = (numUsed * 2 + 3) & ~3;
+    int worstCaseDestSize = 4 + treeSize + paddedSize + 4;
+
+    unsigned char * dest = calloc(worstCaseDestSize, 1);
+    if (dest == NULL)
         goto fail;
 
-    // Iteratively collapse the two least frequent nodes.
-    HuffNode_t * endptr = freqs + nitems - 2;
-
-    for (int i = 0; i < nitems - 1; i++) {
-        HuffNode_t * left = freqs;
-        HuffNode_t * right = freqs + 1;
-        tree[i * 2] = *right;
-        tree[i * 2 + 1] = *left;
-        for (int j = 0; j < nitems - i - 2; j++)
-            freqs[j] = freqs[j + 2];
-        endptr->header.isLeaf = 0;
-        endptr->header.value = tree[i * 2].header.value + tree[i * 2 + 1].header.value;
-        endptr->branch.left = tree + i * 2;
-        endptr->branch.right = tree + i * 2 + 1;
-        endptr--;
-        if (i < nitems - 2 && !msort(freqs, nitems - i - 1, sizeof(HuffNode_t), cmp_tree))
-            goto fail;
-    }
+    if (!LayOutTree(&tree, dest, true) && !LayOutTree(&tree, dest, false))
+        FATAL_ERROR("Fatal error while compressing Huff file: unable to encode binary tree.\n");
 
-    // Write the tree breadth-first, and create the path lookup table.
-    write_tree(dest, freqs, nitems, encoding);
+    dest[0] = bitDepth | 0x20;
+    dest[1] = srcSize;
+    dest[2] = srcSize >> 8;
+    dest[3] = srcSize >> 16;
+    dest[4] = treeSize / 2 - 1;
 
-    free(tree);
-    free(freqs);
+    struct BitWriter writer = { dest, 4 + treeSize, 0, 0 };
 
-    // Encode the data itself.
-    int destPos = 4 + nitems * 2;
-    uint32_t destBuf = 0;
-    uint32_t srcBuf = 0;
-    int destBitPos = 0;
+    if (bitDepth == 8) {
+        for (int i = 0; i < srcSize; i++)
+            PutBits(&writer, codes[src[i]].bits, codes[src[i]].length);
+    } else {
+        // Both nibbles of a byte at once, low nibble first.
+        struct HuffCode byteCodes[256];
+        int maxLength = 0;
 
-    for (int srcPos = 0; srcPos < srcSize;) {
-        read_32_le(src, &srcPos, &srcBuf);
-        for (int i = 0; i < 32 / bitDepth; i++) {
-            write_bits(dest, &destPos, encoding, srcBuf & (0xFF >> (8 - bitDepth)), &destBuf, &destBitPos);
-            srcBuf >>= bitDepth;
+        for (int i = 0; i < 16; i++) {
+            if (codes[i].length > maxLength)
+                maxLength = codes[i].length;
+        }
+
+        if (maxLength <= 32) {
+            for (int i = 0; i < 256; i++) {
+                struct HuffCode * lo = &codes[i & 0xF];
+                struct HuffCode * hi = &codes[i >> 4];
+                byteCodes[i].bits = (lo->bits << hi->length) | hi->bits;
+                byteCodes[i].length = lo->length + hi->length;
+            }
+
+            for (int i = 0; i < srcSize; i++)
+                PutBits(&writer, byteCodes[src[i]].bits, byteCodes[src[i]].length);
+        } else {
+            for (int i = 0; i < srcSize; i++) {
+                PutBits(&writer, codes[src[i] & 0xF].bits, codes[src[i] & 0xF].length);
+                PutBits(&writer, codes[src[i] >> 4].bits, codes[src[i] >> 4].length);
+            }
         }
     }
 
-    if (destBitPos != 0) {
-        write_32_le(dest, &destPos, &destBuf, &destBitPos);
+    for (int i = srcSize; i < paddedSize; i++) {
+        for (int j = 0; j < 8 / bitDepth; j++)
+            PutBits(&writer, codes[0].bits, codes[0].length);
     }
 
-    free(encoding);
+    FlushBits(&writer);
 
-    // Write the header.
-    dest[0] = bitDepth | 0x20;
-    dest[1] = srcSize;
-    dest[2] = srcSize >> 8;
-    dest[3] = srcSize >> 16;
-    *compressedSize_p = (destPos + 3) & ~3;
+    *compressedSize_p = writer.destPos;
     return dest;
 
 fail:
     FATAL_ERROR("Fatal error while compressing Huff file.\n");
 }
 
+struct DecodeEntry {
+    uint16_t value;  // symbol, or address of the node to continue from
+    uint8_t length;  // bits consumed
+    uint8_t isLeaf;
+};
+
+struct TreeReader {
+    unsigned char * src;
+    int treeEnd;
+    struct DecodeEntry table[1 << TABLE_BITS];
+};
+
+// Follows one bit from the internal node at address. Returns the child's
+// address and sets *isLeaf, or returns -1 if the tree is malformed.
+static inline int FollowBit(struct TreeReader * reader, int address, int bit, bool * isLeaf) {
+    unsigned char node = reader->src[address];
+    int child = (address & ~1) + (node & MAX_OFFSET) * 2 + 2 + bit;
+
+    if (child >= reader->treeEnd)
+        return -1;
+
+    *isLeaf = ((node << bit) & 0x80) != 0;
+    return child;
+}
+
+// Fills the entries of the lookup table for the codes below the internal
+// node at address, whose path from the root is bits.
+static bool FillTable(struct TreeReader * reader, int address, unsigned bits, int length) {
+    for (int bit = 0; bit < 2; bit++) {
+        bool isLeaf;
+        int child = FollowBit(reader, address, bit, &isLeaf);
+        unsigned childBits = (bits << 1) | bit;
+
+        if (child < 0)
+            return false;
+
+        if (isLeaf || length + 1 == TABLE_BITS) {
+            int shift = TABLE_BITS - (length + 1);
+            struct DecodeEntry entry;
+
+            entry.value = isLeaf ? reader->src[child] : child;
+            entry.length = length + 1;
+            entry.isLeaf = isLeaf;
+
+            for (unsigned i = 0; i < (1u << shift); i++)
+                reader->table[(childBits << shift) | i] = entry;
+        } else if (!FillTable(reader, child, childBits, length + 1)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 unsigned char * HuffDecompress(unsigned char * src, int srcSize, int * uncompressedSize_p) {
-    if (srcSize < 4)
+    if (srcSize < 5)
         goto fail;
 
     int bitDepth = *src & 15;
@@ -351,48 +514,79 @@ unsigned char * HuffDecompress(unsigned char * src, int srcSize, int * uncompres
         goto fail;
 
     int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
+    int treeSize = (src[4] + 1) * 2;
+    int srcPos = 4 + treeSize;
 
-    unsigned char *dest = malloc(destSize);
+    if (srcPos > srcSize)
+        goto fail;
 
+    struct TreeReader reader;
+
+    reader.src = src;
+    reader.treeEnd = srcPos;
+
+    if (!FillTable(&reader, TREE_START, 0, 0))
+        goto fail;
+
+    unsigned char * dest = calloc(destSize > 0 ? destSize : 1, 1);
     if (dest == NULL)
         goto fail;
 
-    int treePos = 5;
-    int treeSize = (src[4] + 1) * 2;
-    int srcPos = 4 + treeSize;
-    int destPos = 0;
-    int curValPos = 0;
-    uint32_t destTmp = 0;
-    uint32_t window;
-
-    for (;;)
-    {
-        if (srcPos >= srcSize)
+    int numSymbols = destSize * 8 / bitDepth;
+    uint64_t window = 0; // unread bits, starting from the top
+    int windowBits = 0;
+
+    for (int i = 0; i < numSymbols; i++) {
+        if (windowBits < 32 && srcPos + 4 <= srcSize) {
+            uint32_t word = src[srcPos] | (src[srcPos + 1] << 8) | (src[srcPos + 2] << 16) | ((uint32_t)src[srcPos + 3] << 24);
+            window |= (uint64_t)word << (32 - windowBits);
+            windowBits += 32;
+            srcPos += 4;
+        }
+
+        struct DecodeEntry entry = reader.table[window >> (64 - TABLE_BITS)];
+
+        if (entry.length > windowBits)
             goto fail;
-        read_32_le(src, &srcPos, &window);
-        for (int i = 0; i < 32; i++) {
-            int curBit = (window >> 31) & 1;
-            unsigned char treeView = src[treePos];
-            bool isLeaf = ((treeView << curBit) & 0x80) != 0;
-            treePos &= ~1; // align
-            treePos += ((treeView & 0x3F) + 1) * 2 + curBit;
-            if (isLeaf) {
-                destTmp >>= bitDepth;
-                destTmp |= (src[treePos] << (32 - bitDepth));
-                curValPos++;
-                if (curValPos == 32 / bitDepth) {
-                    write_32_le(dest, &destPos, &destTmp, &curValPos);
-                    if (destPos == destSize) {
-                        *uncompressedSize_p = destSize;
-                        return dest;
-                    }
+
+        window <<= entry.length;
+        windowBits -= entry.length;
+
+        unsigned symbol = entry.value;
+
+        // Codes longer than the table are finished a bit at a time.
+        if (!entry.isLeaf) {
+            int address = entry.value;
+            bool isLeaf = false;
+
+            while (!isLeaf) {
+                if (windowBits == 0) {
+                    if (srcPos + 4 > srcSize)
+                        goto fail;
+                    window = (uint64_t)(src[srcPos] | (src[srcPos + 1] << 8) | (src[srcPos + 2] << 16) | ((uint32_t)src[srcPos + 3] << 24)) << 32;
+                    windowBits = 32;
+                    srcPos += 4;
                 }
-                treePos = 5;
+
+                address = FollowBit(&reader, address, window >> 63, &isLeaf);
+                if (address < 0)
+                    goto fail;
+                window <<= 1;
+                windowBits--;
             }
-            window <<= 1;
+
+            symbol = src[address];
         }
+
+        if (bitDepth == 8)
+            dest[i] = symbol;
+        else
+            dest[i / 2] |= (symbol & 0xF) << ((i & 1) * 4);
     }
 
+    *uncompressedSize_p = destSize;
+    return dest;
+
 fail:
     FATAL_ERROR("Fatal error while decompressing Huff file.\n");
 }
@@ -0,0 +1,226 @@
+// Round-trip fuzzer and benchmark for the Huffman codec.
+//
+//     huff-bench [-iterations N] [FILE...]
+//
+// Compresses random buffers with a range of sizes and symbol distributions
+// at both bit depths and checks that they decompress to the original data,
+// both with HuffDecompress and with a decoder that walks the tree a bit at a
+// time like the BIOS does. Any files given are then used for a benchmark.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "global.h"
+#include "util.h"
+#include "huff.h"
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Decodes like HuffUnComp: whole words of output, one bit of input at a
+// time, with the tree read straight from the data. Returns false if it would
+// read outside the compressed data.
+static bool BiosDecompress(unsigned char *src, int srcSize, unsigned char *dest, int destSize)
+{
+    int bitDepth = src[0] & 0xF;
+    int treeEnd = 4 + (src[4] + 1) * 2;
+    int srcPos = treeEnd;
+    int address = 5;
+    uint32_t word = 0;
+    int numSymbols = 0;
+
+    if (srcPos % 4 != 0)
+        return false;
+
+    for (int destPos = 0; destPos < destSize;) {
+        if (srcPos + 4 > srcSize)
+            return false;
+
+        uint32_t window = src[srcPos] | (src[srcPos + 1] << 8) | (src[srcPos + 2] << 16) | ((uint32_t)src[srcPos + 3] << 24);
+        srcPos += 4;
+
+        for (int i = 0; i < 32 && destPos < destSize; i++) {
+            int bit = window >> 31;
+            unsigned char node = src[address];
+            int child = (address & ~1) + (node & 0x3F) * 2 + 2 + bit;
+
+            if (child >= treeEnd)
+                return false;
+
+            window <<= 1;
+
+            if ((node << bit) & 0x80) {
+                word = (word >> bitDepth) | ((uint32_t)src[child] << (32 - bitDepth));
+                address = 5;
+
+                if (++numSymbols == 32 / bitDepth) {
+                    for (int j = 0; j < 4; j++) {
+                        if (destPos < destSize)
+                            dest[destPos] = word >> (j * 8);
+                        destPos++;
+                    }
+                    numSymbols = 0;
+                }
+            } else {
+                address = child;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void FillRandom(unsigned char *buffer, int size, int kind, int bitDepth)
+{
+    int numSymbols = 1 << bitDepth;
+
+    for (int i = 0; i < size; i++) {
+        unsigned value;
+
+        switch (kind) {
+        case 0: // uniform
+            value = rand() % 256;
+            break;
+        case 1: // a single value
+            value = 0x5A;
+            break;
+        case 2: // geometric-ish, giving long codes
+            value = 0;
+            while (value < 255 && rand() % 3 != 0)
+                value++;
+            break;
+        default: // a few symbols
+            value = rand() % (kind + 1);
+            break;
+        }
+
+        if (bitDepth == 4)
+            value = (value % numSymbols) | ((rand() % 2 ? value : value * 7) % numSymbols) << 4;
+
+        buffer[i] = value;
+    }
+}
+
+static bool CheckRoundTrip(unsigned char *buffer, int size, int bitDepth)
+{
+    int compressedSize;
+    unsigned char *compressed = HuffCompress(buffer, size, &compressedSize, bitDepth);
+    int uncompressedSize;
+    unsigned char *uncompressed = HuffDecompress(compressed, compressedSize, &uncompressedSize);
+    unsigned char *biosOutput = malloc(size);
+    bool ok = true;
+
+    if (uncompressedSize != size || memcmp(uncompressed, buffer, size) != 0) {
+        fprintf(stderr, "HuffDecompress mismatch (size %d, depth %d)\n", size, bitDepth);
+        ok = false;
+    }
+
+    if (compressedSize % 4 != 0 || !BiosDecompress(compressed, compressedSize, biosOutput, size)
+        || memcmp(biosOutput, buffer, size) != 0) {
+        fprintf(stderr, "BIOS-style decode mismatch (size %d, depth %d)\n", size, bitDepth);
+        ok = false;
+    }
+
+    free(biosOutput);
+    free(uncompressed);
+    free(compressed);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = 2000;
+    int firstFile = 1;
+
+    if (argc >= 3 && strcmp(argv[1], "-iterations") == 0) {
+        if (!ParseNumber(argv[2], NULL, 10, &iterations))
+            FATAL_ERROR("Failed to parse iteration count.\n");
+        firstFile = 3;
+    }
+
+    unsigned char *buffer = malloc(1 << 16);
+    int numFailed = 0;
+
+    if (buffer == NULL)
+        FATAL_ERROR("Failed to allocate memory.\n");
+
+    srand(1);
+
+    for (int i = 0; i < iterations; i++) {
+        int bitDepth = (i % 2) ? 8 : 4;
+        int kind = (i / 2) % 8;
+        int size = 1 + rand() % ((i % 16 == 0) ? 65536 : 4096);
+
+        FillRandom(buffer, size, kind, bitDepth);
+
+        if (!CheckRoundTrip(buffer, size, bitDepth))
+            numFailed++;
+    }
+
+    printf("%d random buffers, %d failed\n", iterations, numFailed);
+
+    if (firstFile < argc) {
+        long long totalSize = 0;
+        long long compressedTotal[2] = { 0, 0 };
+        double compressTime = 0;
+        double decompressTime = 0;
+
+        for (int i = firstFile; i < argc; i++) {
+            int fileSize;
+            unsigned char *data = ReadWholeFile(argv[i], &fileSize);
+
+            if (fileSize == 0) {
+                free(data);
+                continue;
+            }
+
+            for (int d = 0; d < 2; d++) {
+                int bitDepth = d ? 8 : 4;
+                int compressedSize;
+                int uncompressedSize;
+
+                double start = Now();
+                unsigned char *compressed = HuffCompress(data, fileSize, &compressedSize, bitDepth);
+                double middle = Now();
+                unsigned char *uncompressed = HuffDecompress(compressed, compressedSize, &uncompressedSize);
+                double end = Now();
+
+                if (memcmp(uncompressed, data, fileSize) != 0) {
+                    fprintf(stderr, "%s: round trip failed at depth %d\n", argv[i], bitDepth);
+                    numFailed++;
+                }
+
+                compressTime += middle - start;
+                decompressTime += end - middle;
+                compressedTotal[d] += compressedSize;
+
+                free(compressed);
+                free(uncompressed);
+            }
+
+            totalSize += fileSize;
+            free(data);
+        }
+
+        double megabytes = 2.0 * totalSize / (1024 * 1024);
+
+        printf("%d files, %lld bytes -> %lld (4-bit) / %lld (8-bit)\n", argc - firstFile, totalSize, compressedTotal[0], compressedTotal[1]);
+        printf("compress:   %8.2f MiB/s\n", megabytes / compressTime);
+        printf("decompress: %8.2f MiB/s\n", megabytes / decompressTime);
+    }
+
+    if (numFailed != 0)
+        FATAL_ERROR("%d check(s) failed.\n", numFailed);
+
+    return 0;
+}
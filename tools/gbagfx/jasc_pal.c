@@ -156,17 +156,19 @@ void ReadJascPalette(char *path, struct Palette *palette)
 
 void WriteJascPalette(char *path, struct Palette *palette)
 {
-    FILE *fp = fopen(path, "wb");
+    // The header, then at most "255 255 255\r\n" per color.
+    char buffer[32 + 256 * 13];
+    int length = 0;
 
-    fputs("JASC-PAL\r\n", fp);
-    fputs("0100\r\n", fp);
-    fprintf(fp, "%d\r\n", palette->numColors);
+    length += sprintf(buffer + length, "JASC-PAL\r\n");
+    length += sprintf(buffer + length, "0100\r\n");
+    length += sprintf(buffer + length, "%d\r\n", palette->numColors);
 
     for (int i = 0; i < palette->numColors; i++)
     {
         struct Color *color = &palette->colors[i];
-        fprintf(fp, "%d %d %d\r\n", color->red, color->green, color->blue);
+        length += sprintf(buffer + length, "%d %d %d\r\n", color->red, color->green, color->blue);
     }
 
-    fclose(fp);
+    WriteWholeFile(path, buffer, length);
 }
@@ -1,35 +1,73 @@
 // Copyright (c) 2015 YamaArashi
 
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include "global.h"
 #include "lz.h"
 
-unsigned char *LZDecompress(unsigned char *src, int srcSize, int *uncompressedSize)
-{
-	if (srcSize < 4)
-		goto fail;
-
-	int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
+// Back-references at least this far back are copied a word at a time. The
+// copy can write up to LZ_COPY_SLACK - 1 bytes past the end of the block, so
+// the destination buffer needs that much room past its end.
+#define LZ_COPY_SLACK 8
 
-	unsigned char *dest = malloc(destSize);
+// The most output a flag group can produce: 8 back-references of 18 bytes.
+#define LZ_MAX_GROUP_SIZE (8 * 18)
 
-	if (dest == NULL)
-		goto fail;
+static void CopyBlock(unsigned char *dest, int destPos, int blockPos, int blockSize)
+{
+	if (destPos - blockPos >= LZ_COPY_SLACK) {
+		// Each word is read from output that was finished before it's written.
+		for (int j = 0; j < blockSize; j += LZ_COPY_SLACK)
+			memcpy(&dest[destPos + j], &dest[blockPos + j], LZ_COPY_SLACK);
+	} else {
+		for (int j = 0; j < blockSize; j++)
+			dest[destPos + j] = dest[blockPos + j];
+	}
+}
 
+// Decodes src into dest, which holds destSize bytes plus LZ_COPY_SLACK.
+// Returns false if the data is corrupt.
+static bool LZDecode(unsigned char *src, int srcSize, unsigned char *dest, int destSize, bool warnOverflow)
+{
 	int srcPos = 4;
 	int destPos = 0;
 
 	for (;;) {
 		if (srcPos >= srcSize)
-			goto fail;
+			return false;
 
 		unsigned char flags = src[srcPos++];
 
+		// If the whole group fits in both buffers, and can't reach the end
+		// of the output, only the back-reference distances need checking.
+		if (srcPos + 16 <= srcSize && destPos + LZ_MAX_GROUP_SIZE < destSize) {
+			for (int i = 0; i < 8; i++) {
+				if (flags & 0x80) {
+					int blockSize = (src[srcPos] >> 4) + 3;
+					int blockPos = destPos - ((((src[srcPos] & 0xF) << 8) | src[srcPos + 1]) + 1);
+
+					srcPos += 2;
+
+					if (blockPos < 0)
+						return false;
+
+					CopyBlock(dest, destPos, blockPos, blockSize);
+					destPos += blockSize;
+				} else {
+					dest[destPos++] = src[srcPos++];
+				}
+
+				flags <<= 1;
+			}
+
+			continue;
+		}
+
 		for (int i = 0; i < 8; i++) {
 			if (flags & 0x80) {
 				if (srcPos + 1 >= srcSize)
-					goto fail;
+					return false;
 
 				int blockSize = (src[srcPos] >> 4) + 3;
 				int blockDistance = (((src[srcPos] & 0xF) << 8) | src[srcPos + 1]) + 1;
@@ -41,35 +79,230 @@ unsigned char *LZDecompress(unsigned char *src, int srcSize, int *uncompressedSi
 				// Some Ruby/Sapphire tilesets overflow.
 				if (destPos + blockSize > destSize) {
 					blockSize = destSize - destPos;
-					fprintf(stderr, "Destination buffer overflow.\n");
+					if (warnOverflow)
+						fprintf(stderr, "Destination buffer overflow.\n");
 				}
 
 				if (blockPos < 0)
-					goto fail;
+					return false;
 
-				for (int j = 0; j < blockSize; j++)
-					dest[destPos++] = dest[blockPos + j];
+				CopyBlock(dest, destPos, blockPos, blockSize);
+				destPos += blockSize;
 			} else {
 				if (srcPos >= srcSize || destPos >= destSize)
-					goto fail;
+					return false;
 
 				dest[destPos++] = src[srcPos++];
 			}
 
-			if (destPos == destSize) {
-				*uncompressedSize = destSize;
-				return dest;
-			}
+			if (destPos == destSize)
+				return true;
 
 			flags <<= 1;
 		}
 	}
+}
+
+unsigned char *LZDecompress(unsigned char *src, int srcSize, int *uncompressedSize)
+{
+	if (srcSize < 4)
+		goto fail;
+
+	int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
+
+	unsigned char *dest = malloc(destSize + LZ_COPY_SLACK);
+
+	if (dest == NULL)
+		goto fail;
+
+	if (!LZDecode(src, srcSize, dest, destSize, true))
+		goto fail;
+
+	*uncompressedSize = destSize;
+	return dest;
 
 fail:
 	FATAL_ERROR("Fatal error while decompressing LZ file.\n");
 }
 
+bool LZVerify(unsigned char *src, int srcSize, unsigned char *expected, int expectedSize)
+{
+	if (srcSize < 4)
+		return false;
+
+	int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
+
+	if (destSize != expectedSize)
+		return false;
+
+	unsigned char *dest = malloc(destSize + LZ_COPY_SLACK);
+
+	if (dest == NULL)
+		FATAL_ERROR("Failed to allocate memory for LZ verification.\n");
+
+	bool matches = LZDecode(src, srcSize, dest, destSize, false) && memcmp(dest, expected, destSize) == 0;
+
+	free(dest);
+	return matches;
+}
+
+// Greedy LZ77 compression always takes the longest match at the current
+// position, and among equally long matches the one with the smallest
+// distance. Both match finders below make exactly the same choices, so their
+// output is identical.
+
+#define LZ_MAX_DISTANCE 0x1000
+#define LZ_MIN_MATCH 3
+#define LZ_MAX_MATCH 18
+
+#define HASH_BITS 15
+
+static int MatchLength(unsigned char *src, int blockStart, int srcPos, int maxSize)
+{
+	int blockSize = 0;
+
+	while (blockSize < maxSize && src[blockStart + blockSize] == src[srcPos + blockSize])
+		blockSize++;
+
+	return blockSize;
+}
+
+// The original search: try every distance from minDistance outward.
+static int FindMatchBruteForce(unsigned char *src, int srcSize, int srcPos, int minDistance, int *bestBlockDistance)
+{
+	int bestBlockSize = 0;
+	int maxSize = srcSize - srcPos;
+
+	if (maxSize > LZ_MAX_MATCH)
+		maxSize = LZ_MAX_MATCH;
+
+	for (int blockDistance = minDistance; blockDistance <= srcPos && blockDistance <= LZ_MAX_DISTANCE; blockDistance++) {
+		int blockSize = MatchLength(src, srcPos - blockDistance, srcPos, maxSize);
+
+		if (blockSize > bestBlockSize) {
+			*bestBlockDistance = blockDistance;
+			bestBlockSize = blockSize;
+
+			if (blockSize == maxSize)
+				break;
+		}
+	}
+
+	return bestBlockSize;
+}
+
+// Hash chains over the three bytes starting at each position. Any match that
+// is long enough to be used starts with the same three bytes, so only the
+// positions on the current position's chain need to be tried. Chains are
+// ordered from the most recent position, i.e. by increasing distance, which
+// gives the same tie-breaking as the brute force search.
+struct HashChains
+{
+	int head[1 << HASH_BITS];
+	int *prev;
+	int numInserted;
+};
+
+static struct HashChains *NewHashChains(int srcSize)
+{
+	struct HashChains *chains = malloc(sizeof(struct HashChains));
+
+	if (chains == NULL)
+		return NULL;
+
+	chains->prev = malloc(srcSize * sizeof(int));
+
+	if (chains->prev == NULL) {
+		free(chains);
+		return NULL;
+	}
+
+	for (int i = 0; i < (1 << HASH_BITS); i++)
+		chains->head[i] = -1;
+
+	chains->numInserted = 0;
+
+	return chains;
+}
+
+static void FreeHashChains(struct HashChains *chains)
+{
+	if (chains != NULL) {
+		free(chains->prev);
+		free(chains);
+	}
+}
+
+static unsigned int Hash3(unsigned char *p)
+{
+	unsigned int value = (p[0] << 16) | (p[1] << 8) | p[2];
+
+	return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void InsertPositions(struct HashChains *chains, unsigned char *src, int srcSize, int endPos)
+{
+	if (endPos > srcSize - (LZ_MIN_MATCH - 1))
+		endPos = srcSize - (LZ_MIN_MATCH - 1);
+
+	for (int pos = chains->numInserted; pos < endPos; pos++) {
+		unsigned int hash = Hash3(&src[pos]);
+
+		chains->prev[pos] = chains->head[hash];
+		chains->head[hash] = pos;
+	}
+
+	if (endPos > chains->numInserted)
+		chains->numInserted = endPos;
+}
+
+static int FindMatchHashChain(struct HashChains *chains, unsigned char *src, int srcSize, int srcPos, int minDistance, int *bestBlockDistance)
+{
+	int maxSize = srcSize - srcPos;
+
+	if (maxSize < LZ_MIN_MATCH)
+		return 0;
+
+	if (maxSize > LZ_MAX_MATCH)
+		maxSize = LZ_MAX_MATCH;
+
+	InsertPositions(chains, src, srcSize, srcPos);
+
+	int bestBlockSize = 0;
+	int candidate = chains->head[Hash3(&src[srcPos])];
+
+	while (candidate >= 0) {
+		int blockDistance = srcPos - candidate;
+
+		if (blockDistance > LZ_MAX_DISTANCE)
+			break;
+
+		// A candidate can only win if it also matches at the byte where the
+		// current best match ends.
+		if (blockDistance >= minDistance && src[candidate + bestBlockSize] == src[srcPos + bestBlockSize]) {
+			int blockSize = MatchLength(src, candidate, srcPos, maxSize);
+
+			if (blockSize > bestBlockSize) {
+				*bestBlockDistance = blockDistance;
+				bestBlockSize = blockSize;
+
+				if (blockSize == maxSize)
+					break;
+			}
+		}
+
+		candidate = chains->prev[candidate];
+	}
+
+	return bestBlockSize;
+}
+
 unsigned char *LZCompress(unsigned char *src, int srcSize, int *compressedSize, const int minDistance)
+{
+	return LZCompressWithMatcher(src, srcSize, compressedSize, minDistance, LZ_MATCHER_HASH_CHAIN);
+}
+
+unsigned char *LZCompressWithMatcher(unsigned char *src, int srcSize, int *compressedSize, const int minDistance, enum LZMatcher matcher)
 {
 	if (srcSize <= 0)
 		goto fail;
@@ -84,6 +317,15 @@ unsigned char *LZCompress(unsigned char *src, int srcSize, int *compressedSize,
 	if (dest == NULL)
 		goto fail;
 
+	struct HashChains *chains = NULL;
+
+	if (matcher == LZ_MATCHER_HASH_CHAIN) {
+		chains = NewHashChains(srcSize);
+
+		if (chains == NULL)
+			goto fail;
+	}
+
 	// header
 	dest[0] = 0x10; // LZ compression type
 	dest[1] = (unsigned char)srcSize;
@@ -99,36 +341,118 @@ unsigned char *LZCompress(unsigned char *src, int srcSize, int *compressedSize,
 
 		for (int i = 0; i < 8; i++) {
 			int bestBlockDistance = 0;
-			int bestBlockSize = 0;
-			int blockDistance = minDistance;
+			int bestBlockSize;
 
-			while (blockDistance <= srcPos && blockDistance <= 0x1000) {
-				int blockStart = srcPos - blockDistance;
-				int blockSize = 0;
+			if (chains != NULL)
+				bestBlockSize = FindMatchHashChain(chains, src, srcSize, srcPos, minDistance, &bestBlockDistance);
+			else
+				bestBlockSize = FindMatchBruteForce(src, srcSize, srcPos, minDistance, &bestBlockDistance);
 
-				while (blockSize < 18
-				    && srcPos + blockSize < srcSize
-				    && src[blockStart + blockSize] == src[srcPos + blockSize])
-					blockSize++;
+			if (bestBlockSize >= LZ_MIN_MATCH) {
+				*flags |= (0x80 >> i);
+				srcPos += bestBlockSize;
+				bestBlockSize -= 3;
+				bestBlockDistance--;
+				dest[destPos++] = (bestBlockSize << 4) | ((unsigned int)bestBlockDistance >> 8);
+				dest[destPos++] = (unsigned char)bestBlockDistance;
+			} else {
+				dest[destPos++] = src[srcPos++];
+			}
 
-				if (blockSize > bestBlockSize) {
-					bestBlockDistance = blockDistance;
-					bestBlockSize = blockSize;
+			if (srcPos == srcSize) {
+				// Pad to multiple of 4 bytes.
+				int remainder = destPos % 4;
 
-					if (blockSize == 18)
-						break;
+				if (remainder != 0) {
+					for (int i = 0; i < 4 - remainder; i++)
+						dest[destPos++] = 0;
 				}
 
-				blockDistance++;
+				FreeHashChains(chains);
+
+				*compressedSize = destPos;
+				return dest;
+			}
+		}
+	}
+
+fail:
+	FATAL_ERROR("Fatal error while compressing LZ file.\n");
+}
+
+// Optimal parsing: instead of always taking the longest match, choose the
+// sequence of literals and matches that gives the smallest output. A literal
+// costs 9 bits (8 data bits and a flag bit) and a match of any length costs
+// 17, so the cheapest encoding of each suffix of the input can be computed
+// from the end backwards. A match of the longest length at some distance can
+// also be used with any shorter length at that distance, so only the longest
+// match at each position is needed.
+unsigned char *LZCompressOptimal(unsigned char *src, int srcSize, int *compressedSize, const int minDistance)
+{
+	if (srcSize <= 0)
+		goto fail;
+
+	int worstCaseDestSize = 4 + srcSize + ((srcSize + 7) / 8);
+
+	// Round up to the next multiple of four.
+	worstCaseDestSize = (worstCaseDestSize + 3) & ~3;
+
+	unsigned char *dest = malloc(worstCaseDestSize);
+	int *longestMatchSize = malloc(srcSize * sizeof(int));
+	int *longestMatchDistance = malloc(srcSize * sizeof(int));
+	int *cost = malloc((srcSize + 1) * sizeof(int));
+	unsigned char *chosenSize = malloc(srcSize);
+	struct HashChains *chains = NewHashChains(srcSize);
+
+	if (dest == NULL || longestMatchSize == NULL || longestMatchDistance == NULL
+	    || cost == NULL || chosenSize == NULL || chains == NULL)
+		goto fail;
+
+	for (int pos = 0; pos < srcSize; pos++)
+		longestMatchSize[pos] = FindMatchHashChain(chains, src, srcSize, pos, minDistance, &longestMatchDistance[pos]);
+
+	FreeHashChains(chains);
+
+	cost[srcSize] = 0;
+
+	for (int pos = srcSize - 1; pos >= 0; pos--) {
+		cost[pos] = cost[pos + 1] + 9;
+		chosenSize[pos] = 1;
+
+		for (int blockSize = LZ_MIN_MATCH; blockSize <= longestMatchSize[pos]; blockSize++) {
+			int blockCost = cost[pos + blockSize] + 17;
+
+			if (blockCost < cost[pos]) {
+				cost[pos] = blockCost;
+				chosenSize[pos] = blockSize;
 			}
+		}
+	}
+
+	// header
+	dest[0] = 0x10; // LZ compression type
+	dest[1] = (unsigned char)srcSize;
+	dest[2] = (unsigned char)(srcSize >> 8);
+	dest[3] = (unsigned char)(srcSize >> 16);
+
+	int srcPos = 0;
+	int destPos = 4;
+
+	for (;;) {
+		unsigned char *flags = &dest[destPos++];
+		*flags = 0;
+
+		for (int i = 0; i < 8; i++) {
+			int blockSize = chosenSize[srcPos];
+
+			if (blockSize >= LZ_MIN_MATCH) {
+				int blockDistance = longestMatchDistance[srcPos] - 1;
 
-			if (bestBlockSize >= 3) {
 				*flags |= (0x80 >> i);
-				srcPos += bestBlockSize;
-				bestBlockSize -= 3;
-				bestBlockDistance--;
-				dest[destPos++] = (bestBlockSize << 4) | ((unsigned int)bestBlockDistance >> 8);
-				dest[destPos++] = (unsigned char)bestBlockDistance;
+				srcPos += blockSize;
+				blockSize -= 3;
+				dest[destPos++] = (blockSize << 4) | ((unsigned int)blockDistance >> 8);
+				dest[destPos++] = (unsigned char)blockDistance;
 			} else {
 				dest[destPos++] = src[srcPos++];
 			}
@@ -142,6 +466,11 @@ unsigned char *LZCompress(unsigned char *src, int srcSize, int *compressedSize,
 						dest[destPos++] = 0;
 				}
 
+				free(longestMatchSize);
+				free(longestMatchDistance);
+				free(cost);
+				free(chosenSize);
+
 				*compressedSize = destPos;
 				return dest;
 			}
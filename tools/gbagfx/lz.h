@@ -3,7 +3,22 @@
 #ifndef LZ_H
 #define LZ_H
 
+#include <stdbool.h>
+
 unsigned char *LZDecompress(unsigned char *src, int srcSize, int *uncompressedSize);
+
+// Checks that compressed data decompresses to the expected bytes, without
+// the overflow warning LZDecompress prints for Ruby/Sapphire's tilesets.
+bool LZVerify(unsigned char *src, int srcSize, unsigned char *expected, int expectedSize);
+
+enum LZMatcher
+{
+	LZ_MATCHER_HASH_CHAIN,
+	LZ_MATCHER_BRUTE_FORCE, // the original exhaustive search
+};
+
 unsigned char *LZCompress(unsigned char *src, int srcSize, int *compressedSize, const int minDistance);
+unsigned char *LZCompressWithMatcher(unsigned char *src, int srcSize, int *compressedSize, const int minDistance, enum LZMatcher matcher);
+unsigned char *LZCompressOptimal(unsigned char *src, int srcSize, int *compressedSize, const int minDistance);
 
 #endif // LZ_H
@@ -0,0 +1,215 @@
+// Copyright (c) 2015 YamaArashi
+
+// Benchmarks the LZ compressors on a set of files, e.g.
+//     lz-bench $(find ../../graphics -name '*.4bpp')
+//
+// By default it compares the hash chain and brute force match finders,
+// checking that they produce identical output. With -optimal it instead
+// compares the greedy and optimal compressors, checking that the optimal
+// output decompresses correctly and reporting how many bytes it saves.
+// Either way, the first compressor's output is also decompressed, timed and
+// checked against the input.
+// Files are processed in parallel on -j THREADS threads.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include "global.h"
+#include "util.h"
+#include "lz.h"
+
+struct FileResult
+{
+	int inputSize;
+	int sizes[2];
+	double times[2];
+	double decodeTime;
+	bool failed;
+};
+
+static char **s_files;
+static int s_numFiles;
+static struct FileResult *s_results;
+static int s_minDistance = 2;
+static bool s_optimal;
+static int s_nextFile;
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static double Now(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned char *Compress(int which, unsigned char *buffer, int fileSize, int *compressedSize)
+{
+	if (s_optimal)
+		return which == 0 ? LZCompress(buffer, fileSize, compressedSize, s_minDistance)
+		                  : LZCompressOptimal(buffer, fileSize, compressedSize, s_minDistance);
+
+	return LZCompressWithMatcher(buffer, fileSize, compressedSize, s_minDistance,
+	                             which == 0 ? LZ_MATCHER_HASH_CHAIN : LZ_MATCHER_BRUTE_FORCE);
+}
+
+static void BenchFile(char *path, struct FileResult *result)
+{
+	int fileSize;
+	unsigned char *buffer = ReadWholeFile(path, &fileSize);
+	unsigned char *compressedData[2];
+
+	result->inputSize = fileSize;
+
+	if (fileSize == 0) {
+		free(buffer);
+		return;
+	}
+
+	for (int which = 0; which < 2; which++) {
+		double start = Now(CLOCK_THREAD_CPUTIME_ID);
+		compressedData[which] = Compress(which, buffer, fileSize, &result->sizes[which]);
+		result->times[which] = Now(CLOCK_THREAD_CPUTIME_ID) - start;
+	}
+
+	double start = Now(CLOCK_THREAD_CPUTIME_ID);
+	int uncompressedSize;
+	unsigned char *uncompressedData = LZDecompress(compressedData[0], result->sizes[0], &uncompressedSize);
+	result->decodeTime = Now(CLOCK_THREAD_CPUTIME_ID) - start;
+
+	if (uncompressedSize != fileSize || memcmp(uncompressedData, buffer, fileSize) != 0) {
+		fprintf(stderr, "%s: output doesn't decompress to the input\n", path);
+		result->failed = true;
+	}
+
+	free(uncompressedData);
+
+	if (s_optimal) {
+		if (!LZVerify(compressedData[1], result->sizes[1], buffer, fileSize)) {
+			fprintf(stderr, "%s: optimal output doesn't decompress to the input\n", path);
+			result->failed = true;
+		} else if (result->sizes[1] > result->sizes[0]) {
+			fprintf(stderr, "%s: optimal output is larger than greedy output\n", path);
+			result->failed = true;
+		}
+	} else if (result->sizes[0] != result->sizes[1]
+	        || memcmp(compressedData[0], compressedData[1], result->sizes[0]) != 0) {
+		fprintf(stderr, "%s: match finders disagree\n", path);
+		result->failed = true;
+	}
+
+	free(compressedData[0]);
+	free(compressedData[1]);
+	free(buffer);
+}
+
+static void *Worker(void *arg UNUSED)
+{
+	for (;;) {
+		pthread_mutex_lock(&s_mutex);
+		int i = s_nextFile++;
+		pthread_mutex_unlock(&s_mutex);
+
+		if (i >= s_numFiles)
+			return NULL;
+
+		BenchFile(s_files[i], &s_results[i]);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int numThreads = 1;
+	int i = 1;
+
+	for (; i < argc && argv[i][0] == '-'; i++) {
+		if (strcmp(argv[i], "-optimal") == 0) {
+			s_optimal = true;
+		} else if (strcmp(argv[i], "-search") == 0 && i + 1 < argc) {
+			if (!ParseNumber(argv[++i], NULL, 10, &s_minDistance) || s_minDistance < 1)
+				FATAL_ERROR("LZ min search distance must be positive.\n");
+		} else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			if (!ParseNumber(argv[++i], NULL, 10, &numThreads) || numThreads < 1)
+				FATAL_ERROR("Thread count must be positive.\n");
+		} else {
+			FATAL_ERROR("Unrecognized option \"%s\".\n", argv[i]);
+		}
+	}
+
+	if (i >= argc)
+		FATAL_ERROR("Usage: lz-bench [-optimal] [-search MIN_DISTANCE] [-j THREADS] FILE...\n");
+
+	s_files = &argv[i];
+	s_numFiles = argc - i;
+	s_results = calloc(s_numFiles, sizeof(struct FileResult));
+
+	if (s_results == NULL)
+		FATAL_ERROR("Failed to allocate memory for results.\n");
+
+	pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+
+	if (threads == NULL)
+		FATAL_ERROR("Failed to allocate memory for threads.\n");
+
+	double start = Now(CLOCK_MONOTONIC);
+
+	for (int t = 0; t < numThreads; t++)
+		if (pthread_create(&threads[t], NULL, Worker, NULL) != 0)
+			FATAL_ERROR("Failed to create thread.\n");
+
+	for (int t = 0; t < numThreads; t++)
+		pthread_join(threads[t], NULL);
+
+	double wallTime = Now(CLOCK_MONOTONIC) - start;
+
+	long long totalInput = 0;
+	long long totalSizes[2] = { 0, 0 };
+	double totalTimes[2] = { 0, 0 };
+	double totalDecodeTime = 0;
+	int numFailed = 0;
+
+	for (int f = 0; f < s_numFiles; f++) {
+		totalInput += s_results[f].inputSize;
+
+		for (int which = 0; which < 2; which++) {
+			totalSizes[which] += s_results[f].sizes[which];
+			totalTimes[which] += s_results[f].times[which];
+		}
+
+		totalDecodeTime += s_results[f].decodeTime;
+
+		if (s_results[f].failed)
+			numFailed++;
+	}
+
+	const char *names[2] = { "hash chain", "brute force" };
+
+	if (s_optimal) {
+		names[0] = "greedy";
+		names[1] = "optimal";
+	}
+
+	double megabytes = totalInput / (1024.0 * 1024.0);
+
+	printf("%d files, %lld bytes, %.3f s on %d thread(s)\n", s_numFiles, totalInput, wallTime, numThreads);
+
+	for (int which = 0; which < 2; which++)
+		printf("%-12s %10lld bytes  %8.3f s  %8.2f MiB/s\n", names[which], totalSizes[which],
+		       totalTimes[which], totalTimes[which] > 0 ? megabytes / totalTimes[which] : 0.0);
+
+	printf("%-12s %10lld bytes  %8.3f s  %8.2f MiB/s\n", "decompress", totalInput,
+	       totalDecodeTime, totalDecodeTime > 0 ? megabytes / totalDecodeTime : 0.0);
+
+	if (s_optimal && totalSizes[0] > 0)
+		printf("optimal saves %lld bytes (%.2f%%)\n", totalSizes[0] - totalSizes[1],
+		       100.0 * (totalSizes[0] - totalSizes[1]) / totalSizes[0]);
+
+	if (numFailed != 0)
+		FATAL_ERROR("%d file(s) failed.\n", numFailed);
+
+	return 0;
+}
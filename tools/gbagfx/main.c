@@ -13,6 +13,7 @@
 #include "rl.h"
 #include "font.h"
 #include "huff.h"
+#include "manifest.h"
 
 struct CommandHandler
 {
@@ -75,9 +76,24 @@ void ConvertPngToGba(char *inputPath, char *outputPath, struct PngToGbaOptions *
     image.bitDepth = options->bitDepth;
     image.tilemap.data.affine = NULL; // initialize to NULL to avoid issues in FreeImage
 
-    ReadPng(inputPath, &image);
+    if (options->tilemapFilePath != NULL)
+    {
+        // Read the pixels at 8 bits each so that an 8-bit image's palette
+        // banks survive for a 4bpp tilemap. ReadPng leaves bitDepth set to
+        // the image's own bit depth.
+        image.bitDepth = 8;
+        ReadPng(inputPath, &image);
+
+        bool paletteBanks = options->bitDepth == 4 && image.bitDepth == 8;
+
+        WriteImageWithTilemap(outputPath, options->tilemapFilePath, options->numTiles, options->bitDepth, options->metatileWidth, options->metatileHeight, &image, options->isAffineMap, paletteBanks, !image.hasPalette);
+    }
+    else
+    {
+        ReadPng(inputPath, &image);
 
-    WriteImage(outputPath, options->numTiles, options->bitDepth, options->metatileWidth, options->metatileHeight, &image, !image.hasPalette);
+        WriteImage(outputPath, options->numTiles, options->bitDepth, options->metatileWidth, options->metatileHeight, &image, !image.hasPalette);
+    }
 
     FreeImage(&image);
 }
@@ -229,12 +245,29 @@ void HandlePngToGbaCommand(char *inputPath, char *outputPath, int argc, char **a
             if (options.metatileHeight < 1)
                 FATAL_ERROR("metatile height must be positive.\n");
         }
+        else if (strcmp(option, "-tiles") == 0)
+        {
+            // Write only the distinct tiles, plus a tilemap to this path.
+            if (i + 1 >= argc)
+                FATAL_ERROR("No tilemap path following \"-tiles\".\n");
+
+            i++;
+
+            options.tilemapFilePath = argv[i];
+        }
+        else if (strcmp(option, "-affine") == 0)
+        {
+            options.isAffineMap = true;
+        }
         else
         {
             FATAL_ERROR("Unrecognized option \"%s\".\n", option);
         }
     }
 
+    if (options.isAffineMap && options.tilemapFilePath == NULL)
+        FATAL_ERROR("\"-affine\" requires \"-tiles\".\n");
+
     ConvertPngToGba(inputPath, outputPath, &options);
 }
 
@@ -375,6 +408,9 @@ void HandleLZCompressCommand(char *inputPath, char *outputPath, int argc, char *
 {
     int overflowSize = 0;
     int minDistance = 2; // default, for compatibility with LZ77UnCompVram()
+    enum LZMatcher matcher = LZ_MATCHER_HASH_CHAIN;
+    bool optimal = false;
+    bool verify = false;
 
     for (int i = 3; i < argc; i++)
     {
@@ -406,6 +442,22 @@ void HandleLZCompressCommand(char *inputPath, char *outputPath, int argc, char *
             if (minDistance < 1)
                 FATAL_ERROR("LZ min search distance must be positive.\n");
         }
+        else if (strcmp(option, "-reference") == 0)
+        {
+            // Use the original brute force match search. The output is the
+            // same, so this is only useful for checking the faster one.
+            matcher = LZ_MATCHER_BRUTE_FORCE;
+        }
+        else if (strcmp(option, "-optimal") == 0)
+        {
+            // Produce the smallest possible output rather than matching the
+            // original greedy compressor.
+            optimal = true;
+        }
+        else if (strcmp(option, "-verify") == 0)
+        {
+            verify = true;
+        }
         else
         {
             FATAL_ERROR("Unrecognized option \"%s\".\n", option);
@@ -422,12 +474,20 @@ void HandleLZCompressCommand(char *inputPath, char *outputPath, int argc, char *
     unsigned char *buffer = ReadWholeFileZeroPadded(inputPath, &fileSize, overflowSize);
 
     int compressedSize;
-    unsigned char *compressedData = LZCompress(buffer, fileSize + overflowSize, &compressedSize, minDistance);
+    unsigned char *compressedData;
+
+    if (optimal)
+        compressedData = LZCompressOptimal(buffer, fileSize + overflowSize, &compressedSize, minDistance);
+    else
+        compressedData = LZCompressWithMatcher(buffer, fileSize + overflowSize, &compressedSize, minDistance, matcher);
 
     compressedData[1] = (unsigned char)fileSize;
     compressedData[2] = (unsigned char)(fileSize >> 8);
     compressedData[3] = (unsigned char)(fileSize >> 16);
 
+    if (verify && !LZVerify(compressedData, compressedSize, buffer, fileSize))
+        FATAL_ERROR("LZ compressed data for \"%s\" doesn't decompress to the input.\n", inputPath);
+
     free(buffer);
 
     WriteWholeFile(outputPath, compressedData, compressedSize);
@@ -450,14 +510,33 @@ void HandleLZDecompressCommand(char *inputPath, char *outputPath, int argc UNUSE
     free(uncompressedData);
 }
 
-void HandleRLCompressCommand(char *inputPath, char *outputPath, int argc UNUSED, char **argv UNUSED)
+void HandleRLCompressCommand(char *inputPath, char *outputPath, int argc, char **argv)
 {
+    bool verify = false;
+
+    for (int i = 3; i < argc; i++)
+    {
+        char *option = argv[i];
+
+        if (strcmp(option, "-verify") == 0)
+        {
+            verify = true;
+        }
+        else
+        {
+            FATAL_ERROR("Unrecognized option \"%s\".\n", option);
+        }
+    }
+
     int fileSize;
     unsigned char *buffer = ReadWholeFile(inputPath, &fileSize);
 
     int compressedSize;
     unsigned char *compressedData = RLCompress(buffer, fileSize, &compressedSize);
 
+    if (verify && !RLVerify(compressedData, compressedSize, buffer, fileSize))
+        FATAL_ERROR("RL compressed data for \"%s\" doesn't decompress to the input.\n", inputPath);
+
     free(buffer);
 
     WriteWholeFile(outputPath, compressedData, compressedSize);
@@ -484,6 +563,7 @@ void HandleHuffCompressCommand(char *inputPath, char *outputPath, int argc, char
 {
     int fileSize;
     int bitDepth = 4;
+    bool verify = false;
 
     for (int i = 3; i < argc; i++)
     {
@@ -502,6 +582,10 @@ void HandleHuffCompressCommand(char *inputPath, char *outputPath, int argc, char
             if (bitDepth != 4 && bitDepth != 8)
                 FATAL_ERROR("GBA only supports bit depth of 4 or 8.\n");
         }
+        else if (strcmp(option, "-verify") == 0)
+        {
+            verify = true;
+        }
         else
         {
             FATAL_ERROR("Unrecognized option \"%s\".\n", option);
@@ -513,6 +597,17 @@ void HandleHuffCompressCommand(char *inputPath, char *outputPath, int argc, char
     int compressedSize;
     unsigned char *compressedData = HuffCompress(buffer, fileSize, &compressedSize, bitDepth);
 
+    if (verify)
+    {
+        int uncompressedSize;
+        unsigned char *uncompressedData = HuffDecompress(compressedData, compressedSize, &uncompressedSize);
+
+        if (uncompressedSize != fileSize || memcmp(uncompressedData, buffer, fileSize) != 0)
+            FATAL_ERROR("Huffman compressed data for \"%s\" doesn't decompress to the input.\n", inputPath);
+
+        free(uncompressedData);
+    }
+
     free(buffer);
 
     WriteWholeFile(outputPath, compressedData, compressedSize);
@@ -535,13 +630,10 @@ void HandleHuffDecompressCommand(char *inputPath, char *outputPath, int argc UNU
     free(uncompressedData);
 }
 
-int main(int argc, char **argv)
+static void ConvertFile(int argc, char **argv)
 {
     char converted = 0;
 
-    if (argc < 3)
-        FATAL_ERROR("Usage: gbagfx INPUT_PATH OUTPUT_PATH [options...]\n");
-
     struct CommandHandler handlers[] =
     {
         { "1bpp", "png", HandleGbaToPngCommand },
@@ -621,6 +713,37 @@ int main(int argc, char **argv)
 
     if (!converted)
         FATAL_ERROR("Don't know how to convert \"%s\" to \"%s\".\n", argv[1], argv[2]);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+        FATAL_ERROR("Usage: gbagfx INPUT_PATH OUTPUT_PATH [options...]\n"
+                    "       gbagfx -manifest MANIFEST_PATH [-j THREADS]\n");
+
+    if (strcmp(argv[1], "-manifest") == 0)
+    {
+        int numThreads = 0; // one per processor
+
+        if (argc == 5 && strcmp(argv[3], "-j") == 0)
+        {
+            if (!ParseNumber(argv[4], NULL, 10, &numThreads))
+                FATAL_ERROR("Failed to parse thread count.\n");
+        }
+        else if (argc != 3)
+        {
+            FATAL_ERROR("Usage: gbagfx -manifest MANIFEST_PATH [-j THREADS]\n");
+        }
+
+        if (numThreads < 0)
+            FATAL_ERROR("Thread count can't be negative.\n");
+
+        RunManifest(argv[2], numThreads, ConvertFile);
+    }
+    else
+    {
+        ConvertFile(argc, argv);
+    }
 
     return 0;
 }
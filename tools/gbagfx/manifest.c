@@ -0,0 +1,237 @@
+// Copyright (c) 2015 YamaArashi
+
+// A manifest lists many conversions to run in one process, one per line:
+//
+//     INPUT_PATH OUTPUT_PATH [options...]
+//
+// Blank lines and lines starting with '#' are ignored. The conversions run
+// on a pool of threads. A line whose input is the output of an earlier line
+// waits for that line to finish, so e.g. a .png -> .4bpp conversion can be
+// followed by a .4bpp -> .4bpp.lz one. Outputs are only written if their
+// contents change.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "global.h"
+#include "util.h"
+#include "manifest.h"
+
+struct ManifestJob
+{
+	int argc;
+	char **argv;
+	int dependency; // index of the job that produces the input, or -1
+	bool done;
+};
+
+struct Manifest
+{
+	struct ManifestJob *jobs;
+	int numJobs;
+	int nextJob;
+	ConvertFunction convert;
+	pthread_mutex_t mutex;
+	pthread_cond_t jobDone;
+};
+
+static bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static unsigned int HashPath(const char *path)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*path != 0)
+		hash = (hash ^ (unsigned char)*path++) * 16777619u;
+
+	return hash;
+}
+
+// Splits the manifest into jobs in place, pointing each job's argv into the
+// file's buffer. argv[0] is a placeholder so that the options start at
+// argv[3], like on the command line.
+static void ParseManifest(char *manifestPath, unsigned char *buffer, int size, struct Manifest *manifest)
+{
+	int numLines = 1;
+
+	for (int i = 0; i < size; i++)
+		if (buffer[i] == '\n')
+			numLines++;
+
+	manifest->jobs = malloc(numLines * sizeof(struct ManifestJob));
+
+	// Open addressing table from output path to the job that writes it.
+	int tableSize = 1;
+
+	while (tableSize < numLines * 2)
+		tableSize *= 2;
+
+	int *producers = malloc(tableSize * sizeof(int));
+
+	if (manifest->jobs == NULL || producers == NULL)
+		FATAL_ERROR("Failed to allocate memory for manifest \"%s\".\n", manifestPath);
+
+	for (int i = 0; i < tableSize; i++)
+		producers[i] = -1;
+
+	manifest->numJobs = 0;
+
+	char *line = (char *)buffer;
+	char *end = (char *)buffer + size;
+	int lineNum = 0;
+
+	while (line < end) {
+		char *lineEnd = memchr(line, '\n', end - line);
+
+		if (lineEnd == NULL)
+			lineEnd = end;
+
+		*lineEnd = 0;
+		lineNum++;
+
+		int numTokens = 0;
+
+		for (char *p = line; *p != 0; p++)
+			if (!IsSpace(*p) && (p == line || IsSpace(p[-1])))
+				numTokens++;
+
+		if (numTokens != 0 && line[strspn(line, " \t\r")] != '#') {
+			if (numTokens < 2)
+				FATAL_ERROR("%s:%d: expected an input and an output path.\n", manifestPath, lineNum);
+
+			struct ManifestJob *job = &manifest->jobs[manifest->numJobs];
+
+			job->argv = malloc((numTokens + 2) * sizeof(char *));
+
+			if (job->argv == NULL)
+				FATAL_ERROR("Failed to allocate memory for manifest \"%s\".\n", manifestPath);
+
+			job->argv[0] = "gbagfx";
+			job->argc = 1;
+
+			for (char *p = line; *p != 0;) {
+				while (IsSpace(*p))
+					*p++ = 0;
+
+				if (*p == 0)
+					break;
+
+				job->argv[job->argc++] = p;
+
+				while (*p != 0 && !IsSpace(*p))
+					p++;
+			}
+
+			job->argv[job->argc] = NULL;
+			job->done = false;
+			job->dependency = -1;
+
+			unsigned int mask = tableSize - 1;
+
+			for (unsigned int slot = HashPath(job->argv[1]) & mask; producers[slot] != -1; slot = (slot + 1) & mask) {
+				if (strcmp(manifest->jobs[producers[slot]].argv[2], job->argv[1]) == 0) {
+					job->dependency = producers[slot];
+					break;
+				}
+			}
+
+			unsigned int slot = HashPath(job->argv[2]) & mask;
+
+			while (producers[slot] != -1 && strcmp(manifest->jobs[producers[slot]].argv[2], job->argv[2]) != 0)
+				slot = (slot + 1) & mask;
+
+			producers[slot] = manifest->numJobs++;
+		}
+
+		line = lineEnd + 1;
+	}
+
+	free(producers);
+}
+
+static void *Worker(void *arg)
+{
+	struct Manifest *manifest = arg;
+
+	for (;;) {
+		pthread_mutex_lock(&manifest->mutex);
+
+		if (manifest->nextJob == manifest->numJobs) {
+			pthread_mutex_unlock(&manifest->mutex);
+			return NULL;
+		}
+
+		// Jobs are started in order, so a job's dependency has always been
+		// started by the time we get to it.
+		struct ManifestJob *job = &manifest->jobs[manifest->nextJob++];
+
+		while (job->dependency != -1 && !manifest->jobs[job->dependency].done)
+			pthread_cond_wait(&manifest->jobDone, &manifest->mutex);
+
+		pthread_mutex_unlock(&manifest->mutex);
+
+		manifest->convert(job->argc, job->argv);
+
+		pthread_mutex_lock(&manifest->mutex);
+		job->done = true;
+		pthread_cond_broadcast(&manifest->jobDone);
+		pthread_mutex_unlock(&manifest->mutex);
+	}
+}
+
+void RunManifest(char *manifestPath, int numThreads, ConvertFunction convert)
+{
+	int size;
+	unsigned char *buffer = ReadWholeFileZeroPadded(manifestPath, &size, 1);
+	struct Manifest manifest;
+
+	ParseManifest(manifestPath, buffer, size, &manifest);
+
+	manifest.nextJob = 0;
+	manifest.convert = convert;
+	pthread_mutex_init(&manifest.mutex, NULL);
+	pthread_cond_init(&manifest.jobDone, NULL);
+
+	gWriteOnlyIfChanged = true;
+
+	if (numThreads == 0) {
+		numThreads = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+		long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+		if (numProcessors > 0)
+			numThreads = numProcessors;
+#endif
+	}
+
+	if (numThreads > manifest.numJobs)
+		numThreads = manifest.numJobs;
+
+	pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+
+	if (numThreads > 0 && threads == NULL)
+		FATAL_ERROR("Failed to allocate memory for threads.\n");
+
+	for (int i = 0; i < numThreads; i++)
+		if (pthread_create(&threads[i], NULL, Worker, &manifest) != 0)
+			FATAL_ERROR("Failed to create thread.\n");
+
+	for (int i = 0; i < numThreads; i++)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+
+	for (int i = 0; i < manifest.numJobs; i++)
+		free(manifest.jobs[i].argv);
+
+	free(manifest.jobs);
+	free(buffer);
+}
@@ -0,0 +1,12 @@
+// Copyright (c) 2015 YamaArashi
+
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+typedef void (*ConvertFunction)(int argc, char **argv);
+
+// Runs the conversions listed in a manifest file. A numThreads of 0 means one
+// thread per processor.
+void RunManifest(char *manifestPath, int numThreads, ConvertFunction convert);
+
+#endif // MANIFEST_H
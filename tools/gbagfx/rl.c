@@ -1,29 +1,23 @@
 // Copyright (c) 2016 YamaArashi
 
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include "global.h"
 #include "rl.h"
 
-unsigned char *RLDecompress(unsigned char *src, int srcSize, int *uncompressedSize)
+// Decodes src into dest, which holds destSize bytes. Each packet is
+// checked against both buffers once, and then copied or filled in one go.
+// Returns false if the data is corrupt.
+static bool RLDecode(unsigned char *src, int srcSize, unsigned char *dest, int destSize)
 {
-    if (srcSize < 4)
-        goto fail;
-
-    int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
-
-    unsigned char *dest = malloc(destSize);
-
-    if (dest == NULL)
-        goto fail;
-
     int srcPos = 4;
     int destPos = 0;
 
     for (;;)
     {
         if (srcPos >= srcSize)
-            goto fail;
+            return false;
 
         unsigned char flags = src[srcPos++];
         bool compressed = ((flags & 0x80) != 0);
@@ -31,36 +25,73 @@ unsigned char *RLDecompress(unsigned char *src, int srcSize, int *uncompressedSi
         if (compressed)
         {
             int length = (flags & 0x7F) + 3;
-            unsigned char data = src[srcPos++];
 
-            if (destPos + length > destSize)
-                goto fail;
+            if (srcPos >= srcSize || destPos + length > destSize)
+                return false;
 
-            for (int i = 0; i < length; i++)
-                dest[destPos++] = data;
+            memset(&dest[destPos], src[srcPos++], length);
+            destPos += length;
         }
         else
         {
             int length = (flags & 0x7F) + 1;
 
-            if (destPos + length > destSize)
-                goto fail;
+            if (srcPos + length > srcSize || destPos + length > destSize)
+                return false;
 
-            for (int i = 0; i < length; i++)
-                dest[destPos++] = src[srcPos++];
+            memcpy(&dest[destPos], &src[srcPos], length);
+            srcPos += length;
+            destPos += length;
         }
 
         if (destPos == destSize)
-        {
-            *uncompressedSize = destSize;
-            return dest;
-        }
+            return true;
     }
+}
+
+unsigned char *RLDecompress(unsigned char *src, int srcSize, int *uncompressedSize)
+{
+    if (srcSize < 4)
+        goto fail;
+
+    int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
+
+    unsigned char *dest = malloc(destSize);
+
+    if (dest == NULL)
+        goto fail;
+
+    if (!RLDecode(src, srcSize, dest, destSize))
+        goto fail;
+
+    *uncompressedSize = destSize;
+    return dest;
 
 fail:
     FATAL_ERROR("Fatal error while decompressing RL file.\n");
 }
 
+bool RLVerify(unsigned char *src, int srcSize, unsigned char *expected, int expectedSize)
+{
+    if (srcSize < 4)
+        return false;
+
+    int destSize = (src[3] << 16) | (src[2] << 8) | src[1];
+
+    if (destSize != expectedSize)
+        return false;
+
+    unsigned char *dest = malloc(destSize + 1);
+
+    if (dest == NULL)
+        FATAL_ERROR("Failed to allocate memory for RL verification.\n");
+
+    bool matches = RLDecode(src, srcSize, dest, destSize) && memcmp(dest, expected, destSize) == 0;
+
+    free(dest);
+    return matches;
+}
+
 unsigned char *RLCompress(unsigned char *src, int srcSize, int *compressedSize)
 {
     if (srcSize <= 0)
@@ -3,7 +3,12 @@
 #ifndef RL_H
 #define RL_H
 
+#include <stdbool.h>
+
 unsigned char *RLDecompress(unsigned char *src, int srcSize, int *uncompressedSize);
 unsigned char *RLCompress(unsigned char *src, int srcSize, int *compressedSize);
 
+// Checks that compressed data decompresses to the expected bytes.
+bool RLVerify(unsigned char *src, int srcSize, unsigned char *expected, int expectedSize);
+
 #endif // RL_H
@@ -0,0 +1,110 @@
+// Copyright (c) 2015 YamaArashi
+
+// Benchmarks the tile conversion kernels on a synthetic sheet at each bit
+// depth and with several metatile sizes, checking that the SIMD and scalar
+// kernels agree and that converting to tiles and back is lossless.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "global.h"
+#include "tiles.h"
+
+#define TILES_WIDTH 64
+#define TILES_HEIGHT 64
+#define NUM_TILES (TILES_WIDTH * TILES_HEIGHT)
+#define ITERATIONS 200
+
+static double Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double Time(bool toTiles, unsigned char *image, unsigned char *tiles, int bitDepth, int metatileWidth, int metatileHeight, bool invertColors, enum TileKernel kernel)
+{
+	int metatilesWide = TILES_WIDTH / metatileWidth;
+	double start = Now();
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		if (toTiles)
+			ConvertToTiles(image, tiles, NUM_TILES, bitDepth, metatilesWide, metatileWidth, metatileHeight, invertColors, kernel);
+		else
+			ConvertFromTiles(tiles, image, NUM_TILES, bitDepth, metatilesWide, metatileWidth, metatileHeight, invertColors, kernel);
+	}
+
+	return Now() - start;
+}
+
+int main(void)
+{
+	static const int metatileSizes[][2] = { { 1, 1 }, { 2, 2 }, { 4, 4 }, { 8, 1 }, { 1, 8 } };
+	static const int bitDepths[] = { 1, 4, 8 };
+	int maxSize = NUM_TILES * 64;
+	unsigned char *image = malloc(maxSize);
+	unsigned char *tiles[2] = { malloc(maxSize), malloc(maxSize) };
+	unsigned char *roundTrip[2] = { malloc(maxSize), malloc(maxSize) };
+	int numFailed = 0;
+
+	if (image == NULL || tiles[0] == NULL || tiles[1] == NULL || roundTrip[0] == NULL || roundTrip[1] == NULL)
+		FATAL_ERROR("Failed to allocate memory.\n");
+
+	srand(1);
+
+	for (int i = 0; i < maxSize; i++)
+		image[i] = rand();
+
+	printf("%dx%d tiles, %d iterations\n", TILES_WIDTH, TILES_HEIGHT, ITERATIONS);
+	printf("bpp  metatile  invert   to tiles (scalar / best)   from tiles (scalar / best)\n");
+
+	for (int d = 0; d < 3; d++) {
+		int bitDepth = bitDepths[d];
+		int size = NUM_TILES * bitDepth * 8;
+
+		for (int m = 0; m < 5; m++) {
+			int metatileWidth = metatileSizes[m][0];
+			int metatileHeight = metatileSizes[m][1];
+
+			for (int invert = 0; invert < 2; invert++) {
+				double times[2][2];
+
+				for (int k = 0; k < 2; k++) {
+					enum TileKernel kernel = (k == 0) ? TILE_KERNEL_SCALAR : TILE_KERNEL_BEST;
+
+					times[0][k] = Time(true, image, tiles[k], bitDepth, metatileWidth, metatileHeight, invert, kernel);
+					times[1][k] = Time(false, roundTrip[k], tiles[k], bitDepth, metatileWidth, metatileHeight, invert, kernel);
+				}
+
+				if (memcmp(tiles[0], tiles[1], size) != 0) {
+					fprintf(stderr, "%dbpp %dx%d: kernels disagree converting to tiles\n", bitDepth, metatileWidth, metatileHeight);
+					numFailed++;
+				}
+
+				for (int k = 0; k < 2; k++) {
+					if (memcmp(roundTrip[k], image, size) != 0) {
+						fprintf(stderr, "%dbpp %dx%d: round trip failed\n", bitDepth, metatileWidth, metatileHeight);
+						numFailed++;
+					}
+				}
+
+				double megabytes = (double)size * ITERATIONS / (1024 * 1024);
+
+				printf("%3d  %4dx%-3d  %-6s  %8.0f / %8.0f MiB/s   %8.0f / %8.0f MiB/s\n",
+				       bitDepth, metatileWidth, metatileHeight, invert ? "yes" : "no",
+				       megabytes / times[0][0], megabytes / times[0][1],
+				       megabytes / times[1][0], megabytes / times[1][1]);
+			}
+		}
+	}
+
+	if (numFailed != 0)
+		FATAL_ERROR("%d check(s) failed.\n", numFailed);
+
+	return 0;
+}
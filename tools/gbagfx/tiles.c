@@ -0,0 +1,303 @@
+// Copyright (c) 2015 YamaArashi
+
+#include <stdbool.h>
+#include <string.h>
+#include "global.h"
+#include "tiles.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HAVE_SSE2
+#endif
+
+// Each row of a tile is bitDepth bytes, both in the image and in the tile
+// data, so converting a tile is a matter of gathering its eight rows from
+// the image (or scattering them back) and transforming each byte:
+//  - 1bpp: images store the leftmost pixel in the top bit, tiles in the
+//    bottom bit, so the bits are reversed.
+//  - 4bpp: likewise for nibbles, so the nibbles are swapped.
+//  - 8bpp: bytes are copied as they are.
+// Inverting colors flips every bit in all three cases. The transform is its
+// own inverse, so the same code converts in both directions.
+
+struct TileRun
+{
+	unsigned char *image; // top left pixel of the first tile
+	unsigned char *tiles; // data of the first tile
+	int numTiles;         // number of tiles side by side in the image
+};
+
+static unsigned char ReverseBits(unsigned char x)
+{
+	x = (x >> 4) | (x << 4);
+	x = ((x >> 2) & 0x33) | ((x & 0x33) << 2);
+	x = ((x >> 1) & 0x55) | ((x & 0x55) << 1);
+	return x;
+}
+
+static void BuildByteTable(unsigned char *table, int bitDepth, bool invertColors)
+{
+	for (int i = 0; i < 256; i++) {
+		unsigned char x = i;
+
+		if (bitDepth == 1)
+			x = ReverseBits(x);
+		else if (bitDepth == 4)
+			x = (x >> 4) | (x << 4);
+
+		table[i] = invertColors ? ~x : x;
+	}
+}
+
+static void ConvertRunScalar(struct TileRun *run, int bitDepth, int pitch, bool toTiles, const unsigned char *table)
+{
+	unsigned char *tiles = run->tiles;
+
+	for (int i = 0; i < run->numTiles; i++) {
+		unsigned char *row = run->image + i * bitDepth;
+
+		for (int j = 0; j < 8; j++) {
+			for (int k = 0; k < bitDepth; k++) {
+				if (toTiles)
+					tiles[k] = table[row[k]];
+				else
+					row[k] = table[tiles[k]];
+			}
+
+			tiles += bitDepth;
+			row += pitch;
+		}
+	}
+}
+
+#ifdef HAVE_SSE2
+
+static __m128i TransformBytes(__m128i x, int bitDepth, __m128i invertMask)
+{
+	if (bitDepth != 8) {
+		x = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0F)),
+		                 _mm_and_si128(_mm_slli_epi16(x, 4), _mm_set1_epi8((char)0xF0)));
+	}
+
+	if (bitDepth == 1) {
+		x = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(x, 2), _mm_set1_epi8(0x33)),
+		                 _mm_slli_epi16(_mm_and_si128(x, _mm_set1_epi8(0x33)), 2));
+		x = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi8(0x55)),
+		                 _mm_slli_epi16(_mm_and_si128(x, _mm_set1_epi8(0x55)), 1));
+	}
+
+	return _mm_xor_si128(x, invertMask);
+}
+
+// Converts a group of tiles that fills one 128-bit register per image row:
+// 2 tiles at 8bpp, 4 at 4bpp, or (using the low 64 bits) 8 at 1bpp. Going
+// between image rows and tiles is a transpose of the group's 8 rows, with
+// bitDepth-byte elements. Each transpose below is its own inverse, so only
+// the addresses that are loaded and stored differ between directions.
+static void ConvertGroupSse2(unsigned char *image, unsigned char *tiles, int bitDepth, int pitch, bool toTiles, __m128i invertMask)
+{
+	unsigned char *rows[8];
+	unsigned char *chunks[8];
+	__m128i in[8];
+	__m128i out[8];
+	int size = (bitDepth == 1) ? 8 : 16;
+
+	for (int j = 0; j < 8; j++)
+		rows[j] = image + j * pitch;
+
+	// chunks[k] is where the transpose's output register k goes in the
+	// tile data.
+	for (int k = 0; k < 8; k++) {
+		switch (bitDepth) {
+		case 1:
+			chunks[k] = tiles + k * 8;
+			break;
+		case 4:
+			chunks[k] = tiles + (k % 4) * 32 + (k / 4) * 16;
+			break;
+		default: // 8bpp
+			chunks[k] = tiles + (k % 2) * 64 + (k / 2) * 16;
+			break;
+		}
+	}
+
+	unsigned char **src = toTiles ? rows : chunks;
+	unsigned char **dest = toTiles ? chunks : rows;
+
+	for (int j = 0; j < 8; j++) {
+		if (size == 8)
+			in[j] = _mm_loadl_epi64((const __m128i *)src[j]);
+		else
+			in[j] = _mm_loadu_si128((const __m128i *)src[j]);
+
+		in[j] = TransformBytes(in[j], bitDepth, invertMask);
+	}
+
+	switch (bitDepth) {
+	case 1: {
+		// 8x8 bytes.
+		__m128i a0 = _mm_unpacklo_epi8(in[0], in[1]);
+		__m128i a1 = _mm_unpacklo_epi8(in[2], in[3]);
+		__m128i a2 = _mm_unpacklo_epi8(in[4], in[5]);
+		__m128i a3 = _mm_unpacklo_epi8(in[6], in[7]);
+		__m128i b0 = _mm_unpacklo_epi16(a0, a1);
+		__m128i b1 = _mm_unpackhi_epi16(a0, a1);
+		__m128i b2 = _mm_unpacklo_epi16(a2, a3);
+		__m128i b3 = _mm_unpackhi_epi16(a2, a3);
+		__m128i c0 = _mm_unpacklo_epi32(b0, b2);
+		__m128i c1 = _mm_unpackhi_epi32(b0, b2);
+		__m128i c2 = _mm_unpacklo_epi32(b1, b3);
+		__m128i c3 = _mm_unpackhi_epi32(b1, b3);
+		out[0] = c0;
+		out[1] = _mm_unpackhi_epi64(c0, c0);
+		out[2] = c1;
+		out[3] = _mm_unpackhi_epi64(c1, c1);
+		out[4] = c2;
+		out[5] = _mm_unpackhi_epi64(c2, c2);
+		out[6] = c3;
+		out[7] = _mm_unpackhi_epi64(c3, c3);
+		break;
+	}
+	case 4:
+		// Two 4x4 transposes of 32-bit elements.
+		for (int h = 0; h < 8; h += 4) {
+			__m128i a0 = _mm_unpacklo_epi32(in[h + 0], in[h + 1]);
+			__m128i a1 = _mm_unpackhi_epi32(in[h + 0], in[h + 1]);
+			__m128i a2 = _mm_unpacklo_epi32(in[h + 2], in[h + 3]);
+			__m128i a3 = _mm_unpackhi_epi32(in[h + 2], in[h + 3]);
+			out[h + 0] = _mm_unpacklo_epi64(a0, a2);
+			out[h + 1] = _mm_unpackhi_epi64(a0, a2);
+			out[h + 2] = _mm_unpacklo_epi64(a1, a3);
+			out[h + 3] = _mm_unpackhi_epi64(a1, a3);
+		}
+		break;
+	default:
+		// 8bpp: four 2x2 transposes of 64-bit elements.
+		for (int h = 0; h < 8; h += 2) {
+			out[h + 0] = _mm_unpacklo_epi64(in[h], in[h + 1]);
+			out[h + 1] = _mm_unpackhi_epi64(in[h], in[h + 1]);
+		}
+		break;
+	}
+
+	for (int j = 0; j < 8; j++) {
+		if (size == 8)
+			_mm_storel_epi64((__m128i *)dest[j], out[j]);
+		else
+			_mm_storeu_si128((__m128i *)dest[j], out[j]);
+	}
+}
+
+// Converts a single tile, for runs too short to fill a group. Only the byte
+// transform is vectorized; the rows are gathered and scattered with memcpy.
+static void ConvertTileSse2(unsigned char *image, unsigned char *tiles, int bitDepth, int pitch, bool toTiles, __m128i invertMask)
+{
+	unsigned char buffer[64];
+	int tileSize = bitDepth * 8;
+
+	if (toTiles) {
+		for (int j = 0; j < 8; j++)
+			memcpy(&buffer[j * bitDepth], image + j * pitch, bitDepth);
+	} else {
+		memcpy(buffer, tiles, tileSize);
+	}
+
+	if (tileSize == 8) {
+		__m128i x = _mm_loadl_epi64((const __m128i *)buffer);
+		_mm_storel_epi64((__m128i *)buffer, TransformBytes(x, bitDepth, invertMask));
+	} else {
+		for (int i = 0; i < tileSize; i += 16) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&buffer[i]);
+			_mm_storeu_si128((__m128i *)&buffer[i], TransformBytes(x, bitDepth, invertMask));
+		}
+	}
+
+	if (toTiles) {
+		memcpy(tiles, buffer, tileSize);
+	} else {
+		for (int j = 0; j < 8; j++)
+			memcpy(image + j * pitch, &buffer[j * bitDepth], bitDepth);
+	}
+}
+
+static void ConvertRunSse2(struct TileRun *run, int bitDepth, int pitch, bool toTiles, bool invertColors)
+{
+	int groupTiles = (bitDepth == 1) ? 8 : 16 / bitDepth;
+	__m128i invertMask = _mm_set1_epi8(invertColors ? (char)0xFF : 0);
+	unsigned char *image = run->image;
+	unsigned char *tiles = run->tiles;
+	int i = 0;
+
+	for (; i + groupTiles <= run->numTiles; i += groupTiles) {
+		ConvertGroupSse2(image, tiles, bitDepth, pitch, toTiles, invertMask);
+		image += groupTiles * bitDepth;
+		tiles += groupTiles * bitDepth * 8;
+	}
+
+	for (; i < run->numTiles; i++) {
+		ConvertTileSse2(image, tiles, bitDepth, pitch, toTiles, invertMask);
+		image += bitDepth;
+		tiles += bitDepth * 8;
+	}
+}
+
+#endif // HAVE_SSE2
+
+// Visits the tiles in tile data order. Within a metatile the tiles go left
+// to right, then top to bottom, so each row of tiles within a metatile is
+// side by side in the image and can be converted as one run.
+static void ConvertTiles(unsigned char *image, unsigned char *tiles, int numTiles, int bitDepth, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors, bool toTiles, enum TileKernel kernel)
+{
+	if (bitDepth != 1 && bitDepth != 4 && bitDepth != 8)
+		FATAL_ERROR("Invalid bit depth %d.\n", bitDepth);
+
+	int pitch = metatilesWide * metatileWidth * bitDepth;
+
+	// With metatiles one tile high, a whole row of metatiles is one run.
+	if (metatileHeight == 1) {
+		metatileWidth *= metatilesWide;
+		metatilesWide = 1;
+	}
+
+	unsigned char table[256];
+
+	BuildByteTable(table, bitDepth, invertColors);
+
+#ifndef HAVE_SSE2
+	(void)kernel;
+#endif
+
+	for (int metatileY = 0; numTiles > 0; metatileY++) {
+		for (int metatileX = 0; metatileX < metatilesWide && numTiles > 0; metatileX++) {
+			for (int subTileY = 0; subTileY < metatileHeight && numTiles > 0; subTileY++) {
+				int tileY = metatileY * metatileHeight + subTileY;
+				int tileX = metatileX * metatileWidth;
+				struct TileRun run;
+
+				run.image = image + tileY * 8 * pitch + tileX * bitDepth;
+				run.tiles = tiles;
+				run.numTiles = (numTiles < metatileWidth) ? numTiles : metatileWidth;
+
+#ifdef HAVE_SSE2
+				if (kernel == TILE_KERNEL_BEST)
+					ConvertRunSse2(&run, bitDepth, pitch, toTiles, invertColors);
+				else
+#endif
+					ConvertRunScalar(&run, bitDepth, pitch, toTiles, table);
+
+				tiles += run.numTiles * bitDepth * 8;
+				numTiles -= run.numTiles;
+			}
+		}
+	}
+}
+
+void ConvertToTiles(unsigned char *src, unsigned char *dest, int numTiles, int bitDepth, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors, enum TileKernel kernel)
+{
+	ConvertTiles(src, dest, numTiles, bitDepth, metatilesWide, metatileWidth, metatileHeight, invertColors, true, kernel);
+}
+
+void ConvertFromTiles(unsigned char *src, unsigned char *dest, int numTiles, int bitDepth, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors, enum TileKernel kernel)
+{
+	ConvertTiles(dest, src, numTiles, bitDepth, metatilesWide, metatileWidth, metatileHeight, invertColors, false, kernel);
+}
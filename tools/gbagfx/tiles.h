@@ -0,0 +1,20 @@
+// Copyright (c) 2015 YamaArashi
+
+#ifndef TILES_H
+#define TILES_H
+
+#include <stdbool.h>
+
+enum TileKernel
+{
+	TILE_KERNEL_BEST,   // SIMD where available
+	TILE_KERNEL_SCALAR, // portable code only
+};
+
+// Converts between a linear image with the given bit depth (1, 4 or 8) and
+// GBA tile data, laying the tiles out as metatiles of metatileWidth by
+// metatileHeight tiles. The image is metatilesWide metatiles wide.
+void ConvertToTiles(unsigned char *src, unsigned char *dest, int numTiles, int bitDepth, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors, enum TileKernel kernel);
+void ConvertFromTiles(unsigned char *src, unsigned char *dest, int numTiles, int bitDepth, int metatilesWide, int metatileWidth, int metatileHeight, bool invertColors, enum TileKernel kernel);
+
+#endif // TILES_H
@@ -9,6 +9,8 @@
 #include "global.h"
 #include "util.h"
 
+bool gWriteOnlyIfChanged;
+
 bool ParseNumber(char *s, char **end, int radix, int *intValue)
 {
 	char *localEnd;
@@ -109,7 +111,7 @@ unsigned char *ReadWholeFileZeroPadded(char *path, int *size, int padAmount)
 
 	rewind(fp);
 
-	if (fread(buffer, *size, 1, fp) != 1)
+	if (*size > 0 && fread(buffer, *size, 1, fp) != 1)
 		FATAL_ERROR("Failed to read \"%s\".\n", path);
 
 	fclose(fp);
@@ -117,15 +119,77 @@ unsigned char *ReadWholeFileZeroPadded(char *path, int *size, int padAmount)
 	return buffer;
 }
 
+static bool FileHasContents(char *path, void *buffer, int bufferSize)
+{
+	FILE *fp = fopen(path, "rb");
+
+	if (fp == NULL)
+		return false;
+
+	fseek(fp, 0, SEEK_END);
+
+	bool same = ftell(fp) == bufferSize;
+
+	if (same && bufferSize > 0) {
+		unsigned char *contents = malloc(bufferSize);
+
+		rewind(fp);
+
+		same = contents != NULL
+		    && fread(contents, bufferSize, 1, fp) == 1
+		    && memcmp(contents, buffer, bufferSize) == 0;
+
+		free(contents);
+	}
+
+	fclose(fp);
+
+	return same;
+}
+
 void WriteWholeFile(char *path, void *buffer, int bufferSize)
 {
-	FILE *fp = fopen(path, "wb");
+	// Leave the file and its timestamp alone if it wouldn't change.
+	if (gWriteOnlyIfChanged && FileHasContents(path, buffer, bufferSize))
+		return;
+
+	// Write to a temporary file and rename it into place, so that an exit
+	// part way through (e.g. another manifest job failing) never leaves a
+	// truncated output that looks newer than its input.
+	size_t pathLength = strlen(path);
+	char *tempPath = malloc(pathLength + 5);
+
+	if (tempPath == NULL)
+		FATAL_ERROR("Failed to allocate memory for writing \"%s\".\n", path);
+
+	memcpy(tempPath, path, pathLength);
+	memcpy(tempPath + pathLength, ".tmp", 5);
+
+	FILE *fp = fopen(tempPath, "wb");
 
 	if (fp == NULL)
-		FATAL_ERROR("Failed to open \"%s\" for writing.\n", path);
+		FATAL_ERROR("Failed to open \"%s\" for writing.\n", tempPath);
 
-	if (fwrite(buffer, bufferSize, 1, fp) != 1)
+	if (bufferSize > 0 && fwrite(buffer, bufferSize, 1, fp) != 1) {
+		fclose(fp);
+		remove(tempPath);
 		FATAL_ERROR("Failed to write to \"%s\".\n", path);
+	}
 
-	fclose(fp);
+	if (fclose(fp) != 0) {
+		remove(tempPath);
+		FATAL_ERROR("Failed to write to \"%s\".\n", path);
+	}
+
+#ifdef _WIN32
+	// rename() won't replace an existing file on Windows.
+	remove(path);
+#endif
+
+	if (rename(tempPath, path) != 0) {
+		remove(tempPath);
+		FATAL_ERROR("Failed to rename \"%s\" to \"%s\".\n", tempPath, path);
+	}
+
+	free(tempPath);
 }
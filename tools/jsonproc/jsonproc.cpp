@@ -7,36 +7,44 @@
 #include <string>
 using std::string; using std::to_string;
 
+#include <vector>
+using std::vector;
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+
 #include <inja.hpp>
 using namespace inja;
 using json = nlohmann::json;
 
-std::map<string, string> customVars;
+// One output to render. The callbacks read the job being rendered on their
+// thread, so that one Environment can serve every job.
+struct Job
+{
+    string jsonFilepath;
+    string templateFilepath;
+    string outputFilepath;
+    std::map<string, string> customVars;
+};
+
+thread_local Job *currentJob;
 
 void set_custom_var(string key, string value)
 {
-    customVars[key] = value;
+    currentJob->customVars[key] = value;
 }
 
 string get_custom_var(string key)
 {
-    return customVars[key];
+    return currentJob->customVars[key];
 }
 
-int main(int argc, char *argv[])
+void add_callbacks(Environment &env)
 {
-    if (argc != 4)
-        FATAL_ERROR("USAGE: jsonproc <json-filepath> <template-filepath> <output-filepath>\n");
-
-    string jsonfilepath = argv[1];
-    string templateFilepath = argv[2];
-    string outputFilepath = argv[3];
-
-    Environment env;
-
-    // Add custom command callbacks.
-    env.add_callback("doNotModifyHeader", 0, [jsonfilepath, templateFilepath](Arguments& args) {
-        return "//\n// DO NOT MODIFY THIS FILE! It is auto-generated from " + jsonfilepath +" and Inja template " + templateFilepath + "\n//\n";
+    env.add_callback("doNotModifyHeader", 0, [](Arguments& args) {
+        return "//\n// DO NOT MODIFY THIS FILE! It is auto-generated from " + currentJob->jsonFilepath +" and Inja template " + currentJob->templateFilepath + "\n//\n";
     });
 
     env.add_callback("contains", 2, [](Arguments& args) {
@@ -53,21 +61,21 @@ int main(int argc, char *argv[])
         return minuend - subtrahend;
     });
 
-    env.add_callback("setVar", 2, [=](Arguments& args) {
+    env.add_callback("setVar", 2, [](Arguments& args) {
         string key = args.at(0)->get<string>();
         string value = args.at(1)->get<string>();
         set_custom_var(key, value);
         return "";
     });
 
-    env.add_callback("setVarInt", 2, [=](Arguments& args) {
+    env.add_callback("setVarInt", 2, [](Arguments& args) {
         string key = args.at(0)->get<string>();
         string value = to_string(args.at(1)->get<int>());
         set_custom_var(key, value);
         return "";
     });
 
-    env.add_callback("getVar", 1, [=](Arguments& args) {
+    env.add_callback("getVar", 1, [](Arguments& args) {
         string key = args.at(0)->get<string>();
         return get_custom_var(key);
     });
@@ -102,15 +110,126 @@ int main(int argc, char *argv[])
     env.add_callback("isEmpty", 1, [](Arguments& args) {
         return args.at(0)->empty();
     });
+}
+
+// Writes the text unless the file already holds it, so that an unchanged
+// output keeps its timestamp and doesn't trigger rebuilds.
+void write_if_changed(const string &filepath, const string &text)
+{
+    std::ifstream inFile(filepath, std::ifstream::binary);
+
+    if (inFile.is_open())
+    {
+        std::ostringstream existing;
+        existing << inFile.rdbuf();
+        if (existing.str() == text)
+            return;
+        inFile.close();
+    }
+
+    std::ofstream outFile(filepath, std::ofstream::binary);
+
+    if (!outFile.is_open())
+        FATAL_ERROR("JSONPROC_ERROR: Cannot open file %s for writing.\n", filepath.c_str());
+
+    outFile << text;
+}
+
+// Renders every job. Each distinct template and JSON file is parsed once up
+// front, and then the outputs are rendered on numThreads threads.
+void process_jobs(vector<Job> &jobs, unsigned numThreads)
+{
+    Environment env;
+    std::map<string, Template> templates;
+    std::map<string, json> jsonData;
+
+    add_callbacks(env);
 
     try
     {
-        env.write_with_json_file(templateFilepath, jsonfilepath, outputFilepath);
+        for (Job &job : jobs)
+        {
+            if (templates.find(job.templateFilepath) == templates.end())
+                templates[job.templateFilepath] = env.parse_template(job.templateFilepath);
+            if (jsonData.find(job.jsonFilepath) == jsonData.end())
+                jsonData[job.jsonFilepath] = env.load_json(job.jsonFilepath);
+        }
     }
     catch (const std::exception& e)
     {
         FATAL_ERROR("JSONPROC_ERROR: %s\n", e.what());
     }
 
+    std::atomic<size_t> nextJob(0);
+
+    auto worker = [&]() {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+        {
+            currentJob = &jobs[i];
+
+            try
+            {
+                string text = env.render(templates.at(currentJob->templateFilepath), jsonData.at(currentJob->jsonFilepath));
+                write_if_changed(currentJob->outputFilepath, text);
+            }
+            catch (const std::exception& e)
+            {
+                FATAL_ERROR("JSONPROC_ERROR: %s\n", e.what());
+            }
+        }
+    };
+
+    if (numThreads > jobs.size())
+        numThreads = jobs.size();
+
+    vector<std::thread> threads;
+    for (unsigned i = 1; i < numThreads; i++)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (std::thread &t : threads)
+        t.join();
+}
+
+int main(int argc, char *argv[])
+{
+    vector<Job> jobs;
+    unsigned numThreads = 1;
+
+    if (argc >= 2 && string(argv[1]) == "--batch")
+    {
+        int arg = 2;
+
+        numThreads = std::thread::hardware_concurrency();
+
+        if (arg + 1 < argc && string(argv[arg]) == "-j")
+        {
+            int count = std::atoi(argv[arg + 1]);
+            if (count < 1)
+                FATAL_ERROR("JSONPROC_ERROR: -j needs a positive thread count.\n");
+            numThreads = count;
+            arg += 2;
+        }
+
+        if (argc == arg || (argc - arg) % 3 != 0)
+            FATAL_ERROR("USAGE: jsonproc --batch [-j THREADS] <json-filepath> <template-filepath> <output-filepath>...\n");
+
+        for (; arg < argc; arg += 3)
+            jobs.push_back(Job{argv[arg], argv[arg + 1], argv[arg + 2], {}});
+
+        if (numThreads < 1)
+            numThreads = 1;
+    }
+    else
+    {
+        if (argc != 4)
+            FATAL_ERROR("USAGE: jsonproc <json-filepath> <template-filepath> <output-filepath>\n");
+
+        jobs.push_back(Job{argv[1], argv[2], argv[3], {}});
+    }
+
+    process_jobs(jobs, numThreads);
+
     return 0;
 }
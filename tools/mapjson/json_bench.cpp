@@ -0,0 +1,180 @@
+// json_bench.cpp
+//
+// Compares json11 with the JsonDocument parser that mapjson uses, e.g.
+//     mapjson-bench ../../data/layouts/layouts.json ../../data/maps/*/map.json
+//
+// Each pass parses every file and reads every value in it, once per parser.
+// Before timing, it checks that both parsers see the same values.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json11.h"
+#include "json_view.h"
+#include "mapjson.h"
+
+using std::string;
+
+static string read_text_file(const string &filepath) {
+    std::ifstream in_file(filepath, std::ifstream::binary);
+
+    if (!in_file.is_open())
+        FATAL_ERROR("Cannot open file %s for reading.\n", filepath.c_str());
+
+    std::ostringstream text;
+    text << in_file.rdbuf();
+    return text.str();
+}
+
+// Writes a value in a form that doesn't depend on the parser. Object keys
+// are sorted, since json11 keeps them in a std::map.
+static void dump(const json11::Json &value, std::ostream &out) {
+    switch (value.type()) {
+    case json11::Json::NUL: out << "null"; break;
+    case json11::Json::BOOL: out << (value.bool_value() ? "true" : "false"); break;
+    case json11::Json::NUMBER: out << value.int_value(); break;
+    case json11::Json::STRING: out << '"' << value.string_value() << '"'; break;
+    case json11::Json::ARRAY:
+        out << '[';
+        for (auto &item : value.array_items()) {
+            dump(item, out);
+            out << ',';
+        }
+        out << ']';
+        break;
+    case json11::Json::OBJECT:
+        out << '{';
+        for (auto &item : value.object_items()) {
+            out << '"' << item.first << "\":";
+            dump(item.second, out);
+            out << ',';
+        }
+        out << '}';
+        break;
+    }
+}
+
+static void dump(JsonView value, std::ostream &out) {
+    switch (value.type()) {
+    case JsonView::NUL: out << "null"; break;
+    case JsonView::BOOL: out << (value.bool_value() ? "true" : "false"); break;
+    case JsonView::NUMBER: out << value.int_value(); break;
+    case JsonView::STRING: out << '"' << value.string_value() << '"'; break;
+    case JsonView::ARRAY:
+        out << '[';
+        for (auto item : value.array_items()) {
+            dump(item, out);
+            out << ',';
+        }
+        out << ']';
+        break;
+    case JsonView::OBJECT: {
+        std::map<string, JsonView> sorted;
+        for (auto &item : value.object_items())
+            sorted[item.first.str()] = item.second;
+        out << '{';
+        for (auto &item : sorted) {
+            out << '"' << item.first << "\":";
+            dump(item.second, out);
+            out << ',';
+        }
+        out << '}';
+        break;
+    }
+    }
+}
+
+// Reads every value the way mapjson does, so that neither parser can skip
+// work. Returns a checksum to keep the compiler from dropping it.
+static size_t walk(const json11::Json &value) {
+    size_t sum = value.string_value().size() + value.int_value() + value.bool_value();
+    for (auto &item : value.array_items())
+        sum += walk(item);
+    for (auto &item : value.object_items())
+        sum += walk(value[item.first]);
+    return sum;
+}
+
+static size_t walk(JsonView value) {
+    size_t sum = value.string_value().size() + value.int_value() + value.bool_value();
+    for (auto item : value.array_items())
+        sum += walk(item);
+    for (auto &item : value.object_items())
+        sum += walk(value[item.first]);
+    return sum;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int passes = 10;
+    int arg = 1;
+
+    if (arg + 1 < argc && string(argv[arg]) == "-n") {
+        passes = std::atoi(argv[arg + 1]);
+        arg += 2;
+    }
+
+    if (arg >= argc || passes < 1)
+        FATAL_ERROR("USAGE: mapjson-bench [-n PASSES] <json_file>...\n");
+
+    std::vector<string> filepaths(argv + arg, argv + argc);
+    size_t total_bytes = 0;
+
+    for (const string &filepath : filepaths) {
+        string err;
+        json11::Json old_value = json11::Json::parse(read_text_file(filepath), err);
+        if (old_value == json11::Json())
+            FATAL_ERROR("%s: %s\n", filepath.c_str(), err.c_str());
+
+        JsonDocument doc(filepath);
+        std::ostringstream old_dump, new_dump;
+        dump(old_value, old_dump);
+        dump(doc.root(), new_dump);
+
+        if (old_dump.str() != new_dump.str())
+            FATAL_ERROR("%s: the parsers disagree.\n", filepath.c_str());
+
+        total_bytes += read_text_file(filepath).size();
+    }
+
+    size_t checksums[2] = { 0, 0 };
+    double times[2];
+
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (const string &filepath : filepaths) {
+            string err;
+            checksums[0] += walk(json11::Json::parse(read_text_file(filepath), err));
+        }
+    }
+    times[0] = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (const string &filepath : filepaths) {
+            JsonDocument doc(filepath);
+            checksums[1] += walk(doc.root());
+        }
+    }
+    times[1] = seconds_since(start);
+
+    if (checksums[0] != checksums[1])
+        FATAL_ERROR("The parsers read different values.\n");
+
+    double megabytes = total_bytes * passes / (1024.0 * 1024.0);
+
+    std::cout << filepaths.size() << " files, " << total_bytes << " bytes, " << passes << " passes\n";
+    std::cout << "json11        " << times[0] << " s  " << megabytes / times[0] << " MiB/s\n";
+    std::cout << "JsonDocument  " << times[1] << " s  " << megabytes / times[1] << " MiB/s\n";
+
+    return 0;
+}
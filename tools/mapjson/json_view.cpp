@@ -0,0 +1,474 @@
+// json_view.cpp
+
+#include <cstdlib>
+#include <climits>
+#include <string>
+using std::string;
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "json_view.h"
+#include "mapjson.h"
+
+static const int max_depth = 200;
+
+class JsonParser {
+public:
+    JsonParser(JsonDocument &doc)
+        : m_doc(doc), m_start(doc.m_buffer), m_pos(doc.m_buffer), m_end(doc.m_buffer + doc.m_length) {}
+
+    void parse() {
+        parse_value(0);
+        skip_whitespace();
+        if (m_pos != m_end)
+            fail("unexpected trailing " + describe_next());
+    }
+
+private:
+    JsonDocument &m_doc;
+    char *m_start;
+    char *m_pos;
+    char *m_end;
+
+    [[noreturn]] void fail(const string &message) {
+        int line = 1;
+        for (const char *p = m_start; p < m_pos && p < m_end; p++)
+            if (*p == '\n')
+                line++;
+        FATAL_ERROR("%s:%d: %s\n", m_doc.m_filepath.c_str(), line, message.c_str());
+    }
+
+    string describe_next() {
+        if (m_pos >= m_end)
+            return "end of input";
+        return string("'") + *m_pos + "'";
+    }
+
+    void skip_whitespace() {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t'))
+            m_pos++;
+    }
+
+    bool next_is(char c) {
+        return m_pos < m_end && *m_pos == c;
+    }
+
+    void expect(char c, const char *context) {
+        skip_whitespace();
+        if (!next_is(c))
+            fail(string("expected '") + c + "' in " + context + ", got " + describe_next());
+        m_pos++;
+    }
+
+    uint32_t add_entry(JsonView::Type type, const char *data, uint32_t size) {
+        JsonDocument::Entry entry;
+        entry.type = type;
+        entry.next = m_doc.m_tape.size() + 1;
+        entry.size = size;
+        entry.data = data;
+        m_doc.m_tape.push_back(entry);
+        return m_doc.m_tape.size() - 1;
+    }
+
+    void parse_value(int depth) {
+        if (depth > max_depth)
+            fail("exceeded maximum nesting depth");
+
+        skip_whitespace();
+
+        if (m_pos >= m_end)
+            fail("unexpected end of input");
+
+        char c = *m_pos;
+
+        if (c == '{')
+            parse_object(depth);
+        else if (c == '[')
+            parse_array(depth);
+        else if (c == '"')
+            parse_string();
+        else if (c == '-' || (c >= '0' && c <= '9'))
+            parse_number();
+        else if (match_literal("true"))
+            add_entry(JsonView::BOOL, m_pos - 4, 1);
+        else if (match_literal("false"))
+            add_entry(JsonView::BOOL, nullptr, 0);
+        else if (match_literal("null"))
+            add_entry(JsonView::NUL, nullptr, 0);
+        else
+            fail("expected value, got " + describe_next());
+    }
+
+    bool match_literal(const char *literal) {
+        size_t length = std::strlen(literal);
+        if (static_cast<size_t>(m_end - m_pos) < length || std::memcmp(m_pos, literal, length) != 0)
+            return false;
+        m_pos += length;
+        return true;
+    }
+
+    void parse_object(int depth) {
+        uint32_t index = add_entry(JsonView::OBJECT, nullptr, 0);
+        uint32_t count = 0;
+
+        m_pos++;
+        skip_whitespace();
+
+        if (next_is('}')) {
+            m_pos++;
+        } else {
+            for (;;) {
+                skip_whitespace();
+                if (!next_is('"'))
+                    fail("expected '\"' in object, got " + describe_next());
+                parse_string();
+                expect(':', "object");
+                parse_value(depth + 1);
+                count++;
+
+                skip_whitespace();
+                if (next_is('}')) {
+                    m_pos++;
+                    break;
+                }
+                if (!next_is(','))
+                    fail("expected ',' in object, got " + describe_next());
+                m_pos++;
+            }
+        }
+
+        m_doc.m_tape[index].size = count;
+        m_doc.m_tape[index].next = m_doc.m_tape.size();
+    }
+
+    void parse_array(int depth) {
+        uint32_t index = add_entry(JsonView::ARRAY, nullptr, 0);
+        uint32_t count = 0;
+
+        m_pos++;
+        skip_whitespace();
+
+        if (next_is(']')) {
+            m_pos++;
+        } else {
+            for (;;) {
+                parse_value(depth + 1);
+                count++;
+
+                skip_whitespace();
+                if (next_is(']')) {
+                    m_pos++;
+                    break;
+                }
+                if (!next_is(','))
+                    fail("expected ',' in list, got " + describe_next());
+                m_pos++;
+            }
+        }
+
+        m_doc.m_tape[index].size = count;
+        m_doc.m_tape[index].next = m_doc.m_tape.size();
+    }
+
+    long parse_hex4() {
+        if (m_end - m_pos < 4)
+            fail("bad \\u escape");
+
+        long value = 0;
+
+        for (int i = 0; i < 4; i++) {
+            char c = *m_pos++;
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                fail("bad \\u escape");
+        }
+
+        return value;
+    }
+
+    static char *encode_utf8(long pt, char *out) {
+        if (pt < 0x80) {
+            *out++ = pt;
+        } else if (pt < 0x800) {
+            *out++ = (pt >> 6) | 0xC0;
+            *out++ = (pt & 0x3F) | 0x80;
+        } else if (pt < 0x10000) {
+            *out++ = (pt >> 12) | 0xE0;
+            *out++ = ((pt >> 6) & 0x3F) | 0x80;
+            *out++ = (pt & 0x3F) | 0x80;
+        } else {
+            *out++ = (pt >> 18) | 0xF0;
+            *out++ = ((pt >> 12) & 0x3F) | 0x80;
+            *out++ = ((pt >> 6) & 0x3F) | 0x80;
+            *out++ = (pt & 0x3F) | 0x80;
+        }
+        return out;
+    }
+
+    // Escapes never decode to more bytes than they take up, so the decoded
+    // string is written over the original.
+    void parse_string() {
+        char *start = ++m_pos;
+        char *out = start;
+
+        for (;;) {
+            if (m_pos >= m_end)
+                fail("unexpected end of input in string");
+
+            char c = *m_pos++;
+
+            if (c == '"')
+                break;
+
+            if (static_cast<unsigned char>(c) < 0x20)
+                fail("unescaped control character in string");
+
+            if (c != '\\') {
+                *out++ = c;
+                continue;
+            }
+
+            if (m_pos >= m_end)
+                fail("unexpected end of input in string");
+
+            c = *m_pos++;
+
+            switch (c) {
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case '"': case '\\': case '/': *out++ = c; break;
+            case 'u': {
+                long pt = parse_hex4();
+                // Join a surrogate pair into one code point. Unpaired
+                // surrogates are encoded on their own, like json11 does.
+                if (pt >= 0xD800 && pt <= 0xDBFF && m_end - m_pos >= 6 && m_pos[0] == '\\' && m_pos[1] == 'u') {
+                    char *saved = m_pos;
+                    m_pos += 2;
+                    long low = parse_hex4();
+                    if (low >= 0xDC00 && low <= 0xDFFF)
+                        pt = (((pt - 0xD800) << 10) | (low - 0xDC00)) + 0x10000;
+                    else
+                        m_pos = saved;
+                }
+                out = encode_utf8(pt, out);
+                break;
+            }
+            default:
+                fail(string("invalid escape character '") + c + "'");
+            }
+        }
+
+        add_entry(JsonView::STRING, start, out - start);
+    }
+
+    void parse_number() {
+        char *start = m_pos;
+
+        if (next_is('-'))
+            m_pos++;
+
+        if (next_is('0')) {
+            m_pos++;
+            if (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9')
+                fail("leading 0s not permitted in numbers");
+        } else if (m_pos < m_end && *m_pos >= '1' && *m_pos <= '9') {
+            while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9')
+                m_pos++;
+        } else {
+            fail("invalid " + describe_next() + " in number");
+        }
+
+        if (next_is('.')) {
+            m_pos++;
+            if (!(m_pos < m_end && *m_pos >= '0' && *m_pos <= '9'))
+                fail("at least one digit required in fractional part");
+            while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9')
+                m_pos++;
+        }
+
+        if (next_is('e') || next_is('E')) {
+            m_pos++;
+            if (next_is('+') || next_is('-'))
+                m_pos++;
+            if (!(m_pos < m_end && *m_pos >= '0' && *m_pos <= '9'))
+                fail("at least one digit required in exponent");
+            while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9')
+                m_pos++;
+        }
+
+        add_entry(JsonView::NUMBER, start, m_pos - start);
+    }
+};
+
+JsonDocument::JsonDocument(const string &filepath)
+    : m_filepath(filepath), m_buffer(nullptr), m_length(0), m_mapped(false) {
+#ifdef _WIN32
+    std::ifstream in_file(filepath, std::ifstream::binary);
+
+    if (!in_file.is_open())
+        FATAL_ERROR("Cannot open file %s for reading.\n", filepath.c_str());
+
+    in_file.seekg(0, std::ios::end);
+    m_length = in_file.tellg();
+    m_buffer = new char[m_length + 1];
+    in_file.seekg(0, std::ios::beg);
+    in_file.read(m_buffer, m_length);
+#else
+    int fd = open(filepath.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        FATAL_ERROR("Cannot open file %s for reading.\n", filepath.c_str());
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0)
+        FATAL_ERROR("Cannot read file %s.\n", filepath.c_str());
+
+    m_length = st.st_size;
+
+    // A private writable mapping lets strings be unescaped in place without
+    // touching the file.
+    if (m_length > 0) {
+        void *mapping = mmap(nullptr, m_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED)
+            FATAL_ERROR("Cannot map file %s.\n", filepath.c_str());
+
+        m_buffer = static_cast<char *>(mapping);
+        m_mapped = true;
+    }
+
+    close(fd);
+#endif
+
+    // Most files need about one tape entry per 12 bytes.
+    m_tape.reserve(m_length / 12 + 16);
+
+    JsonParser(*this).parse();
+}
+
+JsonDocument::~JsonDocument() {
+#ifdef _WIN32
+    delete[] m_buffer;
+#else
+    if (m_mapped)
+        munmap(m_buffer, m_length);
+#endif
+}
+
+JsonView::Iterator &JsonView::Iterator::operator++() {
+    m_index = m_doc->m_tape[m_index].next;
+    return *this;
+}
+
+JsonView::Type JsonView::type() const {
+    if (m_doc == nullptr)
+        return NUL;
+    return static_cast<Type>(m_doc->m_tape[m_index].type);
+}
+
+StringView JsonView::string_value() const {
+    if (type() != STRING)
+        return StringView();
+
+    const JsonDocument::Entry &entry = m_doc->m_tape[m_index];
+    return StringView(entry.data, entry.size);
+}
+
+int JsonView::int_value() const {
+    if (type() != NUMBER)
+        return 0;
+
+    const JsonDocument::Entry &entry = m_doc->m_tape[m_index];
+    char text[64];
+
+    if (entry.size >= sizeof(text))
+        return static_cast<int>(std::strtod(string(entry.data, entry.size).c_str(), nullptr));
+
+    std::memcpy(text, entry.data, entry.size);
+    text[entry.size] = '\0';
+
+    // Short integers are parsed exactly and anything else as a double, as
+    // json11 does.
+    if (std::strpbrk(text, ".eE") == nullptr && entry.size <= 9)
+        return std::atoi(text);
+
+    return static_cast<int>(std::strtod(text, nullptr));
+}
+
+bool JsonView::bool_value() const {
+    return type() == BOOL && m_doc->m_tape[m_index].data != nullptr;
+}
+
+bool JsonView::is_empty_object() const {
+    return type() == OBJECT && m_doc->m_tape[m_index].size == 0;
+}
+
+size_t JsonView::size() const {
+    return type() == ARRAY ? m_doc->m_tape[m_index].size : 0;
+}
+
+JsonView::Items JsonView::array_items() const {
+    if (type() != ARRAY)
+        return Items(Iterator(nullptr, 0), Iterator(nullptr, 0));
+
+    return Items(Iterator(m_doc, m_index + 1), Iterator(m_doc, m_doc->m_tape[m_index].next));
+}
+
+std::vector<std::pair<StringView, JsonView>> JsonView::object_items() const {
+    std::vector<std::pair<StringView, JsonView>> items;
+
+    if (type() != OBJECT)
+        return items;
+
+    const std::vector<JsonDocument::Entry> &tape = m_doc->m_tape;
+
+    for (uint32_t i = m_index + 1; i < tape[m_index].next; i = tape[i + 1].next)
+        items.emplace_back(StringView(tape[i].data, tape[i].size), JsonView(m_doc, i + 1));
+
+    return items;
+}
+
+// Returns the tape index of the key's value, or 0 if there isn't one. If a
+// key appears more than once the last value wins, as in json11.
+uint32_t JsonView::find(StringView key) const {
+    if (type() != OBJECT)
+        return 0;
+
+    const std::vector<JsonDocument::Entry> &tape = m_doc->m_tape;
+    uint32_t end = tape[m_index].next;
+    uint32_t found = 0;
+
+    for (uint32_t i = m_index + 1; i < end; i = tape[i + 1].next) {
+        if (tape[i].size == key.size() && std::memcmp(tape[i].data, key.data(), key.size()) == 0)
+            found = i + 1;
+    }
+
+    return found;
+}
+
+JsonView JsonView::operator[](const char *key) const {
+    uint32_t index = find(key);
+    return index != 0 ? JsonView(m_doc, index) : JsonView();
+}
+
+JsonView JsonView::operator[](StringView key) const {
+    uint32_t index = find(key);
+    return index != 0 ? JsonView(m_doc, index) : JsonView();
+}
@@ -0,0 +1,143 @@
+// json_view.h
+
+#ifndef JSON_VIEW_H
+#define JSON_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A string that points into a JsonDocument's buffer rather than owning a
+// copy of its characters.
+class StringView {
+public:
+    StringView() : m_data(""), m_size(0) {}
+    StringView(const char *data, size_t size) : m_data(data), m_size(size) {}
+
+    const char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    std::string str() const { return std::string(m_data, m_size); }
+
+    bool operator==(StringView other) const {
+        return m_size == other.m_size && std::memcmp(m_data, other.m_data, m_size) == 0;
+    }
+    bool operator==(const char *s) const {
+        return std::strlen(s) == m_size && std::memcmp(m_data, s, m_size) == 0;
+    }
+    bool operator==(const std::string &s) const { return *this == StringView(s.data(), s.size()); }
+    template <typename T> bool operator!=(const T &other) const { return !(*this == other); }
+
+private:
+    const char *m_data;
+    size_t m_size;
+};
+
+inline std::ostream &operator<<(std::ostream &out, StringView s) {
+    return out.write(s.data(), s.size());
+}
+
+inline std::string operator+(StringView a, const char *b) { return a.str() + b; }
+
+class JsonDocument;
+
+// One value in a JsonDocument. Looking up a missing key or reading a value
+// as the wrong type gives null, "", 0 or false, as with json11.
+class JsonView {
+public:
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+    class Iterator {
+    public:
+        Iterator(const JsonDocument *doc, uint32_t index) : m_doc(doc), m_index(index) {}
+        JsonView operator*() const { return JsonView(m_doc, m_index); }
+        Iterator &operator++();
+        bool operator!=(const Iterator &other) const { return m_index != other.m_index; }
+
+    private:
+        const JsonDocument *m_doc;
+        uint32_t m_index;
+    };
+
+    // Iterates over the elements of an array.
+    class Items {
+    public:
+        Items(Iterator begin, Iterator end) : m_begin(begin), m_end(end) {}
+        Iterator begin() const { return m_begin; }
+        Iterator end() const { return m_end; }
+
+    private:
+        Iterator m_begin, m_end;
+    };
+
+    JsonView() : m_doc(nullptr), m_index(0) {}
+    JsonView(const JsonDocument *doc, uint32_t index) : m_doc(doc), m_index(index) {}
+
+    Type type() const;
+    bool is_null() const { return type() == NUL; }
+    bool is_empty_object() const;
+
+    StringView string_value() const;
+    int int_value() const;
+    bool bool_value() const;
+
+    // Number of elements in an array.
+    size_t size() const;
+    Items array_items() const;
+
+    // Whether an object has the key, even if its value is null.
+    bool has(const char *key) const { return find(key) != 0; }
+    std::vector<std::pair<StringView, JsonView>> object_items() const;
+    JsonView operator[](const char *key) const;
+    JsonView operator[](StringView key) const;
+    JsonView operator[](const std::string &key) const { return (*this)[StringView(key.data(), key.size())]; }
+
+    bool operator==(const char *s) const { return type() == STRING && string_value() == s; }
+
+private:
+    const JsonDocument *m_doc; // null for values that don't exist
+    uint32_t m_index;
+
+    uint32_t find(StringView key) const;
+    uint32_t find(const char *key) const { return find(StringView(key, std::strlen(key))); }
+};
+
+// A parsed JSON file. The file is mapped into memory and strings are
+// unescaped in place, so values refer straight into it. Instead of a tree of
+// allocated nodes, the parser records a flat tape with one entry per value,
+// in document order. Object members appear as a key entry followed by the
+// value's entries, and every entry knows where the next sibling starts, so
+// lookups skip whole subtrees at once.
+class JsonDocument {
+public:
+    // Exits with an error if the file can't be read or isn't valid JSON.
+    explicit JsonDocument(const std::string &filepath);
+    ~JsonDocument();
+    JsonDocument(const JsonDocument &) = delete;
+    JsonDocument &operator=(const JsonDocument &) = delete;
+
+    JsonView root() const { return JsonView(this, 0); }
+
+private:
+    friend class JsonView;
+    friend class JsonParser;
+
+    struct Entry {
+        uint8_t type;
+        uint32_t next;     // index of the entry after this value's subtree
+        uint32_t size;     // length of a string or number, or count of children
+        const char *data;  // start of a string or number; for bools, non-null if true
+    };
+
+    std::string m_filepath;
+    char *m_buffer;
+    size_t m_length;
+    bool m_mapped;
+    std::vector<Entry> m_tape;
+};
+
+#endif // JSON_VIEW_H
@@ -15,6 +15,15 @@ using std::sort; using std::find;
 #include <map>
 using std::map;
 
+#include <unordered_map>
+using std::unordered_map;
+
+#include <thread>
+using std::thread;
+
+#include <atomic>
+using std::atomic;
+
 #include <fstream>
 using std::ofstream; using std::ifstream;
 
@@ -24,33 +33,49 @@ using std::ostringstream;
 #include <limits>
 using std::numeric_limits;
 
-#include "json11.h"
-using json11::Json;
+#include "json_view.h"
 
 #include "mapjson.h"
 
 string version;
 
-string read_text_file(string filepath) {
-    ifstream in_file(filepath);
+// Layouts from layouts.json by id. Ids that more than one layout uses map to
+// null, so that looking them up fails like a missing id does.
+typedef unordered_map<string, JsonView> LayoutIndex;
 
-    if (!in_file.is_open())
-        FATAL_ERROR("Cannot open file %s for reading.\n", filepath.c_str());
+// Outputs that write_text_file rewrote or left alone, for --stats.
+atomic<int> files_written(0);
+atomic<int> files_unchanged(0);
+
+bool file_has_contents(string filepath, const string &text) {
+    ifstream in_file(filepath, std::ifstream::binary);
 
-    string text;
+    if (!in_file.is_open())
+        return false;
 
     in_file.seekg(0, std::ios::end);
-    text.resize(in_file.tellg());
 
-    in_file.seekg(0, std::ios::beg);
-    in_file.read(&text[0], text.size());
+    if (in_file.tellg() != static_cast<std::streamoff>(text.size()))
+        return false;
 
-    in_file.close();
+    string existing(text.size(), '\0');
 
-    return text;
+    in_file.seekg(0, std::ios::beg);
+    in_file.read(&existing[0], existing.size());
+
+    return in_file && existing == text;
 }
 
+// Leaves files that already hold the text untouched, so that their
+// timestamps don't make everything that depends on them rebuild.
 void write_text_file(string filepath, string text) {
+    if (file_has_contents(filepath, text)) {
+        files_unchanged++;
+        return;
+    }
+
+    files_written++;
+
     ofstream out_file(filepath, std::ofstream::binary);
 
     if (!out_file.is_open())
@@ -61,20 +86,15 @@ void write_text_file(string filepath, string text) {
     out_file.close();
 }
 
-string generate_map_header_text(Json map_data, Json layouts_data) {
-    string map_layout_id = map_data["layout"].string_value();
+string generate_map_header_text(JsonView map_data, const LayoutIndex &layouts) {
+    string map_layout_id = map_data["layout"].string_value().str();
 
-    vector<Json> matched;
+    auto match = layouts.find(map_layout_id);
 
-    for (auto &field : layouts_data["layouts"].array_items()) {
-        if (map_layout_id == field["id"].string_value())
-            matched.push_back(field);
-    }
-
-    if (matched.size() != 1)
+    if (match == layouts.end() || match->second.is_null())
         FATAL_ERROR("Failed to find matching layout for %s.\n", map_layout_id.c_str());
 
-    Json layout = matched[0];
+    JsonView layout = match->second;
 
     ostringstream text;
 
@@ -85,18 +105,18 @@ string generate_map_header_text(Json map_data, Json layouts_data) {
     text << map_data["name"].string_value() << "::\n"
          << "\t.4byte " << layout["name"].string_value() << "\n";
 
-    if (map_data.object_items().find("shared_events_map") != map_data.object_items().end())
+    if (map_data.has("shared_events_map"))
         text << "\t.4byte " << map_data["shared_events_map"].string_value() << "_MapEvents\n";
     else
         text << "\t.4byte " << map_data["name"].string_value() << "_MapEvents\n";
 
-    if (map_data.object_items().find("shared_scripts_map") != map_data.object_items().end())
+    if (map_data.has("shared_scripts_map"))
         text << "\t.4byte " << map_data["shared_scripts_map"].string_value() << "_MapScripts\n";
     else
         text << "\t.4byte " << map_data["name"].string_value() << "_MapScripts\n";
 
-    if (map_data.object_items().find("connections") != map_data.object_items().end()
-     && map_data["connections"].array_items().size() > 0 && map_data["connections_no_include"] == Json())
+    if (map_data.has("connections")
+     && map_data["connections"].size() > 0 && map_data["connections_no_include"].is_null())
         text << "\t.4byte " << map_data["name"].string_value() << "_MapConnections\n";
     else
         text << "\t.4byte 0x0\n";
@@ -131,8 +151,8 @@ string generate_map_header_text(Json map_data, Json layouts_data) {
     return text.str();
 }
 
-string generate_map_connections_text(Json map_data) {
-    if (map_data["connections"] == Json())
+string generate_map_connections_text(JsonView map_data) {
+    if (map_data["connections"].is_null())
         return string("\n");
 
     ostringstream text;
@@ -143,7 +163,7 @@ string generate_map_connections_text(Json map_data) {
 
     text << map_data["name"].string_value() << "_MapConnectionsList::\n";
 
-    for (auto &connection : map_data["connections"].array_items()) {
+    for (auto connection : map_data["connections"].array_items()) {
         text << "\tconnection "
              << connection["direction"].string_value() << ", "
              << connection["offset"].int_value() << ", "
@@ -151,14 +171,14 @@ string generate_map_connections_text(Json map_data) {
     }
 
     text << "\n" << map_data["name"].string_value() << "_MapConnections::\n"
-         << "\t.4byte " << map_data["connections"].array_items().size() << "\n"
+         << "\t.4byte " << map_data["connections"].size() << "\n"
          << "\t.4byte " << map_data["name"].string_value() << "_MapConnectionsList\n\n";
 
     return text.str();
 }
 
-string generate_map_events_text(Json map_data) {
-    if (map_data.object_items().find("shared_events_map") != map_data.object_items().end())
+string generate_map_events_text(JsonView map_data) {
+    if (map_data.has("shared_events_map"))
         return string("\n");
 
     ostringstream text;
@@ -169,12 +189,12 @@ string generate_map_events_text(Json map_data) {
 
     string objects_label, warps_label, coords_label, bgs_label;
 
-    if (map_data["object_events"].array_items().size() > 0) {
+    if (map_data["object_events"].size() > 0) {
         objects_label = map_data["name"].string_value() + "_ObjectEvents";
         text << objects_label << ":\n";
-        for (unsigned int i = 0; i < map_data["object_events"].array_items().size(); i++) {
-            auto obj_event = map_data["object_events"].array_items()[i];
-            text << "\tobject_event " << i + 1 << ", "
+        unsigned int i = 0;
+        for (auto obj_event : map_data["object_events"].array_items()) {
+            text << "\tobject_event " << ++i << ", "
                  << obj_event["graphics_id"].string_value() << ", 0, "
                  << obj_event["x"].int_value() << ", "
                  << obj_event["y"].int_value() << ", "
@@ -192,10 +212,10 @@ string generate_map_events_text(Json map_data) {
         objects_label = "0x0";
     }
 
-    if (map_data["warp_events"].array_items().size() > 0) {
+    if (map_data["warp_events"].size() > 0) {
         warps_label = map_data["name"].string_value() + "_MapWarps";
         text << warps_label << ":\n";
-        for (auto &warp_event : map_data["warp_events"].array_items()) {
+        for (auto warp_event : map_data["warp_events"].array_items()) {
             text << "\twarp_def "
                  << warp_event["x"].int_value() << ", "
                  << warp_event["y"].int_value() << ", "
@@ -208,10 +228,10 @@ string generate_map_events_text(Json map_data) {
         warps_label = "0x0";
     }
 
-    if (map_data["coord_events"].array_items().size() > 0) {
+    if (map_data["coord_events"].size() > 0) {
         coords_label = map_data["name"].string_value() + "_MapCoordEvents";
         text << coords_label << ":\n";
-        for (auto &coord_event : map_data["coord_events"].array_items()) {
+        for (auto coord_event : map_data["coord_events"].array_items()) {
             if (coord_event["type"].string_value() == "trigger") {
                 text << "\tcoord_event "
                      << coord_event["x"].int_value() << ", "
@@ -234,10 +254,10 @@ string generate_map_events_text(Json map_data) {
         coords_label = "0x0";
     }
 
-    if (map_data["bg_events"].array_items().size() > 0) {
+    if (map_data["bg_events"].size() > 0) {
         bgs_label = map_data["name"].string_value() + "_MapBGEvents";
         text << bgs_label << ":\n";
-        for (auto &bg_event : map_data["bg_events"].array_items()) {
+        for (auto bg_event : map_data["bg_events"].array_items()) {
             if (bg_event["type"] == "sign") {
                 text << "\tbg_event "
                      << bg_event["x"].int_value() << ", "
@@ -274,7 +294,7 @@ string generate_map_events_text(Json map_data) {
     return text.str();
 }
 
-string generate_firered_map_events_text(Json map_data) {
+string generate_firered_map_events_text(JsonView map_data) {
     ostringstream text;
 
     text << "@\n@ DO NOT MODIFY THIS FILE! It is auto-generated from data/maps/" 
@@ -283,12 +303,12 @@ string generate_firered_map_events_text(Json map_data) {
 
     string objects_label, warps_label, coords_label, bgs_label;
 
-    if (map_data["object_events"].array_items().size() > 0) {
+    if (map_data["object_events"].size() > 0) {
         objects_label = map_data["name"].string_value() + "_ObjectEvents";
         text << objects_label << "::\n";
-        for (unsigned int i = 0; i < map_data["object_events"].array_items().size(); i++) {
-            auto obj_event = map_data["object_events"].array_items()[i];
-            text << "\tobject_event " << i + 1 << ", "
+        unsigned int i = 0;
+        for (auto obj_event : map_data["object_events"].array_items()) {
+            text << "\tobject_event " << ++i << ", "
                  << obj_event["graphics_id"].string_value() << ", "
                  << (obj_event["in_connection"].bool_value() ? 255 : 0) << ", "
                  << obj_event["x"].int_value() << ", "
@@ -307,10 +327,10 @@ string generate_firered_map_events_text(Json map_data) {
         objects_label = "0x0";
     }
 
-    if (map_data["warp_events"].array_items().size() > 0) {
+    if (map_data["warp_events"].size() > 0) {
         warps_label = map_data["name"].string_value() + "_MapWarps";
         text << warps_label << "::\n";
-        for (auto &warp_event : map_data["warp_events"].array_items()) {
+        for (auto warp_event : map_data["warp_events"].array_items()) {
             text << "\twarp_def "
                  << warp_event["x"].int_value() << ", "
                  << warp_event["y"].int_value() << ", "
@@ -323,10 +343,10 @@ string generate_firered_map_events_text(Json map_data) {
         warps_label = "0x0";
     }
 
-    if (map_data["coord_events"].array_items().size() > 0) {
+    if (map_data["coord_events"].size() > 0) {
         coords_label = map_data["name"].string_value() + "_MapCoordEvents";
         text << coords_label << "::\n";
-        for (auto &coord_event : map_data["coord_events"].array_items()) {
+        for (auto coord_event : map_data["coord_events"].array_items()) {
             if (coord_event["type"].string_value() == "trigger") {
                 text << "\tcoord_event "
                      << coord_event["x"].int_value() << ", "
@@ -349,10 +369,10 @@ string generate_firered_map_events_text(Json map_data) {
         coords_label = "0x0";
     }
 
-    if (map_data["bg_events"].array_items().size() > 0) {
+    if (map_data["bg_events"].size() > 0) {
         bgs_label = map_data["name"].string_value() + "_MapBGEvents";
         text << bgs_label << "::\n";
-        for (auto &bg_event : map_data["bg_events"].array_items()) {
+        for (auto bg_event : map_data["bg_events"].array_items()) {
             if (bg_event["type"] == "sign") {
                 text << "\tbg_event "
                      << bg_event["x"].int_value() << ", "
@@ -390,21 +410,23 @@ string get_directory_name(string filename) {
     return filename.substr(0, dir_pos + 1);
 }
 
-void process_map(string map_filepath, string layouts_filepath) {
-    string mapdata_err, layouts_err;
+LayoutIndex index_layouts(JsonView layouts_data) {
+    LayoutIndex layouts;
 
-    string mapdata_json_text = read_text_file(map_filepath);
-    string layouts_json_text = read_text_file(layouts_filepath);
+    for (auto layout : layouts_data["layouts"].array_items()) {
+        auto inserted = layouts.emplace(layout["id"].string_value().str(), layout);
+        if (!inserted.second)
+            inserted.first->second = JsonView();
+    }
 
-    Json map_data = Json::parse(mapdata_json_text, mapdata_err);
-    if (map_data == Json())
-        FATAL_ERROR("%s\n", mapdata_err.c_str());
+    return layouts;
+}
 
-    Json layouts_data = Json::parse(layouts_json_text, layouts_err);
-    if (layouts_data == Json())
-        FATAL_ERROR("%s\n", layouts_err.c_str());
+void process_map(string map_filepath, const LayoutIndex &layouts) {
+    JsonDocument map_doc(map_filepath);
+    JsonView map_data = map_doc.root();
 
-    string header_text = generate_map_header_text(map_data, layouts_data);
+    string header_text = generate_map_header_text(map_data, layouts);
     string events_text = version == "firered" ? generate_firered_map_events_text(map_data)
                                               : generate_map_events_text(map_data);
     string connections_text = generate_map_connections_text(map_data);
@@ -415,16 +437,41 @@ void process_map(string map_filepath, string layouts_filepath) {
     write_text_file(files_dir + "connections.inc", connections_text);
 }
 
-string generate_groups_text(Json groups_data) {
+// Processes every map against one parse of layouts.json, spread over
+// num_threads threads.
+void process_maps(const vector<string> &map_filepaths, string layouts_filepath, unsigned num_threads) {
+    JsonDocument layouts_doc(layouts_filepath);
+    LayoutIndex layouts = index_layouts(layouts_doc.root());
+    atomic<size_t> next_map(0);
+
+    auto worker = [&]() {
+        for (size_t i = next_map++; i < map_filepaths.size(); i = next_map++)
+            process_map(map_filepaths[i], layouts);
+    };
+
+    if (num_threads > map_filepaths.size())
+        num_threads = map_filepaths.size();
+
+    vector<thread> threads;
+    for (unsigned i = 1; i < num_threads; i++)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (thread &t : threads)
+        t.join();
+}
+
+string generate_groups_text(JsonView groups_data) {
     ostringstream text;
 
     text << "@\n@ DO NOT MODIFY THIS FILE! It is auto-generated from data/maps/map_groups.json\n@\n\n";
 
-    for (auto &key : groups_data["group_order"].array_items()) {
-        string group = key.string_value();
+    for (auto key : groups_data["group_order"].array_items()) {
+        StringView group = key.string_value();
         text << group << "::\n";
         auto maps = groups_data[group].array_items();
-        for (Json &map_name : maps)
+        for (auto map_name : maps)
             text << "\t.4byte " << map_name.string_value() << "\n";
         text << "\n";
     }
@@ -433,24 +480,27 @@ string generate_groups_text(Json groups_data) {
         text << "\t.align 2\n";
 
     text << "gMapGroups::\n";
-    for (auto &group : groups_data["group_order"].array_items())
+    for (auto group : groups_data["group_order"].array_items())
         text << "\t.4byte " << group.string_value() << "\n";
     text << "\n";
 
     return text.str();
 }
 
-string generate_connections_text(Json groups_data) {
-    vector<Json> map_names;
+string generate_connections_text(JsonView groups_data) {
+    vector<StringView> map_names;
 
-    for (auto &group : groups_data["group_order"].array_items())
+    for (auto group : groups_data["group_order"].array_items())
     for (auto map_name : groups_data[group.string_value()].array_items())
-        map_names.push_back(map_name);
+        map_names.push_back(map_name.string_value());
 
-    vector<Json> connections_include_order = groups_data["connections_include_order"].array_items();
+    vector<StringView> connections_include_order;
+
+    for (auto map_name : groups_data["connections_include_order"].array_items())
+        connections_include_order.push_back(map_name.string_value());
 
     if (connections_include_order.size() > 0)
-        sort(map_names.begin(), map_names.end(), [connections_include_order](const Json &a, const Json &b) {
+        sort(map_names.begin(), map_names.end(), [connections_include_order](StringView a, StringView b) {
             auto iter_a = find(connections_include_order.begin(), connections_include_order.end(), a);
             if (iter_a == connections_include_order.end())
                 iter_a = connections_include_order.begin() + numeric_limits<int>::max();
@@ -464,16 +514,16 @@ string generate_connections_text(Json groups_data) {
 
     text << "@\n@ DO NOT MODIFY THIS FILE! It is auto-generated from data/maps/map_groups.json\n@\n\n";
 
-    for (Json map_name : map_names)
-        text << "\t.include \"data/maps/" << map_name.string_value() << "/connections.inc\"\n";
+    for (StringView map_name : map_names)
+        text << "\t.include \"data/maps/" << map_name << "/connections.inc\"\n";
 
     return text.str();
 }
 
-string generate_headers_text(Json groups_data) {
-    vector<string> map_names;
+string generate_headers_text(JsonView groups_data) {
+    vector<StringView> map_names;
 
-    for (auto &group : groups_data["group_order"].array_items())
+    for (auto group : groups_data["group_order"].array_items())
     for (auto map_name : groups_data[group.string_value()].array_items())
         map_names.push_back(map_name.string_value());
 
@@ -481,16 +531,16 @@ string generate_headers_text(Json groups_data) {
 
     text << "@\n@ DO NOT MODIFY THIS FILE! It is auto-generated from data/maps/map_groups.json\n@\n\n";
 
-    for (string map_name : map_names)
+    for (StringView map_name : map_names)
         text << "\t.include \"data/maps/" << map_name << "/header.inc\"\n";
 
     return text.str();
 }
 
-string generate_events_text(Json groups_data) {
-    vector<string> map_names;
+string generate_events_text(JsonView groups_data) {
+    vector<StringView> map_names;
 
-    for (auto &group : groups_data["group_order"].array_items())
+    for (auto group : groups_data["group_order"].array_items())
     for (auto map_name : groups_data[group.string_value()].array_items())
         map_names.push_back(map_name.string_value());
 
@@ -498,13 +548,13 @@ string generate_events_text(Json groups_data) {
 
     text << "@\n@ DO NOT MODIFY THIS FILE! It is auto-generated from data/maps/map_groups.json\n@\n\n";
 
-    for (string map_name : map_names)
+    for (StringView map_name : map_names)
         text << "\t.include \"data/maps/" << map_name << "/events.inc\"\n";
 
     return text.str();
 }
 
-string generate_map_constants_text(string groups_filepath, Json groups_data) {
+string generate_map_constants_text(string groups_filepath, JsonView groups_data) {
     string file_dir = get_directory_name(groups_filepath);
     char dir_separator = file_dir.back();
 
@@ -517,23 +567,22 @@ string generate_map_constants_text(string groups_filepath, Json groups_data) {
 
     int group_num = 0;
 
-    for (auto &group : groups_data["group_order"].array_items()) {
+    for (auto group : groups_data["group_order"].array_items()) {
         text << "// " << group.string_value() << "\n";
-        vector<Json> map_ids;
+        vector<string> map_ids;
         size_t max_length = 0;
 
-        for (auto &map_name : groups_data[group.string_value()].array_items()) {
-            string header_filepath = file_dir + map_name.string_value() + dir_separator + "map.json";
-            string err_str;
-            Json map_data = Json::parse(read_text_file(header_filepath), err_str);
-            map_ids.push_back(map_data["id"]);
-            if (map_data["id"].string_value().length() > max_length)
-                max_length = map_data["id"].string_value().length();
+        for (auto map_name : groups_data[group.string_value()].array_items()) {
+            string header_filepath = file_dir + map_name.string_value().str() + dir_separator + "map.json";
+            JsonDocument map_doc(header_filepath);
+            map_ids.push_back(map_doc.root()["id"].string_value().str());
+            if (map_ids.back().length() > max_length)
+                max_length = map_ids.back().length();
         }
 
         int map_id_num = 0;
-        for (Json map_id : map_ids) {
-            text << "#define " << map_id.string_value() << string((max_length - map_id.string_value().length() + 1), ' ')
+        for (const string &map_id : map_ids) {
+            text << "#define " << map_id << string((max_length - map_id.length() + 1), ' ')
                  << "(" << map_id_num++ << " | (" << group_num << " << 8))\n";
         }
         text << "\n";
@@ -548,11 +597,8 @@ string generate_map_constants_text(string groups_filepath, Json groups_data) {
 }
 
 void process_groups(string groups_filepath) {
-    string err;
-    Json groups_data = Json::parse(read_text_file(groups_filepath), err);
-
-    if (groups_data == Json())
-        FATAL_ERROR("%s\n", err.c_str());
+    JsonDocument groups_doc(groups_filepath);
+    JsonView groups_data = groups_doc.root();
 
     string groups_text = generate_groups_text(groups_data);
     string connections_text = generate_connections_text(groups_data);
@@ -570,13 +616,13 @@ void process_groups(string groups_filepath) {
     write_text_file(file_dir + ".." + s + ".." + s + "include" + s + "constants" + s + "map_groups.h", map_header_text);
 }
 
-string generate_layout_headers_text(Json layouts_data) {
+string generate_layout_headers_text(JsonView layouts_data) {
     ostringstream text;
 
     text << "@\n@ DO NOT MODIFY THIS FILE! It is auto-generated from data/layouts/layouts.json\n@\n\n";
 
-    for (auto &layout : layouts_data["layouts"].array_items()) {
-        if (layout == Json::object()) continue;
+    for (auto layout : layouts_data["layouts"].array_items()) {
+        if (layout.is_empty_object()) continue;
         string border_label = layout["name"].string_value() + "_Border";
         string blockdata_label = layout["name"].string_value() + "_Blockdata";
         text << border_label << "::\n"
@@ -604,7 +650,7 @@ string generate_layout_headers_text(Json layouts_data) {
     return text.str();
 }
 
-string generate_layouts_table_text(Json layouts_data) {
+string generate_layouts_table_text(JsonView layouts_data) {
     ostringstream text;
 
     text << "@\n@ DO NOT MODIFY THIS FILE! It is auto-generated from data/layouts/layouts.json\n@\n\n";
@@ -612,8 +658,8 @@ string generate_layouts_table_text(Json layouts_data) {
     text << "\t.align 2\n"
          << layouts_data["layouts_table_label"].string_value() << "::\n";
 
-    for (auto &layout : layouts_data["layouts"].array_items()) {
-        string layout_name = layout["name"].string_value();
+    for (auto layout : layouts_data["layouts"].array_items()) {
+        string layout_name = layout["name"].string_value().str();
         if (layout_name.empty()) layout_name = "NULL";
         text << "\t.4byte " << layout_name << "\n";
     }
@@ -621,7 +667,7 @@ string generate_layouts_table_text(Json layouts_data) {
     return text.str();
 }
 
-string generate_layouts_constants_text(Json layouts_data) {
+string generate_layouts_constants_text(JsonView layouts_data) {
     ostringstream text;
 
     text << "#ifndef GUARD_CONSTANTS_LAYOUTS_H\n"
@@ -630,8 +676,8 @@ string generate_layouts_constants_text(Json layouts_data) {
     text << "//\n// DO NOT MODIFY THIS FILE! It is auto-generated from data/layouts/layouts.json\n//\n\n";
 
     int i = 1;
-    for (auto &layout : layouts_data["layouts"].array_items()) {
-        if (layout != Json::object())
+    for (auto layout : layouts_data["layouts"].array_items()) {
+        if (!layout.is_empty_object())
             text << "#define " << layout["id"].string_value() << " " << i << "\n";
         i++;
     }
@@ -642,11 +688,8 @@ string generate_layouts_constants_text(Json layouts_data) {
 }
 
 void process_layouts(string layouts_filepath) {
-    string err;
-    Json layouts_data = Json::parse(read_text_file(layouts_filepath), err);
-
-    if (layouts_data == Json())
-        FATAL_ERROR("%s\n", err.c_str());
+    JsonDocument layouts_doc(layouts_filepath);
+    JsonView layouts_data = layouts_doc.root();
 
     string layout_headers_text = generate_layout_headers_text(layouts_data);
     string layouts_table_text = generate_layouts_table_text(layouts_data);
@@ -661,8 +704,19 @@ void process_layouts(string layouts_filepath) {
 }
 
 int main(int argc, char *argv[]) {
+    bool print_stats = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--stats") {
+            print_stats = true;
+            std::copy(argv + i + 1, argv + argc, argv + i);
+            argc--;
+            break;
+        }
+    }
+
     if (argc < 3)
-        FATAL_ERROR("USAGE: mapjson <mode> <game-version> [options]\n");
+        FATAL_ERROR("USAGE: mapjson [--stats] <mode> <game-version> [options]\n");
 
     version = argv[2];
     if (version != "emerald" && version != "ruby" && version != "firered")
@@ -670,8 +724,8 @@ int main(int argc, char *argv[]) {
 
     char *mode_arg = argv[1];
     string mode(mode_arg);
-    if (mode != "layouts" && mode != "map" && mode != "groups")
-        FATAL_ERROR("ERROR: <mode> must be 'layouts', 'map', or 'groups'.\n");
+    if (mode != "layouts" && mode != "map" && mode != "maps" && mode != "groups")
+        FATAL_ERROR("ERROR: <mode> must be 'layouts', 'map', 'maps', or 'groups'.\n");
 
     if (mode == "map") {
         if (argc != 5)
@@ -680,7 +734,29 @@ int main(int argc, char *argv[]) {
         string filepath(argv[3]);
         string layouts_filepath(argv[4]);
 
-        process_map(filepath, layouts_filepath);
+        JsonDocument layouts_doc(layouts_filepath);
+
+        process_map(filepath, index_layouts(layouts_doc.root()));
+    }
+    else if (mode == "maps") {
+        int arg = 3;
+        unsigned num_threads = thread::hardware_concurrency();
+
+        if (arg + 1 < argc && string(argv[arg]) == "-j") {
+            int count = std::atoi(argv[arg + 1]);
+            if (count < 1)
+                FATAL_ERROR("ERROR: -j needs a positive thread count.\n");
+            num_threads = count;
+            arg += 2;
+        }
+
+        if (argc - arg < 2)
+            FATAL_ERROR("USAGE: mapjson maps <game-version> [-j THREADS] <layouts_file> <map_file>...\n");
+
+        string layouts_filepath(argv[arg++]);
+        vector<string> map_filepaths(argv + arg, argv + argc);
+
+        process_maps(map_filepaths, layouts_filepath, num_threads > 0 ? num_threads : 1);
     }
     else if (mode == "groups") {
         if (argc != 4)
@@ -699,5 +775,8 @@ int main(int argc, char *argv[]) {
         process_layouts(filepath);
     }
 
+    if (print_stats)
+        cout << files_unchanged << " of " << files_written + files_unchanged << " files unchanged" << endl;
+
     return 0;
 }
@@ -20,129 +20,331 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstdint>
 #include <cstring>
+#include <string>
 #include <vector>
 #include "agb.h"
+#include "elf.h"
+#include "error.h"
 #include "main.h"
 #include "midi.h"
 #include "tables.h"
 
-int g_agbTrack;
-
-static std::string s_lastOpName;
-static int s_blockNum;
-static bool s_keepLastOpName;
-static int s_lastNote;
-static int s_lastVelocity;
-static bool s_noteChanged;
-static bool s_velocityChanged;
-static bool s_inPattern;
-static int s_extendedCommand;
-static int s_memaccOp;
-static int s_memaccParam1;
-static int s_memaccParam2;
-
-void PrintAgbHeader()
+// Track commands, as MPlayDef.s defines them.
+enum
 {
-    std::fprintf(g_outputFile, "\t.include \"MPlayDef.s\"\n\n");
-    std::fprintf(g_outputFile, "\t.equ\t%s_grp, voicegroup%03u\n", g_asmLabel.c_str(), g_voiceGroup);
-    std::fprintf(g_outputFile, "\t.equ\t%s_pri, %u\n", g_asmLabel.c_str(), g_priority);
+    W00 = 0x80,
+    FINE = 0xB1,
+    GOTO = 0xB2,
+    PATT = 0xB3,
+    PEND = 0xB4,
+    MEMACC = 0xB9,
+    PRIO = 0xBA,
+    TEMPO = 0xBB,
+    KEYSH = 0xBC,
+    VOICE = 0xBD,
+    VOL = 0xBE,
+    PAN = 0xBF,
+    BEND = 0xC0,
+    BENDR = 0xC1,
+    LFOS = 0xC2,
+    LFODL = 0xC3,
+    MOD = 0xC4,
+    MODT = 0xC5,
+    TUNE = 0xC8,
+    XCMD = 0xCD,
+    EOT = 0xCE,
+    TIE = 0xCF,
+};
+
+// The lengths that have a wait command (W00 + index) and, apart from 0,
+// a note command (TIE + index).
+static const int s_lengths[] =
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+    17, 18, 19, 20, 21, 22, 23, 24, 28, 30, 32, 36, 40, 42, 44,
+    48, 52, 54, 56, 60, 64, 66, 68, 72, 76, 78, 80, 84, 88, 90, 92, 96,
+};
 
-    if (g_reverb >= 0)
-        std::fprintf(g_outputFile, "\t.equ\t%s_rev, reverb_set+%u\n", g_asmLabel.c_str(), g_reverb);
-    else
-        std::fprintf(g_outputFile, "\t.equ\t%s_rev, 0\n", g_asmLabel.c_str());
+static int LengthIndex(int length)
+{
+    for (unsigned i = 0; i < sizeof(s_lengths) / sizeof(s_lengths[0]); i++)
+        if (s_lengths[i] == length)
+            return i;
 
-    std::fprintf(g_outputFile, "\t.equ\t%s_mvl, %u\n", g_asmLabel.c_str(), g_masterVolume);
-    std::fprintf(g_outputFile, "\t.equ\t%s_key, %u\n", g_asmLabel.c_str(), 0);
-    std::fprintf(g_outputFile, "\t.equ\t%s_tbs, %u\n", g_asmLabel.c_str(), g_clocksPerBeat);
-    std::fprintf(g_outputFile, "\t.equ\t%s_exg, %u\n", g_asmLabel.c_str(), g_exactGateTime);
-    std::fprintf(g_outputFile, "\t.equ\t%s_cmp, %u\n", g_asmLabel.c_str(), g_compressionEnabled);
+    RaiseError("no wait or note command lasts %d clocks", length);
+}
+
+static const char *s_memaccOpNames[] =
+{
+    "mem_set",
+    "mem_add",
+    "mem_sub",
+    "mem_mem_set",
+    "mem_mem_add",
+    "mem_mem_sub",
+};
+
+void AgbWriter::PrintOpName(int op)
+{
+    const char *name;
 
-    std::fprintf(g_outputFile, "\n\t.section .rodata\n");
-    std::fprintf(g_outputFile, "\t.global\t%s\n", g_asmLabel.c_str());
+    switch (op)
+    {
+    case FINE:   name = "FINE";   break;
+    case GOTO:   name = "GOTO";   break;
+    case PATT:   name = "PATT";   break;
+    case PEND:   name = "PEND";   break;
+    case MEMACC: name = "MEMACC"; break;
+    case PRIO:   name = "PRIO  "; break;
+    case TEMPO:  name = "TEMPO "; break;
+    case KEYSH:  name = "KEYSH "; break;
+    case VOICE:  name = "VOICE "; break;
+    case VOL:    name = "VOL   "; break;
+    case PAN:    name = "PAN   "; break;
+    case BEND:   name = "BEND  "; break;
+    case BENDR:  name = "BENDR "; break;
+    case LFOS:   name = "LFOS  "; break;
+    case LFODL:  name = "LFODL "; break;
+    case MOD:    name = "MOD   "; break;
+    case MODT:   name = "MODT  "; break;
+    case TUNE:   name = "TUNE  "; break;
+    case XCMD:   name = "XCMD  "; break;
+    case EOT:    name = "EOT   "; break;
+    case TIE:    name = "TIE   "; break;
+    default:
+        std::fprintf(m_file, "N%02u   ", s_lengths[op - TIE]);
+        return;
+    }
 
-    std::fprintf(g_outputFile, "\t.align\t2\n");
+    std::fputs(name, m_file);
 }
 
-void ResetTrackVars()
+void AgbWriter::PrintArg(const Arg& arg)
 {
-    s_lastVelocity = -1;
-    s_lastNote = -1;
-    s_velocityChanged = false;
-    s_noteChanged = false;
-    s_keepLastOpName = false;
-    s_lastOpName = "";
-    s_inPattern = false;
+    switch (arg.type)
+    {
+    case ArgType::Number:
+        std::fprintf(m_file, "%u", arg.value);
+        break;
+    case ArgType::Hex:
+        std::fprintf(m_file, "0x%02X", arg.value);
+        break;
+    case ArgType::Note:
+        if (arg.value >= 24)
+            std::fprintf(m_file, g_noteTable[arg.value % 12], arg.value / 12 - 2);
+        else
+            std::fprintf(m_file, g_minusNoteTable[arg.value % 12], arg.value / -12 + 2);
+        break;
+    case ArgType::Velocity:
+        std::fprintf(m_file, "v%03u", arg.value);
+        break;
+    case ArgType::GateTime:
+        std::fprintf(m_file, "gtp%u", arg.value);
+        break;
+    case ArgType::CenterValue:
+        std::fprintf(m_file, "c_v%+d", arg.value - 64);
+        break;
+    case ArgType::Volume:
+        std::fprintf(m_file, "%u*%s_mvl/mxv", arg.value, m_options->asmLabel.c_str());
+        break;
+    case ArgType::KeyShift:
+        std::fprintf(m_file, "%s_key%+d", m_options->asmLabel.c_str(), arg.value);
+        break;
+    case ArgType::Tempo:
+        std::fprintf(m_file, "%u*%s_tbs/2", arg.value, m_options->asmLabel.c_str());
+        break;
+    case ArgType::MemAccOp:
+        std::fputs(s_memaccOpNames[arg.value], m_file);
+        break;
+    case ArgType::ExtendedCommand:
+        std::fputs(arg.value == 0x08 ? "xIECV " : "xIECL ", m_file);
+        break;
+    }
 }
 
-void PrintWait(int wait)
+// The value the assembler gets for an operand, given the definitions in
+// MPlayDef.s and the .equ lines in PrintAgbHeader.
+int AgbWriter::ArgValue(const Arg& arg)
 {
-    if (wait > 0)
+    switch (arg.type)
     {
-        std::fprintf(g_outputFile, "\t.byte\tW%02d\n", wait);
-        s_velocityChanged = true;
-        s_noteChanged = true;
-        s_keepLastOpName = true;
+    case ArgType::Velocity:
+        // MPlayDef.s has v069 as 79, and songs depend on it.
+        return arg.value == 69 ? 79 : arg.value;
+    case ArgType::Volume:
+        return arg.value * m_options->masterVolume / 127;
+    case ArgType::Tempo:
+        return arg.value * m_options->clocksPerBeat / 2;
+    default:
+        return arg.value;
     }
 }
 
-void PrintOp(int wait, std::string name, const char *format, ...)
+void AgbWriter::EmitByte(int value)
 {
-    std::va_list args;
-    va_start(args, format);
-    std::fprintf(g_outputFile, "\t.byte\t\t");
+    m_object.data.push_back(value & 0xFF);
+}
+
+// Writes one command as a .byte line, or as the bytes that line stands for.
+// Running status means the op is left out when it repeats the last one.
+void AgbWriter::PrintCommand(const char *prefix, int op, bool withOp, const Arg& arg1, const Arg& arg2, const Arg& arg3)
+{
+    const Arg *args[] = { &arg1, &arg2, &arg3 };
 
-    if (format != nullptr)
+    if (m_options->objectOutput)
     {
-        if (!g_compressionEnabled || s_lastOpName != name)
-        {
-            std::fprintf(g_outputFile, "%s, ", name.c_str());
-            s_lastOpName = name;
-        }
-        else
+        if (withOp)
+            EmitByte(op);
+
+        for (const Arg *arg : args)
+            if (arg->type != ArgType::None)
+                EmitByte(ArgValue(*arg));
+
+        return;
+    }
+
+    std::fputs(prefix, m_file);
+
+    const char *separator = "";
+
+    if (withOp)
+    {
+        PrintOpName(op);
+        separator = ", ";
+    }
+    else
+    {
+        std::fputs("        ", m_file);
+    }
+
+    for (const Arg *arg : args)
+    {
+        if (arg->type != ArgType::None)
         {
-            std::fprintf(g_outputFile, "        ");
+            std::fputs(separator, m_file);
+            PrintArg(*arg);
+            separator = ", ";
         }
-        std::vfprintf(g_outputFile, format, args);
     }
+
+    std::fputc('\n', m_file);
+}
+
+void AgbWriter::PrintLabel(const char *format, ...)
+{
+    char name[256];
+    std::va_list args;
+    va_start(args, format);
+    std::vsnprintf(name, sizeof(name), format, args);
+    va_end(args);
+
+    if (m_options->objectOutput)
+        m_object.labels.push_back({ name, (std::uint32_t)m_object.data.size(), false });
     else
+        std::fprintf(m_file, "%s:\n", name);
+}
+
+void AgbWriter::Start(std::FILE *file, const Options& options)
+{
+    m_file = file;
+    m_options = &options;
+    m_object.data.clear();
+    m_object.labels.clear();
+    m_object.references.clear();
+}
+
+void AgbWriter::PrintHeader()
+{
+    if (m_options->objectOutput)
+        return;
+
+    std::fprintf(m_file, "\t.include \"MPlayDef.s\"\n\n");
+    std::fprintf(m_file, "\t.equ\t%s_grp, voicegroup%03u\n", m_options->asmLabel.c_str(), m_options->voiceGroup);
+    std::fprintf(m_file, "\t.equ\t%s_pri, %u\n", m_options->asmLabel.c_str(), m_options->priority);
+
+    if (m_options->reverb >= 0)
+        std::fprintf(m_file, "\t.equ\t%s_rev, reverb_set+%u\n", m_options->asmLabel.c_str(), m_options->reverb);
+    else
+        std::fprintf(m_file, "\t.equ\t%s_rev, 0\n", m_options->asmLabel.c_str());
+
+    std::fprintf(m_file, "\t.equ\t%s_mvl, %u\n", m_options->asmLabel.c_str(), m_options->masterVolume);
+    std::fprintf(m_file, "\t.equ\t%s_key, %u\n", m_options->asmLabel.c_str(), 0);
+    std::fprintf(m_file, "\t.equ\t%s_tbs, %u\n", m_options->asmLabel.c_str(), m_options->clocksPerBeat);
+    std::fprintf(m_file, "\t.equ\t%s_exg, %u\n", m_options->asmLabel.c_str(), m_options->exactGateTime);
+    std::fprintf(m_file, "\t.equ\t%s_cmp, %u\n", m_options->asmLabel.c_str(), m_options->compressionEnabled);
+
+    std::fprintf(m_file, "\n\t.section .rodata\n");
+    std::fprintf(m_file, "\t.global\t%s\n", m_options->asmLabel.c_str());
+
+    std::fprintf(m_file, "\t.align\t2\n");
+}
+
+void AgbWriter::ResetTrackVars()
+{
+    m_lastVelocity = -1;
+    m_lastNote = -1;
+    m_velocityChanged = false;
+    m_noteChanged = false;
+    m_keepLastOpName = false;
+    m_lastOp = -1;
+    m_inPattern = false;
+}
+
+void AgbWriter::PrintWait(int wait)
+{
+    if (wait > 0)
     {
-        std::fputs(name.c_str(), g_outputFile);
-        s_lastOpName = name;
+        if (m_options->objectOutput)
+            EmitByte(W00 + LengthIndex(wait));
+        else
+            std::fprintf(m_file, "\t.byte\tW%02d\n", wait);
+        m_velocityChanged = true;
+        m_noteChanged = true;
+        m_keepLastOpName = true;
     }
+}
 
-    std::fprintf(g_outputFile, "\n");
+void AgbWriter::PrintOp(int wait, int op, const Arg& arg1, const Arg& arg2, const Arg& arg3)
+{
+    bool withOp = arg1.type == ArgType::None || !m_options->compressionEnabled || m_lastOp != op;
 
-    va_end(args);
+    PrintCommand("\t.byte\t\t", op, withOp, arg1, arg2, arg3);
+    m_lastOp = op;
 
     PrintWait(wait);
 }
 
-void PrintByte(const char *format, ...)
+void AgbWriter::PrintByte(int op, const Arg& arg1, const Arg& arg2, const Arg& arg3)
 {
-    std::va_list args;
-    va_start(args, format);
-    std::fprintf(g_outputFile, "\t.byte\t");
-    std::vfprintf(g_outputFile, format, args);
-    std::fprintf(g_outputFile, "\n");
-    s_velocityChanged = true;
-    s_noteChanged = true;
-    s_keepLastOpName = true;
-    va_end(args);
+    // The track's initial volume is lined up with the ops from PrintOp.
+    PrintCommand(op == VOL ? "\t.byte\t\t" : "\t.byte\t", op, true, arg1, arg2, arg3);
+    m_velocityChanged = true;
+    m_noteChanged = true;
+    m_keepLastOpName = true;
 }
 
-void PrintWord(const char *format, ...)
+void AgbWriter::PrintWord(const char *format, ...)
 {
+    char name[256];
     std::va_list args;
     va_start(args, format);
-    std::fprintf(g_outputFile, "\t .word\t");
-    std::vfprintf(g_outputFile, format, args);
-    std::fprintf(g_outputFile, "\n");
+    std::vsnprintf(name, sizeof(name), format, args);
     va_end(args);
+
+    if (m_options->objectOutput)
+    {
+        m_object.references.push_back({ (std::uint32_t)m_object.data.size(), name });
+        m_object.data.resize(m_object.data.size() + 4);
+    }
+    else
+    {
+        std::fprintf(m_file, "\t .word\t%s\n", name);
+    }
 }
 
-void PrintNote(const Event& event)
+void AgbWriter::PrintNote(const Event& event)
 {
     int note = event.note;
     int velocity = g_noteVelocityLUT[event.param1];
@@ -153,124 +355,98 @@ void PrintNote(const Event& event)
 
     int gateTimeParam = 0;
 
-    if (g_exactGateTime && duration != -1)
+    if (m_options->exactGateTime && duration != -1)
         gateTimeParam = event.param2 - duration;
 
-    char gtpBuf[16];
+    Arg gateTimeArg;
 
     if (gateTimeParam > 0)
-        std::snprintf(gtpBuf, sizeof(gtpBuf), ", gtp%u", gateTimeParam);
-    else
-        gtpBuf[0] = 0;
+        gateTimeArg = Arg(ArgType::GateTime, gateTimeParam);
 
-    char opName[16];
+    int op = TIE;
 
-    if (duration == -1)
-        std::strcpy(opName, "TIE   ");
-    else
-        std::snprintf(opName, sizeof(opName), "N%02u   ", duration);
+    if (duration != -1)
+        op = TIE + LengthIndex(duration);
 
     bool noteChanged = true;
     bool velocityChanged = true;
 
-    if (g_compressionEnabled)
+    if (m_options->compressionEnabled)
     {
-        noteChanged = (note != s_lastNote);
-        velocityChanged = (velocity != s_lastVelocity);
+        noteChanged = (note != m_lastNote);
+        velocityChanged = (velocity != m_lastVelocity);
     }
 
-    if (s_keepLastOpName)
-        s_keepLastOpName = false;
+    if (m_keepLastOpName)
+        m_keepLastOpName = false;
     else
-        s_lastOpName = "";
+        m_lastOp = -1;
 
     if (noteChanged || velocityChanged || (gateTimeParam > 0))
     {
-        s_lastNote = note;
-
-        char noteBuf[16];
-
-        if (note >= 24)
-            std::snprintf(noteBuf, sizeof(noteBuf), g_noteTable[note % 12], note / 12 - 2);
-        else
-            std::snprintf(noteBuf, sizeof(noteBuf), g_minusNoteTable[note % 12], note / -12 + 2);
+        m_lastNote = note;
 
-        char velocityBuf[16];
+        Arg velocityArg;
 
         if (velocityChanged || (gateTimeParam > 0))
         {
-            s_lastVelocity = velocity;
-            std::snprintf(velocityBuf, sizeof(velocityBuf), ", v%03u", velocity);
-        }
-        else
-        {
-            velocityBuf[0] = 0;
+            m_lastVelocity = velocity;
+            velocityArg = Arg(ArgType::Velocity, velocity);
         }
 
-        PrintOp(event.time, opName, "%s%s%s", noteBuf, velocityBuf, gtpBuf);
+        PrintOp(event.time, op, Arg(ArgType::Note, note), velocityArg, gateTimeArg);
     }
     else
     {
-        PrintOp(event.time, opName, 0);
+        PrintOp(event.time, op);
     }
 
-    s_noteChanged = noteChanged;
-    s_velocityChanged = velocityChanged;
+    m_noteChanged = noteChanged;
+    m_velocityChanged = velocityChanged;
 }
 
-void PrintEndOfTieOp(const Event& event)
+void AgbWriter::PrintEndOfTieOp(const Event& event)
 {
     int note = event.note;
-    bool noteChanged = (note != s_lastNote);
+    bool noteChanged = (note != m_lastNote);
 
-    if (!noteChanged || !s_noteChanged)
-        s_lastOpName = "";
+    if (!noteChanged || !m_noteChanged)
+        m_lastOp = -1;
 
-    if (!noteChanged && g_compressionEnabled)
+    if (!noteChanged && m_options->compressionEnabled)
     {
-        PrintOp(event.time, "EOT   ", nullptr);
+        PrintOp(event.time, EOT);
     }
     else
     {
-        s_lastNote = note;
-        if (note >= 24)
-            PrintOp(event.time, "EOT   ", g_noteTable[note % 12], note / 12 - 2);
-        else
-            PrintOp(event.time, "EOT   ", g_minusNoteTable[note % 12], note / -12 + 2);
+        m_lastNote = note;
+        PrintOp(event.time, EOT, Arg(ArgType::Note, note));
     }
 
-    s_noteChanged = noteChanged;
+    m_noteChanged = noteChanged;
 }
 
-void PrintSeqLoopLabel(const Event& event)
+void AgbWriter::PrintSeqLoopLabel(const Event& event)
 {
-    s_blockNum = event.param1 + 1;
-    std::fprintf(g_outputFile, "%s_%u_B%u:\n", g_asmLabel.c_str(), g_agbTrack, s_blockNum);
+    m_blockNum = event.param1 + 1;
+    PrintLabel("%s_%u_B%u", m_options->asmLabel.c_str(), m_track, m_blockNum);
     PrintWait(event.time);
     ResetTrackVars();
 }
 
-void PrintMemAcc(const Event& event)
+void AgbWriter::PrintMemAcc(const Event& event)
 {
-    switch (s_memaccOp)
+    switch (m_memaccOp)
     {
     case 0x00:
-        PrintByte("MEMACC, mem_set, 0x%02X, %u", s_memaccParam1, event.param2);
-        break;
     case 0x01:
-        PrintByte("MEMACC, mem_add, 0x%02X, %u", s_memaccParam1, event.param2);
-        break;
     case 0x02:
-        PrintByte("MEMACC, mem_sub, 0x%02X, %u", s_memaccParam1, event.param2);
+        PrintByte(MEMACC, Arg(ArgType::MemAccOp, m_memaccOp), Arg(ArgType::Hex, m_memaccParam1), Arg(ArgType::Number, event.param2));
         break;
     case 0x03:
-        PrintByte("MEMACC, mem_mem_set, 0x%02X, 0x%02X", s_memaccParam1, event.param2);
-        break;
     case 0x04:
-        PrintByte("MEMACC, mem_mem_add, 0x%02X, 0x%02X", s_memaccParam1, event.param2);
-        break;
     case 0x05:
-        PrintByte("MEMACC, mem_mem_sub, 0x%02X, 0x%02X", s_memaccParam1, event.param2);
+        PrintByte(MEMACC, Arg(ArgType::MemAccOp, m_memaccOp), Arg(ArgType::Hex, m_memaccParam1), Arg(ArgType::Hex, event.param2));
         break;
     // TODO: everything else
     case 0x06:
@@ -328,17 +504,15 @@ void PrintMemAcc(const Event& event)
     PrintWait(event.time);
 }
 
-void PrintExtendedOp(const Event& event)
+void AgbWriter::PrintExtendedOp(const Event& event)
 {
     // TODO: support for other extended commands
 
-    switch (s_extendedCommand)
+    switch (m_extendedCommand)
     {
     case 0x08:
-        PrintOp(event.time, "XCMD  ", "xIECV , %u", event.param2);
-        break;
     case 0x09:
-        PrintOp(event.time, "XCMD  ", "xIECL , %u", event.param2);
+        PrintOp(event.time, XCMD, Arg(ArgType::ExtendedCommand, m_extendedCommand), Arg(ArgType::Number, event.param2));
         break;
     default:
         PrintWait(event.time);
@@ -346,66 +520,66 @@ void PrintExtendedOp(const Event& event)
     }
 }
 
-void PrintControllerOp(const Event& event)
+void AgbWriter::PrintControllerOp(const Event& event)
 {
     switch (event.param1)
     {
     case 0x01:
-        PrintOp(event.time, "MOD   ", "%u", event.param2);
+        PrintOp(event.time, MOD, Arg(ArgType::Number, event.param2));
         break;
     case 0x07:
-        PrintOp(event.time, "VOL   ", "%u*%s_mvl/mxv", event.param2, g_asmLabel.c_str());
+        PrintOp(event.time, VOL, Arg(ArgType::Volume, event.param2));
         break;
     case 0x0A:
-        PrintOp(event.time, "PAN   ", "c_v%+d", event.param2 - 64);
+        PrintOp(event.time, PAN, Arg(ArgType::CenterValue, event.param2));
         break;
     case 0x0C:
     case 0x10:
         PrintMemAcc(event);
         break;
     case 0x0D:
-        s_memaccOp = event.param2;
+        m_memaccOp = event.param2;
         PrintWait(event.time);
         break;
     case 0x0E:
-        s_memaccParam1 = event.param2;
+        m_memaccParam1 = event.param2;
         PrintWait(event.time);
         break;
     case 0x0F:
-        s_memaccParam2 = event.param2;
+        m_memaccParam2 = event.param2;
         PrintWait(event.time);
         break;
     case 0x11:
-        std::fprintf(g_outputFile, "%s_%u_L%u:\n", g_asmLabel.c_str(), g_agbTrack, event.param2);
+        PrintLabel("%s_%u_L%u", m_options->asmLabel.c_str(), m_track, event.param2);
         PrintWait(event.time);
         ResetTrackVars();
         break;
     case 0x14:
-        PrintOp(event.time, "BENDR ", "%u", event.param2);
+        PrintOp(event.time, BENDR, Arg(ArgType::Number, event.param2));
         break;
     case 0x15:
-        PrintOp(event.time, "LFOS  ", "%u", event.param2);
+        PrintOp(event.time, LFOS, Arg(ArgType::Number, event.param2));
         break;
     case 0x16:
-        PrintOp(event.time, "MODT  ", "%u", event.param2);
+        PrintOp(event.time, MODT, Arg(ArgType::Number, event.param2));
         break;
     case 0x18:
-        PrintOp(event.time, "TUNE  ", "c_v%+d", event.param2 - 64);
+        PrintOp(event.time, TUNE, Arg(ArgType::CenterValue, event.param2));
         break;
     case 0x1A:
-        PrintOp(event.time, "LFODL ", "%u", event.param2);
+        PrintOp(event.time, LFODL, Arg(ArgType::Number, event.param2));
         break;
     case 0x1D:
     case 0x1F:
         PrintExtendedOp(event);
         break;
     case 0x1E:
-        s_extendedCommand = event.param2;
+        m_extendedCommand = event.param2;
         // TODO: loop op
         break;
     case 0x21:
     case 0x27:
-        PrintByte("PRIO  , %u", event.param2);
+        PrintByte(PRIO, Arg(ArgType::Number, event.param2));
         PrintWait(event.time);
         break;
     default:
@@ -414,10 +588,14 @@ void PrintControllerOp(const Event& event)
     }
 }
 
-void PrintAgbTrack(std::vector<Event>& events)
+void AgbWriter::PrintTrack(std::vector<Event>& events, int track, int midiChan, std::int32_t initialWait)
 {
-    std::fprintf(g_outputFile, "\n@**************** Track %u (Midi-Chn.%u) ****************@\n\n", g_agbTrack, g_midiChan + 1);
-    std::fprintf(g_outputFile, "%s_%u:\n", g_asmLabel.c_str(), g_agbTrack);
+    m_track = track;
+
+    if (!m_options->objectOutput)
+        std::fprintf(m_file, "\n@**************** Track %u (Midi-Chn.%u) ****************@\n\n", m_track, midiChan + 1);
+
+    PrintLabel("%s_%u", m_options->asmLabel.c_str(), m_track);
 
     int wholeNoteCount = 0;
     int loopEndBlockNum = 0;
@@ -439,10 +617,10 @@ void PrintAgbTrack(std::vector<Event>& events)
     }
 
     if (!foundVolBeforeNote)
-        PrintByte("\tVOL   , 127*%s_mvl/mxv", g_asmLabel.c_str());
+        PrintByte(VOL, Arg(ArgType::Volume, 127));
 
-    PrintWait(g_initialWait);
-    PrintByte("KEYSH , %s_key%+d", g_asmLabel.c_str(), 0);
+    PrintWait(initialWait);
+    PrintByte(KEYSH, Arg(ArgType::KeyShift, 0));
 
     for (unsigned i = 0; events[i].type != EventType::EndOfTrack; i++)
     {
@@ -450,13 +628,17 @@ void PrintAgbTrack(std::vector<Event>& events)
 
         if (IsPatternBoundary(event.type))
         {
-            if (s_inPattern)
-                PrintByte("PEND");
-            s_inPattern = false;
+            if (m_inPattern)
+                PrintByte(PEND);
+            m_inPattern = false;
         }
 
         if (event.type == EventType::WholeNoteMark || event.type == EventType::Pattern)
-            std::fprintf(g_outputFile, "@ %03d   ----------------------------------------\n", wholeNoteCount++);
+        {
+            if (!m_options->objectOutput)
+                std::fprintf(m_file, "@ %03d   ----------------------------------------\n", wholeNoteCount);
+            wholeNoteCount++;
+        }
 
         switch (event.type)
         {
@@ -470,32 +652,32 @@ void PrintAgbTrack(std::vector<Event>& events)
             PrintSeqLoopLabel(event);
             break;
         case EventType::LoopEnd:
-            PrintByte("GOTO");
-            PrintWord("%s_%u_B%u", g_asmLabel.c_str(), g_agbTrack, loopEndBlockNum);
+            PrintByte(GOTO);
+            PrintWord("%s_%u_B%u", m_options->asmLabel.c_str(), m_track, loopEndBlockNum);
             PrintSeqLoopLabel(event);
             break;
         case EventType::LoopEndBegin:
-            PrintByte("GOTO");
-            PrintWord("%s_%u_B%u", g_asmLabel.c_str(), g_agbTrack, loopEndBlockNum);
+            PrintByte(GOTO);
+            PrintWord("%s_%u_B%u", m_options->asmLabel.c_str(), m_track, loopEndBlockNum);
             PrintSeqLoopLabel(event);
-            loopEndBlockNum = s_blockNum;
+            loopEndBlockNum = m_blockNum;
             break;
         case EventType::LoopBegin:
             PrintSeqLoopLabel(event);
-            loopEndBlockNum = s_blockNum;
+            loopEndBlockNum = m_blockNum;
             break;
         case EventType::WholeNoteMark:
             if (event.param2 & 0x80000000)
             {
-                std::fprintf(g_outputFile, "%s_%u_%03lu:\n", g_asmLabel.c_str(), g_agbTrack, (unsigned long)(event.param2 & 0x7FFFFFFF));
+                PrintLabel("%s_%u_%03lu", m_options->asmLabel.c_str(), m_track, (unsigned long)(event.param2 & 0x7FFFFFFF));
                 ResetTrackVars();
-                s_inPattern = true;
+                m_inPattern = true;
             }
             PrintWait(event.time);
             break;
         case EventType::Pattern:
-            PrintByte("PATT");
-            PrintWord("%s_%u_%03lu", g_asmLabel.c_str(), g_agbTrack, event.param2);
+            PrintByte(PATT);
+            PrintWord("%s_%u_%03lu", m_options->asmLabel.c_str(), m_track, event.param2);
 
             while (!IsPatternBoundary(events[i + 1].type))
                 i++;
@@ -503,14 +685,14 @@ void PrintAgbTrack(std::vector<Event>& events)
             ResetTrackVars();
             break;
         case EventType::Tempo:
-            PrintByte("TEMPO , %u*%s_tbs/2", 60000000 / event.param2, g_asmLabel.c_str());
+            PrintByte(TEMPO, Arg(ArgType::Tempo, 60000000 / event.param2));
             PrintWait(event.time);
             break;
         case EventType::InstrumentChange:
-            PrintOp(event.time, "VOICE ", "%u", event.param1);
+            PrintOp(event.time, VOICE, Arg(ArgType::Number, event.param1));
             break;
         case EventType::PitchBend:
-            PrintOp(event.time, "BEND  ", "c_v%+d", event.param2 - 64);
+            PrintOp(event.time, BEND, Arg(ArgType::CenterValue, event.param2));
             break;
         case EventType::Controller:
             PrintControllerOp(event);
@@ -521,27 +703,44 @@ void PrintAgbTrack(std::vector<Event>& events)
         }
     }
 
-    PrintByte("FINE");
+    PrintByte(FINE);
 }
 
-void PrintAgbFooter()
+void AgbWriter::PrintFooter(int trackCount)
 {
-    int trackCount = g_agbTrack - 1;
-
-    std::fprintf(g_outputFile, "\n@******************************************************@\n");
-    std::fprintf(g_outputFile, "\t.align\t2\n");
-    std::fprintf(g_outputFile, "\n%s:\n", g_asmLabel.c_str());
-    std::fprintf(g_outputFile, "\t.byte\t%u\t@ NumTrks\n", trackCount);
-    std::fprintf(g_outputFile, "\t.byte\t%u\t@ NumBlks\n", 0);
-    std::fprintf(g_outputFile, "\t.byte\t%s_pri\t@ Priority\n", g_asmLabel.c_str());
-    std::fprintf(g_outputFile, "\t.byte\t%s_rev\t@ Reverb.\n", g_asmLabel.c_str());
-    std::fprintf(g_outputFile, "\n");
-    std::fprintf(g_outputFile, "\t.word\t%s_grp\n", g_asmLabel.c_str());
-    std::fprintf(g_outputFile, "\n");
+    if (m_options->objectOutput)
+    {
+        while (m_object.data.size() % 4 != 0)
+            EmitByte(0);
+
+        m_object.labels.push_back({ m_options->asmLabel, (std::uint32_t)m_object.data.size(), true });
+        EmitByte(trackCount);
+        EmitByte(0);
+        EmitByte(m_options->priority);
+        EmitByte(m_options->reverb >= 0 ? 0x80 + m_options->reverb : 0); // reverb_set+m_options->reverb
+        PrintWord("voicegroup%03u", m_options->voiceGroup);
+
+        for (int i = 1; i <= trackCount; i++)
+            PrintWord("%s_%u", m_options->asmLabel.c_str(), i);
+
+        WriteElfObject(m_file, m_object);
+        return;
+    }
+
+    std::fprintf(m_file, "\n@******************************************************@\n");
+    std::fprintf(m_file, "\t.align\t2\n");
+    std::fprintf(m_file, "\n%s:\n", m_options->asmLabel.c_str());
+    std::fprintf(m_file, "\t.byte\t%u\t@ NumTrks\n", trackCount);
+    std::fprintf(m_file, "\t.byte\t%u\t@ NumBlks\n", 0);
+    std::fprintf(m_file, "\t.byte\t%s_pri\t@ Priority\n", m_options->asmLabel.c_str());
+    std::fprintf(m_file, "\t.byte\t%s_rev\t@ Reverb.\n", m_options->asmLabel.c_str());
+    std::fprintf(m_file, "\n");
+    std::fprintf(m_file, "\t.word\t%s_grp\n", m_options->asmLabel.c_str());
+    std::fprintf(m_file, "\n");
 
     // track pointers
     for (int i = 1; i <= trackCount; i++)
-        std::fprintf(g_outputFile, "\t.word\t%s_%u\n", g_asmLabel.c_str(), i);
+        std::fprintf(m_file, "\t.word\t%s_%u\n", m_options->asmLabel.c_str(), i);
 
-    std::fprintf(g_outputFile, "\n\t.end\n");
+    std::fprintf(m_file, "\n\t.end\n");
 }
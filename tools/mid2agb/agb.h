@@ -21,13 +21,89 @@
 #ifndef AGB_H
 #define AGB_H
 
+#include <cstdint>
+#include <cstdio>
 #include <vector>
+#include "elf.h"
+#include "main.h"
 #include "midi.h"
 
-void PrintAgbHeader();
-void PrintAgbTrack(std::vector<Event>& events);
-void PrintAgbFooter();
+// Writes a song's tracks as assembly using the definitions in MPlayDef.s,
+// or as the object file the assembler would make of it.
+class AgbWriter
+{
+public:
+    void Start(std::FILE *file, const Options& options);
+    void PrintHeader();
+    void PrintTrack(std::vector<Event>& events, int track, int midiChan, std::int32_t initialWait);
+    void PrintFooter(int trackCount);
 
-extern int g_agbTrack;
+private:
+    // An operand of a track command. It's kept as a value so that it can be
+    // written either as the expression the assembler would evaluate or as
+    // the byte that the expression gives.
+    enum class ArgType
+    {
+        None,
+        Number,
+        Hex,
+        Note,
+        Velocity,
+        GateTime,
+        CenterValue,
+        Volume,
+        KeyShift,
+        Tempo,
+        MemAccOp,
+        ExtendedCommand,
+    };
+
+    struct Arg
+    {
+        ArgType type;
+        int value;
+
+        Arg() : type(ArgType::None), value(0) {}
+        Arg(ArgType type, int value) : type(type), value(value) {}
+    };
+
+    void PrintOpName(int op);
+    void PrintArg(const Arg& arg);
+    int ArgValue(const Arg& arg);
+    void EmitByte(int value);
+    void PrintCommand(const char *prefix, int op, bool withOp, const Arg& arg1, const Arg& arg2, const Arg& arg3);
+    void PrintLabel(const char *format, ...);
+    void ResetTrackVars();
+    void PrintWait(int wait);
+    void PrintOp(int wait, int op, const Arg& arg1 = Arg(), const Arg& arg2 = Arg(), const Arg& arg3 = Arg());
+    void PrintByte(int op, const Arg& arg1 = Arg(), const Arg& arg2 = Arg(), const Arg& arg3 = Arg());
+    void PrintWord(const char *format, ...);
+    void PrintNote(const Event& event);
+    void PrintEndOfTieOp(const Event& event);
+    void PrintSeqLoopLabel(const Event& event);
+    void PrintMemAcc(const Event& event);
+    void PrintExtendedOp(const Event& event);
+    void PrintControllerOp(const Event& event);
+
+    std::FILE *m_file;
+    const Options *m_options;
+    int m_track;
+
+    int m_lastOp;
+    int m_blockNum;
+    bool m_keepLastOpName;
+    int m_lastNote;
+    int m_lastVelocity;
+    bool m_noteChanged;
+    bool m_velocityChanged;
+    bool m_inPattern;
+    int m_extendedCommand;
+    int m_memaccOp;
+    int m_memaccParam1;
+    int m_memaccParam2;
+
+    // The song, when it's written as an object file instead of assembly.
+    ElfObject m_object;
+};
 
 #endif // AGB_H
@@ -0,0 +1,50 @@
+#!/bin/bash
+# Converts every MIDI file in sound/songs/midi with the options songs.mk
+# gives it, and reports the time taken and the total size of the .s output.
+# Given a second mid2agb, it also converts with that one and checks that the
+# output is identical.
+#
+# Usage (from the repository root):
+#     tools/mid2agb/bench.sh [MID2AGB] [REFERENCE_MID2AGB]
+
+mid2agb=${1:-tools/mid2agb/mid2agb}
+reference=$2
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+reverb=$(sed -n 's/^STD_REVERB = //p' songs.mk)
+
+# "name options" for each song that songs.mk has options for.
+sed -n 's/^$(MID_BUILDDIR)\/\([^ ]*\)\.o .*MID_FLAGS := *\(.*\)$/\1 \2/p' songs.mk |
+    sed "s/\$(STD_REVERB)/$reverb/g" > "$workdir/songs"
+
+convert() {
+    local tool=$1 outdir=$2
+    mkdir -p "$outdir"
+    while read -r name options; do
+        [ -f "sound/songs/midi/$name.mid" ] || continue
+        # shellcheck disable=SC2086
+        "$tool" "sound/songs/midi/$name.mid" "$outdir/$name.s" $options || exit 1
+    done < "$workdir/songs"
+}
+
+report() {
+    local tool=$1 outdir=$2 start end
+    start=$(date +%s%N)
+    convert "$tool" "$outdir"
+    end=$(date +%s%N)
+    printf "%-32s %4d files  %8.3f s  %10d bytes\n" "$tool" \
+        "$(ls "$outdir" | wc -l)" "$(( (end - start) / 1000000 ))e-3" \
+        "$(cat "$outdir"/*.s | wc -c)"
+}
+
+report "$mid2agb" "$workdir/out"
+
+if [ -n "$reference" ]; then
+    report "$reference" "$workdir/reference"
+    if diff -r -q "$workdir/reference" "$workdir/out"; then
+        echo "outputs are identical"
+    else
+        exit 1
+    fi
+fi
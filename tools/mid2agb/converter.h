@@ -0,0 +1,113 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef CONVERTER_H
+#define CONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "agb.h"
+#include "main.h"
+#include "midi.h"
+
+// Converts MIDI files to songs. A converter keeps its buffers from one song
+// to the next, so one that converts a batch of songs stops allocating once
+// they're big enough. Converters share nothing, so several can run at once.
+class Converter
+{
+public:
+    void Convert(const std::string& inputFilename, const std::string& outputFilename, const Options& options);
+
+private:
+    void ReadInputFile(const std::string& filename);
+    void Seek(std::size_t offset);
+    void Skip(std::size_t offset);
+    std::string ReadSignature();
+    std::uint32_t ReadInt8();
+    std::uint32_t ReadInt16();
+    std::uint32_t ReadInt24();
+    std::uint32_t ReadInt32();
+    std::uint32_t ReadVLQ();
+
+    void ReadMidiFileHeader();
+    std::size_t ReadMidiTrackHeader(std::size_t offset);
+    void StartTrack();
+    void SkipEventData();
+    void DetermineEventCategory(MidiEventCategory& category, int& typeChan, int& size);
+    void MakeBlockEvent(Event& event, EventType type);
+    std::string ReadEventText();
+    bool ReadSeqEvent(Event& event);
+    void ReadSeqEvents();
+    bool CheckNoteEnd(Event& event);
+    void FindNoteEnd(Event& event);
+    bool ReadTrackEvent(Event& event);
+    void ReadTrackEvents();
+
+    void MergeEvents();
+    void AddEvent(Event event);
+    void InsertTimingEvents(const Event& event);
+    void CreateTies(const Event& event);
+    void SortEvents();
+    void SplitTime();
+    void CalculateWaits();
+    void Compress();
+    void ReadMidiTracks();
+
+    const Options *m_options;
+    AgbWriter m_writer;
+
+    std::vector<std::uint8_t> m_input;
+    std::size_t m_pos;
+
+    MidiFormat m_midiFormat;
+    int m_midiTrackCount;
+    std::int16_t m_midiTimeDiv;
+    int m_midiChan;
+    int m_agbTrack;
+    std::int32_t m_initialWait;
+
+    std::size_t m_trackDataStart;
+    std::int32_t m_absoluteTime;
+    int m_blockCount;
+    int m_minNote;
+    int m_maxNote;
+    int m_runningStatus;
+
+    // The track's events go through these as they're converted: each pass
+    // reads m_events and fills m_scratch, then the two are swapped.
+    std::vector<Event> m_seqEvents;
+    std::vector<Event> m_trackEvents;
+    std::vector<Event> m_events;
+    std::vector<Event> m_scratch;
+    Event m_timingEvent;
+
+    struct Original
+    {
+        int index;
+        bool worthCompressing;
+    };
+
+    std::unordered_map<std::uint64_t, std::vector<Original>> m_originals;
+};
+
+#endif // CONVERTER_H
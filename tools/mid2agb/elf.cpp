@@ -0,0 +1,233 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "elf.h"
+#include "error.h"
+
+// Just enough of the ELF format for a relocatable ARM object with one
+// .rodata section. Local labels are relocated against the section symbol,
+// with the label's offset stored in the word itself, like the assembler does.
+
+enum
+{
+    SectionRodata = 1,
+    SectionRelRodata,
+    SectionSymtab,
+    SectionStrtab,
+    SectionShstrtab,
+    SectionCount
+};
+
+enum
+{
+    STB_LOCAL = 0,
+    STB_GLOBAL = 1,
+    STT_NOTYPE = 0,
+    STT_SECTION = 3,
+    SHT_PROGBITS = 1,
+    SHT_SYMTAB = 2,
+    SHT_STRTAB = 3,
+    SHT_REL = 9,
+    SHF_ALLOC = 0x2,
+    SHF_INFO_LINK = 0x40,
+    R_ARM_ABS32 = 2,
+};
+
+static const int ElfHeaderSize = 52;
+static const int SectionHeaderSize = 40;
+static const int SymbolSize = 16;
+static const int RelocationSize = 8;
+
+static void Put16(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    out.push_back(value & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+}
+
+static void Put32(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    Put16(out, value & 0xFFFF);
+    Put16(out, value >> 16);
+}
+
+static void Align(std::vector<std::uint8_t>& out, std::size_t alignment)
+{
+    while (out.size() % alignment != 0)
+        out.push_back(0);
+}
+
+static std::uint32_t AddString(std::vector<std::uint8_t>& table, const std::string& s)
+{
+    std::uint32_t offset = table.size();
+    table.insert(table.end(), s.begin(), s.end());
+    table.push_back(0);
+    return offset;
+}
+
+static void PutSymbol(std::vector<std::uint8_t>& out, std::uint32_t name, std::uint32_t value, int bind, int type, int section)
+{
+    Put32(out, name);
+    Put32(out, value);
+    Put32(out, 0);
+    out.push_back((bind << 4) | type);
+    out.push_back(0);
+    Put16(out, section);
+}
+
+static void PutSectionHeader(std::vector<std::uint8_t>& out, std::uint32_t name, std::uint32_t type, std::uint32_t flags,
+    std::uint32_t offset, std::uint32_t size, std::uint32_t link, std::uint32_t info, std::uint32_t alignment, std::uint32_t entrySize)
+{
+    Put32(out, name);
+    Put32(out, type);
+    Put32(out, flags);
+    Put32(out, 0);
+    Put32(out, offset);
+    Put32(out, size);
+    Put32(out, link);
+    Put32(out, info);
+    Put32(out, alignment);
+    Put32(out, entrySize);
+}
+
+void WriteElfObject(std::FILE *file, const ElfObject& object)
+{
+    std::vector<std::uint8_t> data = object.data;
+    std::vector<std::uint8_t> strtab(1, 0);
+    std::vector<std::uint8_t> symtab;
+    std::vector<std::uint8_t> rel;
+    std::map<std::string, std::uint32_t> labelOffsets;
+    std::map<std::string, std::uint32_t> externalSymbols;
+
+    for (const ElfObject::Label& label : object.labels)
+        labelOffsets[label.name] = label.offset;
+
+    PutSymbol(symtab, 0, 0, STB_LOCAL, STT_NOTYPE, 0);
+    PutSymbol(symtab, 0, 0, STB_LOCAL, STT_SECTION, SectionRodata);
+
+    std::uint32_t symbolCount = 2;
+
+    for (const ElfObject::Label& label : object.labels)
+    {
+        if (!label.global)
+        {
+            PutSymbol(symtab, AddString(strtab, label.name), label.offset, STB_LOCAL, STT_NOTYPE, SectionRodata);
+            symbolCount++;
+        }
+    }
+
+    std::uint32_t firstGlobal = symbolCount;
+
+    for (const ElfObject::Label& label : object.labels)
+    {
+        if (label.global)
+        {
+            PutSymbol(symtab, AddString(strtab, label.name), label.offset, STB_GLOBAL, STT_NOTYPE, SectionRodata);
+            symbolCount++;
+        }
+    }
+
+    for (const ElfObject::Reference& reference : object.references)
+    {
+        if (reference.offset + 4 > data.size())
+            RaiseError("reference to \"%s\" is past the end of the data", reference.name.c_str());
+
+        std::uint32_t symbol = 1;
+        std::uint32_t addend = 0;
+        auto label = labelOffsets.find(reference.name);
+
+        if (label != labelOffsets.end())
+        {
+            addend = label->second;
+        }
+        else
+        {
+            auto external = externalSymbols.find(reference.name);
+
+            if (external == externalSymbols.end())
+            {
+                PutSymbol(symtab, AddString(strtab, reference.name), 0, STB_GLOBAL, STT_NOTYPE, 0);
+                external = externalSymbols.emplace(reference.name, symbolCount++).first;
+            }
+
+            symbol = external->second;
+        }
+
+        for (int i = 0; i < 4; i++)
+            data[reference.offset + i] = (addend >> (8 * i)) & 0xFF;
+
+        Put32(rel, reference.offset);
+        Put32(rel, (symbol << 8) | R_ARM_ABS32);
+    }
+
+    std::vector<std::uint8_t> shstrtab(1, 0);
+    std::uint32_t rodataName = AddString(shstrtab, ".rodata");
+    std::uint32_t relRodataName = AddString(shstrtab, ".rel.rodata");
+    std::uint32_t symtabName = AddString(shstrtab, ".symtab");
+    std::uint32_t strtabName = AddString(shstrtab, ".strtab");
+    std::uint32_t shstrtabName = AddString(shstrtab, ".shstrtab");
+
+    std::vector<std::uint8_t> out(ElfHeaderSize, 0);
+    std::uint32_t rodataOffset = out.size();
+    out.insert(out.end(), data.begin(), data.end());
+    Align(out, 4);
+    std::uint32_t relOffset = out.size();
+    out.insert(out.end(), rel.begin(), rel.end());
+    std::uint32_t symtabOffset = out.size();
+    out.insert(out.end(), symtab.begin(), symtab.end());
+    std::uint32_t strtabOffset = out.size();
+    out.insert(out.end(), strtab.begin(), strtab.end());
+    std::uint32_t shstrtabOffset = out.size();
+    out.insert(out.end(), shstrtab.begin(), shstrtab.end());
+    Align(out, 4);
+    std::uint32_t sectionHeadersOffset = out.size();
+
+    PutSectionHeader(out, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    PutSectionHeader(out, rodataName, SHT_PROGBITS, SHF_ALLOC, rodataOffset, data.size(), 0, 0, 4, 0);
+    PutSectionHeader(out, relRodataName, SHT_REL, SHF_INFO_LINK, relOffset, rel.size(), SectionSymtab, SectionRodata, 4, RelocationSize);
+    PutSectionHeader(out, symtabName, SHT_SYMTAB, 0, symtabOffset, symtab.size(), SectionStrtab, firstGlobal, 4, SymbolSize);
+    PutSectionHeader(out, strtabName, SHT_STRTAB, 0, strtabOffset, strtab.size(), 0, 0, 1, 0);
+    PutSectionHeader(out, shstrtabName, SHT_STRTAB, 0, shstrtabOffset, shstrtab.size(), 0, 0, 1, 0);
+
+    std::vector<std::uint8_t> header;
+    const std::uint8_t ident[16] = { 0x7F, 'E', 'L', 'F', 1, 1, 1 }; // 32-bit, little-endian, version 1
+    header.insert(header.end(), ident, ident + 16);
+    Put16(header, 1);           // ET_REL
+    Put16(header, 40);          // EM_ARM
+    Put32(header, 1);           // EV_CURRENT
+    Put32(header, 0);           // entry point
+    Put32(header, 0);           // program headers
+    Put32(header, sectionHeadersOffset);
+    Put32(header, 0x05000000);  // EF_ARM_EABI_VER5
+    Put16(header, ElfHeaderSize);
+    Put16(header, 0);
+    Put16(header, 0);
+    Put16(header, SectionHeaderSize);
+    Put16(header, SectionCount);
+    Put16(header, SectionShstrtab);
+    std::memcpy(out.data(), header.data(), ElfHeaderSize);
+
+    if (std::fwrite(out.data(), 1, out.size(), file) != out.size())
+        RaiseError("failed to write object file");
+}
@@ -0,0 +1,55 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ELF_H
+#define ELF_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// The contents of a .rodata section, as the assembler would have produced
+// them from mid2agb's assembly output.
+struct ElfObject
+{
+    struct Label
+    {
+        std::string name;
+        std::uint32_t offset;
+        bool global;
+    };
+
+    // A 32-bit word that holds the address of a label, or of a symbol
+    // defined in another object.
+    struct Reference
+    {
+        std::uint32_t offset;
+        std::string name;
+    };
+
+    std::vector<std::uint8_t> data;
+    std::vector<Label> labels;
+    std::vector<Reference> references;
+};
+
+void WriteElfObject(std::FILE *file, const ElfObject& object);
+
+#endif // ELF_H
@@ -21,6 +21,19 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstdarg>
+#include "error.h"
+
+static thread_local const char *s_errorFilename;
+
+ErrorContext::ErrorContext(const std::string& filename) : m_previous(s_errorFilename)
+{
+    s_errorFilename = filename.c_str();
+}
+
+ErrorContext::~ErrorContext()
+{
+    s_errorFilename = m_previous;
+}
 
 // Reports an error diagnostic and terminates the program.
 [[noreturn]] void RaiseError(const char* format, ...)
@@ -30,7 +43,10 @@
     std::va_list args;
     va_start(args, format);
     std::vsnprintf(buffer, bufferSize, format, args);
-    std::fprintf(stderr, "error: %s\n", buffer);
+    if (s_errorFilename != nullptr)
+        std::fprintf(stderr, "error: %s: %s\n", s_errorFilename, buffer);
+    else
+        std::fprintf(stderr, "error: %s\n", buffer);
     va_end(args);
     std::exit(1);
 }
@@ -21,6 +21,20 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include <string>
+
 [[noreturn]] void RaiseError(const char* format, ...);
 
+// While one of these exists, errors raised on its thread name its file, so
+// that it's clear which song failed when several are converted at once.
+class ErrorContext
+{
+public:
+    explicit ErrorContext(const std::string& filename);
+    ~ErrorContext();
+
+private:
+    const char *m_previous;
+};
+
 #endif // ERROR_H
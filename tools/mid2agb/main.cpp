@@ -22,25 +22,22 @@
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
-#include <cassert>
+#include <atomic>
+#include <fstream>
+#include <sstream>
 #include <string>
-#include <set>
+#include <thread>
+#include <vector>
 #include "main.h"
 #include "error.h"
-#include "midi.h"
-#include "agb.h"
+#include "converter.h"
 
-FILE* g_inputFile = nullptr;
-FILE* g_outputFile = nullptr;
-
-std::string g_asmLabel;
-int g_masterVolume = 127;
-int g_voiceGroup = 0;
-int g_priority = 0;
-int g_reverb = -1;
-int g_clocksPerBeat = 1;
-bool g_exactGateTime = false;
-bool g_compressionEnabled = true;
+struct Song
+{
+    std::string inputFilename;
+    std::string outputFilename;
+    Options options;
+};
 
 [[noreturn]] static void PrintUsage()
 {
@@ -48,7 +45,7 @@ bool g_compressionEnabled = true;
         "Usage: MID2AGB name [options]\n"
         "\n"
         "    input_file  filename(.mid) of MIDI file\n"
-        "   output_file  filename(.s) for AGB file (default:input_file)\n"
+        "   output_file  filename(.s) for AGB file, or (.o) for object (default:input_file)\n"
         "\n"
         "options  -L???  label for assembler (default:output_file)\n"
         "         -V???  master volume (default:127)\n"
@@ -58,6 +55,11 @@ bool g_compressionEnabled = true;
         "            -X  48 clocks/beat (default:24 clocks/beat)\n"
         "            -E  exact gate-time\n"
         "            -N  no compression\n"
+        "\n"
+        "       MID2AGB --batch [-j threads] list_file\n"
+        "\n"
+        "    Converts each song in list_file, which has one per line as\n"
+        "    \"input_file output_file [options]\", on several threads.\n"
     );
     std::exit(1);
 }
@@ -102,24 +104,19 @@ static std::string BaseName(std::string s)
     return s;
 }
 
-static const char *GetArgument(int argc, char **argv, int& index)
+static const char *GetArgument(const std::vector<std::string>& args, std::size_t& index)
 {
-    assert(index >= 0 && index < argc);
-
-    const char *option = argv[index];
-
-    assert(option != nullptr);
-    assert(option[0] == '-');
+    const std::string& option = args[index];
 
     // If there is text following the letter, return that.
-    if (std::strlen(option) >= 3)
-        return option + 2;
+    if (option.size() >= 3)
+        return option.c_str() + 2;
 
     // Otherwise, try to get the next arg.
-    if (index + 1 < argc)
+    if (index + 1 < args.size())
     {
         index++;
-        return argv[index];
+        return args[index].c_str();
     }
     else
     {
@@ -127,14 +124,14 @@ static const char *GetArgument(int argc, char **argv, int& index)
     }
 }
 
-int main(int argc, char** argv)
+static Song ParseSong(const std::vector<std::string>& args)
 {
-    std::string inputFilename;
-    std::string outputFilename;
+    Song song;
+    Options& options = song.options;
 
-    for (int i = 1; i < argc; i++)
+    for (std::size_t i = 0; i < args.size(); i++)
     {
-        const char *option = argv[i];
+        const char *option = args[i].c_str();
 
         if (option[0] == '-' && option[1] != '\0')
         {
@@ -143,43 +140,43 @@ int main(int argc, char** argv)
             switch (std::toupper(option[1]))
             {
             case 'E':
-                g_exactGateTime = true;
+                options.exactGateTime = true;
                 break;
             case 'G':
-                arg = GetArgument(argc, argv, i);
+                arg = GetArgument(args, i);
                 if (arg == nullptr)
                     PrintUsage();
-                g_voiceGroup = std::stoi(arg);
+                options.voiceGroup = std::stoi(arg);
                 break;
             case 'L':
-                arg = GetArgument(argc, argv, i);
+                arg = GetArgument(args, i);
                 if (arg == nullptr)
                     PrintUsage();
-                g_asmLabel = arg;
+                options.asmLabel = arg;
                 break;
             case 'N':
-                g_compressionEnabled = false;
+                options.compressionEnabled = false;
                 break;
             case 'P':
-                arg = GetArgument(argc, argv, i);
+                arg = GetArgument(args, i);
                 if (arg == nullptr)
                     PrintUsage();
-                g_priority = std::stoi(arg);
+                options.priority = std::stoi(arg);
                 break;
             case 'R':
-                arg = GetArgument(argc, argv, i);
+                arg = GetArgument(args, i);
                 if (arg == nullptr)
                     PrintUsage();
-                g_reverb = std::stoi(arg);
+                options.reverb = std::stoi(arg);
                 break;
             case 'V':
-                arg = GetArgument(argc, argv, i);
+                arg = GetArgument(args, i);
                 if (arg == nullptr)
                     PrintUsage();
-                g_masterVolume = std::stoi(arg);
+                options.masterVolume = std::stoi(arg);
                 break;
             case 'X':
-                g_clocksPerBeat = 2;
+                options.clocksPerBeat = 2;
                 break;
             default:
                 PrintUsage();
@@ -187,47 +184,112 @@ int main(int argc, char** argv)
         }
         else
         {
-            if (inputFilename.empty())
-                inputFilename = argv[i];
-            else if (outputFilename.empty())
-                outputFilename = argv[i];
+            if (song.inputFilename.empty())
+                song.inputFilename = option;
+            else if (song.outputFilename.empty())
+                song.outputFilename = option;
             else
                 PrintUsage();
         }
     }
 
-    if (inputFilename.empty())
+    if (song.inputFilename.empty())
         PrintUsage();
 
-    if (GetExtension(inputFilename) != "mid")
+    if (GetExtension(song.inputFilename) != "mid")
         RaiseError("input filename extension is not \"mid\"");
 
-    if (outputFilename.empty())
-        outputFilename = StripExtension(inputFilename) + ".s";
+    if (song.outputFilename.empty())
+        song.outputFilename = StripExtension(song.inputFilename) + ".s";
+
+    if (GetExtension(song.outputFilename) == "o")
+        options.objectOutput = true;
+    else if (GetExtension(song.outputFilename) != "s")
+        RaiseError("output filename extension is not \"s\" or \"o\"");
+
+    if (options.asmLabel.empty())
+        options.asmLabel = BaseName(song.outputFilename);
+
+    return song;
+}
+
+static std::vector<Song> ReadSongList(const char *filename)
+{
+    std::ifstream file(filename);
 
-    if (GetExtension(outputFilename) != "s")
-        RaiseError("output filename extension is not \"s\"");
+    if (!file.is_open())
+        RaiseError("failed to open \"%s\" for reading", filename);
 
-    if (g_asmLabel.empty())
-        g_asmLabel = BaseName(outputFilename);
+    std::vector<Song> songs;
+    std::string line;
 
-    g_inputFile = std::fopen(inputFilename.c_str(), "rb");
+    while (std::getline(file, line))
+    {
+        std::istringstream words(line);
+        std::vector<std::string> args;
+        std::string word;
 
-    if (g_inputFile == nullptr)
-        RaiseError("failed to open \"%s\" for reading", inputFilename.c_str());
+        while (words >> word)
+            args.push_back(word);
 
-    g_outputFile = std::fopen(outputFilename.c_str(), "w");
+        if (!args.empty())
+            songs.push_back(ParseSong(args));
+    }
 
-    if (g_outputFile == nullptr)
-        RaiseError("failed to open \"%s\" for writing", outputFilename.c_str());
+    return songs;
+}
 
-    ReadMidiFileHeader();
-    PrintAgbHeader();
-    ReadMidiTracks();
-    PrintAgbFooter();
+// Converts the songs on numThreads threads, each with its own converter.
+static void ConvertSongs(const std::vector<Song>& songs, unsigned numThreads)
+{
+    std::atomic<std::size_t> nextSong(0);
+
+    auto worker = [&]() {
+        Converter converter;
+
+        for (std::size_t i = nextSong++; i < songs.size(); i = nextSong++)
+            converter.Convert(songs[i].inputFilename, songs[i].outputFilename, songs[i].options);
+    };
+
+    if (numThreads > songs.size())
+        numThreads = songs.size();
+
+    std::vector<std::thread> threads;
+
+    for (unsigned i = 1; i < numThreads; i++)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 2 && std::strcmp(argv[1], "--batch") == 0)
+    {
+        int arg = 2;
+        int numThreads = std::thread::hardware_concurrency();
+
+        if (arg + 1 < argc && std::strcmp(argv[arg], "-j") == 0)
+        {
+            numThreads = std::atoi(argv[arg + 1]);
+            if (numThreads < 1)
+                RaiseError("-j needs a positive thread count");
+            arg += 2;
+        }
+
+        if (argc != arg + 1)
+            PrintUsage();
+
+        ConvertSongs(ReadSongList(argv[arg]), numThreads > 0 ? numThreads : 1);
+        return 0;
+    }
 
-    std::fclose(g_inputFile);
-    std::fclose(g_outputFile);
+    Song song = ParseSong(std::vector<std::string>(argv + 1, argv + argc));
+    Converter converter;
+    converter.Convert(song.inputFilename, song.outputFilename, song.options);
 
     return 0;
 }
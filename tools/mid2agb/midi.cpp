@@ -20,73 +20,70 @@
 
 #include <cstdio>
 #include <cassert>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <memory>
+#include <unordered_map>
+#include "converter.h"
 #include "midi.h"
 #include "main.h"
 #include "error.h"
 #include "agb.h"
 #include "tables.h"
 
-enum class MidiEventCategory
+void Converter::ReadInputFile(const std::string& filename)
 {
-    Control,
-    SysEx,
-    Meta,
-    Invalid,
-};
+    std::FILE *file = std::fopen(filename.c_str(), "rb");
 
-MidiFormat g_midiFormat;
-std::int_fast32_t g_midiTrackCount;
-std::int16_t g_midiTimeDiv;
+    if (file == nullptr)
+        RaiseError("failed to open \"%s\" for reading", filename.c_str());
 
-int g_midiChan;
-std::int32_t g_initialWait;
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
 
-static long s_trackDataStart;
-static std::vector<Event> s_seqEvents;
-static std::vector<Event> s_trackEvents;
-static std::int32_t s_absoluteTime;
-static int s_blockCount = 0;
-static int s_minNote;
-static int s_maxNote;
-static int s_runningStatus;
+    if (size < 0)
+        RaiseError("failed to read \"%s\"", filename.c_str());
 
-void Seek(long offset)
-{
-    if (std::fseek(g_inputFile, offset, SEEK_SET) != 0)
-        RaiseError("failed to seek to %l", offset);
+    m_input.resize(size);
+
+    if (size > 0 && std::fread(m_input.data(), size, 1, file) != 1)
+        RaiseError("failed to read \"%s\"", filename.c_str());
+
+    std::fclose(file);
 }
 
-void Skip(long offset)
+// The whole file is in memory, so seeking can't fail; reading past the end
+// is what gets reported.
+void Converter::Seek(std::size_t offset)
 {
-    if (std::fseek(g_inputFile, offset, SEEK_CUR) != 0)
-        RaiseError("failed to skip %l bytes", offset);
+    m_pos = offset;
 }
 
-std::string ReadSignature()
+void Converter::Skip(std::size_t offset)
 {
-    char signature[4];
+    m_pos += offset;
+}
 
-    if (std::fread(signature, 4, 1, g_inputFile) != 1)
+std::string Converter::ReadSignature()
+{
+    if (m_pos > m_input.size() || m_input.size() - m_pos < 4)
         RaiseError("failed to read signature");
 
-    return std::string(signature, 4);
+    m_pos += 4;
+    return std::string((const char *)&m_input[m_pos - 4], 4);
 }
 
-std::uint32_t ReadInt8()
+std::uint32_t Converter::ReadInt8()
 {
-    int c = std::fgetc(g_inputFile);
-
-    if (c < 0)
+    if (m_pos >= m_input.size())
         RaiseError("unexpected EOF");
 
-    return c;
+    return m_input[m_pos++];
 }
 
-std::uint32_t ReadInt16()
+std::uint32_t Converter::ReadInt16()
 {
     std::uint32_t val = 0;
     val |= ReadInt8() << 8;
@@ -94,7 +91,7 @@ std::uint32_t ReadInt16()
     return val;
 }
 
-std::uint32_t ReadInt24()
+std::uint32_t Converter::ReadInt24()
 {
     std::uint32_t val = 0;
     val |= ReadInt8() << 16;
@@ -103,7 +100,7 @@ std::uint32_t ReadInt24()
     return val;
 }
 
-std::uint32_t ReadInt32()
+std::uint32_t Converter::ReadInt32()
 {
     std::uint32_t val = 0;
     val |= ReadInt8() << 24;
@@ -113,7 +110,7 @@ std::uint32_t ReadInt32()
     return val;
 }
 
-std::uint32_t ReadVLQ()
+std::uint32_t Converter::ReadVLQ()
 {
     std::uint32_t val = 0;
     std::uint32_t c;
@@ -128,7 +125,7 @@ std::uint32_t ReadVLQ()
     return val;
 }
 
-void ReadMidiFileHeader()
+void Converter::ReadMidiFileHeader()
 {
     Seek(0);
 
@@ -145,62 +142,62 @@ void ReadMidiFileHeader()
     if (midiFormat >= 2)
         RaiseError("unsupported MIDI format (%u)", midiFormat);
 
-    g_midiFormat = (MidiFormat)midiFormat;
-    g_midiTrackCount = ReadInt16();
-    g_midiTimeDiv = ReadInt16();
+    m_midiFormat = (MidiFormat)midiFormat;
+    m_midiTrackCount = ReadInt16();
+    m_midiTimeDiv = ReadInt16();
 
-    if (g_midiTimeDiv < 0)
-        RaiseError("unsupported MIDI time division (%d)", g_midiTimeDiv);
+    if (m_midiTimeDiv < 0)
+        RaiseError("unsupported MIDI time division (%d)", m_midiTimeDiv);
 }
 
-long ReadMidiTrackHeader(long offset)
+std::size_t Converter::ReadMidiTrackHeader(std::size_t offset)
 {
     Seek(offset);
 
     if (ReadSignature() != "MTrk")
         RaiseError("MIDI track header signature didn't match \"MTrk\"");
 
-    long size = ReadInt32();
+    std::size_t size = ReadInt32();
 
-    s_trackDataStart = std::ftell(g_inputFile);
+    m_trackDataStart = m_pos;
 
     return size + 8;
 }
 
-void StartTrack()
+void Converter::StartTrack()
 {
-    Seek(s_trackDataStart);
-    s_absoluteTime = 0;
-    s_runningStatus = 0;
+    Seek(m_trackDataStart);
+    m_absoluteTime = 0;
+    m_runningStatus = 0;
 }
 
-void SkipEventData()
+void Converter::SkipEventData()
 {
     Skip(ReadVLQ());
 }
 
-void DetermineEventCategory(MidiEventCategory& category, int& typeChan, int& size)
+void Converter::DetermineEventCategory(MidiEventCategory& category, int& typeChan, int& size)
 {
     typeChan = ReadInt8();
 
     if (typeChan < 0x80)
     {
         // If data byte was found, use the running status.
-        ungetc(typeChan, g_inputFile);
-        typeChan = s_runningStatus;
+        m_pos--;
+        typeChan = m_runningStatus;
     }
 
     if (typeChan == 0xFF)
     {
         category = MidiEventCategory::Meta;
         size = 0;
-        s_runningStatus = 0;
+        m_runningStatus = 0;
     }
     else if (typeChan >= 0xF0)
     {
         category = MidiEventCategory::SysEx;
         size = 0;
-        s_runningStatus = 0;
+        m_runningStatus = 0;
     }
     else if (typeChan >= 0x80)
     {
@@ -216,7 +213,7 @@ void DetermineEventCategory(MidiEventCategory& category, int& typeChan, int& siz
             size = 2;
             break;
         }
-        s_runningStatus = typeChan;
+        m_runningStatus = typeChan;
     }
     else
     {
@@ -224,36 +221,35 @@ void DetermineEventCategory(MidiEventCategory& category, int& typeChan, int& siz
     }
 }
 
-void MakeBlockEvent(Event& event, EventType type)
+void Converter::MakeBlockEvent(Event& event, EventType type)
 {
     event.type = type;
-    event.param1 = s_blockCount++;
+    event.param1 = m_blockCount++;
     event.param2 = 0;
 }
 
-std::string ReadEventText()
+std::string Converter::ReadEventText()
 {
-    char buffer[2];
     std::uint32_t length = ReadVLQ();
 
-    if (length <= 2)
-    {
-        if (fread(buffer, length, 1, g_inputFile) != 1)
-            RaiseError("failed to read event text");
-    }
-    else
+    if (length > 2)
     {
         Skip(length);
-        length = 0;
+        return std::string();
     }
 
-    return std::string(buffer, length);
+    // An empty text event is an error, as it was when this used fread.
+    if (length == 0 || m_pos > m_input.size() || m_input.size() - m_pos < length)
+        RaiseError("failed to read event text");
+
+    m_pos += length;
+    return std::string((const char *)&m_input[m_pos - length], length);
 }
 
-bool ReadSeqEvent(Event& event)
+bool Converter::ReadSeqEvent(Event& event)
 {
-    s_absoluteTime += ReadVLQ();
-    event.time = s_absoluteTime;
+    m_absoluteTime += ReadVLQ();
+    event.time = m_absoluteTime;
 
     MidiEventCategory category;
     int typeChan;
@@ -326,7 +322,7 @@ bool ReadSeqEvent(Event& event)
 
             Skip(2); // ignore other values
 
-            int clockTicks = 96 * numerator * g_clocksPerBeat;
+            int clockTicks = 96 * numerator * m_options->clocksPerBeat;
             int denominator = 1 << denominatorExponent;
             int timeSig = clockTicks / denominator;
 
@@ -347,17 +343,19 @@ bool ReadSeqEvent(Event& event)
     return true;
 }
 
-void ReadSeqEvents()
+void Converter::ReadSeqEvents()
 {
     StartTrack();
 
+    m_seqEvents.clear();
+
     for (;;)
     {
         Event event = {};
 
         if (ReadSeqEvent(event))
         {
-            s_seqEvents.push_back(event);
+            m_seqEvents.push_back(event);
 
             if (event.type == EventType::EndOfTrack)
                 return;
@@ -365,7 +363,7 @@ void ReadSeqEvents()
     }
 }
 
-bool CheckNoteEnd(Event& event)
+bool Converter::CheckNoteEnd(Event& event)
 {
     event.param2 += ReadVLQ();
 
@@ -379,7 +377,7 @@ bool CheckNoteEnd(Event& event)
     {
         int chan = typeChan & 0xF;
 
-        if (chan != g_midiChan)
+        if (chan != m_midiChan)
         {
             Skip(size);
             return false;
@@ -431,12 +429,12 @@ bool CheckNoteEnd(Event& event)
     RaiseError("invalid event");
 }
 
-void FindNoteEnd(Event& event)
+void Converter::FindNoteEnd(Event& event)
 {
     // Save the current file position and running status
     // which get modified by CheckNoteEnd.
-    long startPos = ftell(g_inputFile);
-    int savedRunningStatus = s_runningStatus;
+    std::size_t startPos = m_pos;
+    int savedRunningStatus = m_runningStatus;
 
     event.param2 = 0;
 
@@ -444,13 +442,13 @@ void FindNoteEnd(Event& event)
         ;
 
     Seek(startPos);
-    s_runningStatus = savedRunningStatus;
+    m_runningStatus = savedRunningStatus;
 }
 
-bool ReadTrackEvent(Event& event)
+bool Converter::ReadTrackEvent(Event& event)
 {
-    s_absoluteTime += ReadVLQ();
-    event.time = s_absoluteTime;
+    m_absoluteTime += ReadVLQ();
+    event.time = m_absoluteTime;
 
     MidiEventCategory category;
     int typeChan;
@@ -462,7 +460,7 @@ bool ReadTrackEvent(Event& event)
     {
         int chan = typeChan & 0xF;
 
-        if (chan != g_midiChan)
+        if (chan != m_midiChan)
         {
             Skip(size);
             return false;
@@ -483,10 +481,10 @@ bool ReadTrackEvent(Event& event)
                 FindNoteEnd(event);
                 if (event.param2 > 0)
                 {
-                    if (note < s_minNote)
-                        s_minNote = note;
-                    if (note > s_maxNote)
-                        s_maxNote = note;
+                    if (note < m_minNote)
+                        m_minNote = note;
+                    if (note > m_maxNote)
+                        m_maxNote = note;
                 }
             }
             break;
@@ -539,14 +537,14 @@ bool ReadTrackEvent(Event& event)
     RaiseError("invalid event");
 }
 
-void ReadTrackEvents()
+void Converter::ReadTrackEvents()
 {
     StartTrack();
 
-    s_trackEvents.clear();
+    m_trackEvents.clear();
 
-    s_minNote = 0xFF;
-    s_maxNote = 0;
+    m_minNote = 0xFF;
+    m_maxNote = 0;
 
     for (;;)
     {
@@ -554,7 +552,7 @@ void ReadTrackEvents()
 
         if (ReadTrackEvent(event))
         {
-            s_trackEvents.push_back(event);
+            m_trackEvents.push_back(event);
 
             if (event.type == EventType::EndOfTrack)
                 return;
@@ -562,7 +560,7 @@ void ReadTrackEvents()
     }
 }
 
-bool EventCompare(const Event& event1, const Event& event2)
+static bool EventCompare(const Event& event1, const Event& event2)
 {
     if (event1.time < event2.time)
         return true;
@@ -597,102 +595,162 @@ bool EventCompare(const Event& event1, const Event& event2)
     return false;
 }
 
-std::unique_ptr<std::vector<Event>> MergeEvents()
+// Merges the track's events with the sequence events into m_events. Each
+// event goes straight through the per-event steps that follow, rather than
+// each step making another copy of the track.
+void Converter::MergeEvents()
 {
-    std::unique_ptr<std::vector<Event>> events(new std::vector<Event>());
+    m_events.clear();
+
+    m_timingEvent = {};
+    m_timingEvent.time = 0;
+    m_timingEvent.type = EventType::TimeSignature;
+    m_timingEvent.param2 = 96 * m_options->clocksPerBeat;
 
     unsigned trackEventPos = 0;
     unsigned seqEventPos = 0;
 
-    while (s_trackEvents[trackEventPos].type != EventType::EndOfTrack
-        && s_seqEvents[seqEventPos].type != EventType::EndOfTrack)
+    while (m_trackEvents[trackEventPos].type != EventType::EndOfTrack
+        && m_seqEvents[seqEventPos].type != EventType::EndOfTrack)
     {
-        if (EventCompare(s_trackEvents[trackEventPos], s_seqEvents[seqEventPos]))
-            events->push_back(s_trackEvents[trackEventPos++]);
+        if (EventCompare(m_trackEvents[trackEventPos], m_seqEvents[seqEventPos]))
+            AddEvent(m_trackEvents[trackEventPos++]);
         else
-            events->push_back(s_seqEvents[seqEventPos++]);
+            AddEvent(m_seqEvents[seqEventPos++]);
     }
 
-    while (s_trackEvents[trackEventPos].type != EventType::EndOfTrack)
-        events->push_back(s_trackEvents[trackEventPos++]);
+    while (m_trackEvents[trackEventPos].type != EventType::EndOfTrack)
+        AddEvent(m_trackEvents[trackEventPos++]);
 
-    while (s_seqEvents[seqEventPos].type != EventType::EndOfTrack)
-        events->push_back(s_seqEvents[seqEventPos++]);
+    while (m_seqEvents[seqEventPos].type != EventType::EndOfTrack)
+        AddEvent(m_seqEvents[seqEventPos++]);
 
-    // Push the EndOfTrack event with the larger time.
-    if (EventCompare(s_trackEvents[trackEventPos], s_seqEvents[seqEventPos]))
-        events->push_back(s_seqEvents[seqEventPos]);
+    // Add the EndOfTrack event with the larger time.
+    if (EventCompare(m_trackEvents[trackEventPos], m_seqEvents[seqEventPos]))
+        AddEvent(m_seqEvents[seqEventPos]);
     else
-        events->push_back(s_trackEvents[trackEventPos]);
-
-    return events;
+        AddEvent(m_trackEvents[trackEventPos]);
 }
 
-void ConvertTimes(std::vector<Event>& events)
+// Converts the event's times to clocks, then passes it on.
+void Converter::AddEvent(Event event)
 {
-    for (Event& event : events)
+    event.time = (24 * m_options->clocksPerBeat * event.time) / m_midiTimeDiv;
+
+    if (event.type == EventType::Note)
     {
-        event.time = (24 * g_clocksPerBeat * event.time) / g_midiTimeDiv;
+        event.param1 = g_noteVelocityLUT[event.param1];
 
-        if (event.type == EventType::Note)
-        {
-            event.param1 = g_noteVelocityLUT[event.param1];
+        std::uint32_t duration = (24 * m_options->clocksPerBeat * event.param2) / m_midiTimeDiv;
 
-            std::uint32_t duration = (24 * g_clocksPerBeat * event.param2) / g_midiTimeDiv;
+        if (duration == 0)
+            duration = 1;
 
-            if (duration == 0)
-                duration = 1;
+        if (!m_options->exactGateTime && duration < 96)
+            duration = g_noteDurationLUT[duration];
 
-            if (!g_exactGateTime && duration < 96)
-                duration = g_noteDurationLUT[duration];
+        event.param2 = duration;
+    }
 
-            event.param2 = duration;
+    InsertTimingEvents(event);
+}
+
+// Adds a timing event at the start of every bar before the event.
+void Converter::InsertTimingEvents(const Event& event)
+{
+    while (EventCompare(m_timingEvent, event))
+    {
+        CreateTies(m_timingEvent);
+        m_timingEvent.time += m_timingEvent.param2;
+    }
+
+    if (event.type == EventType::TimeSignature)
+    {
+        if (m_agbTrack == 1 && event.param2 != m_timingEvent.param2)
+        {
+            Event originalTimingEvent = event;
+            originalTimingEvent.type = EventType::OriginalTimeSignature;
+            CreateTies(originalTimingEvent);
         }
+        m_timingEvent.param2 = event.param2;
+        m_timingEvent.time = event.time + m_timingEvent.param2;
     }
+
+    CreateTies(event);
 }
 
-std::unique_ptr<std::vector<Event>> InsertTimingEvents(std::vector<Event>& inEvents)
+// Adds the event to m_events, as a tie and an end of tie if it's a note
+// longer than a whole note.
+void Converter::CreateTies(const Event& event)
 {
-    std::unique_ptr<std::vector<Event>> outEvents(new std::vector<Event>());
+    if (event.type == EventType::Note && event.param2 > 96)
+    {
+        Event tieEvent = event;
+        tieEvent.param2 = -1;
+        m_events.push_back(tieEvent);
+
+        Event eotEvent = {};
+        eotEvent.time = event.time + event.param2;
+        eotEvent.type = EventType::EndOfTie;
+        eotEvent.note = event.note;
+        m_events.push_back(eotEvent);
+    }
+    else
+    {
+        m_events.push_back(event);
+    }
+}
 
-    Event timingEvent = {};
-    timingEvent.time = 0;
-    timingEvent.type = EventType::TimeSignature;
-    timingEvent.param2 = 96 * g_clocksPerBeat;
+// A stable sort of m_events, like std::stable_sort, but it merges through
+// m_scratch instead of a buffer of its own. The events are mostly in order
+// already, apart from the end of tie events, so merging the runs that are
+// already sorted takes only a few passes.
+void Converter::SortEvents()
+{
+    std::size_t size = m_events.size();
+    m_scratch.resize(size);
 
-    for (const Event& event : inEvents)
+    for (;;)
     {
-        while (EventCompare(timingEvent, event))
-        {
-            outEvents->push_back(timingEvent);
-            timingEvent.time += timingEvent.param2;
-        }
+        std::size_t runCount = 0;
 
-        if (event.type == EventType::TimeSignature)
+        for (std::size_t start = 0; start < size; runCount++)
         {
-            if (g_agbTrack == 1 && event.param2 != timingEvent.param2)
+            std::size_t middle = start + 1;
+
+            while (middle < size && !EventCompare(m_events[middle], m_events[middle - 1]))
+                middle++;
+
+            std::size_t end = middle;
+
+            if (end < size)
             {
-                Event originalTimingEvent = event;
-                originalTimingEvent.type = EventType::OriginalTimeSignature;
-                outEvents->push_back(originalTimingEvent);
+                end++;
+
+                while (end < size && !EventCompare(m_events[end], m_events[end - 1]))
+                    end++;
             }
-            timingEvent.param2 = event.param2;
-            timingEvent.time = event.time + timingEvent.param2;
+
+            std::merge(m_events.begin() + start, m_events.begin() + middle,
+                m_events.begin() + middle, m_events.begin() + end,
+                m_scratch.begin() + start, EventCompare);
+            start = end;
         }
 
-        outEvents->push_back(event);
-    }
+        m_events.swap(m_scratch);
 
-    return outEvents;
+        if (runCount <= 1)
+            return;
+    }
 }
 
-std::unique_ptr<std::vector<Event>> SplitTime(std::vector<Event>& inEvents)
+void Converter::SplitTime()
 {
-    std::unique_ptr<std::vector<Event>> outEvents(new std::vector<Event>());
+    m_scratch.clear();
 
     std::int32_t time = 0;
 
-    for (const Event& event : inEvents)
+    for (const Event& event : m_events)
     {
         std::int32_t diff = event.time - time;
 
@@ -707,7 +765,7 @@ std::unique_ptr<std::vector<Event>> SplitTime(std::vector<Event>& inEvents)
                 Event timeSplitEvent = {};
                 timeSplitEvent.time = time;
                 timeSplitEvent.type = EventType::TimeSplit;
-                outEvents->push_back(timeSplitEvent);
+                m_scratch.push_back(timeSplitEvent);
             }
         }
 
@@ -718,47 +776,22 @@ std::unique_ptr<std::vector<Event>> SplitTime(std::vector<Event>& inEvents)
             Event timeSplitEvent = {};
             timeSplitEvent.time = time + lutValue;
             timeSplitEvent.type = EventType::TimeSplit;
-            outEvents->push_back(timeSplitEvent);
+            m_scratch.push_back(timeSplitEvent);
         }
 
         time = event.time;
 
-        outEvents->push_back(event);
+        m_scratch.push_back(event);
     }
 
-    return outEvents;
+    m_events.swap(m_scratch);
 }
 
-std::unique_ptr<std::vector<Event>> CreateTies(std::vector<Event>& inEvents)
+void Converter::CalculateWaits()
 {
-    std::unique_ptr<std::vector<Event>> outEvents(new std::vector<Event>());
-
-    for (const Event& event : inEvents)
-    {
-        if (event.type == EventType::Note && event.param2 > 96)
-        {
-            Event tieEvent = event;
-            tieEvent.param2 = -1;
-            outEvents->push_back(tieEvent);
-
-            Event eotEvent = {};
-            eotEvent.time = event.time + event.param2;
-            eotEvent.type = EventType::EndOfTie;
-            eotEvent.note = event.note;
-            outEvents->push_back(eotEvent);
-        }
-        else
-        {
-            outEvents->push_back(event);
-        }
-    }
+    std::vector<Event>& events = m_events;
 
-    return outEvents;
-}
-
-void CalculateWaits(std::vector<Event>& events)
-{
-    g_initialWait = events[0].time;
+    m_initialWait = events[0].time;
     int wholeNoteCount = 0;
 
     for (unsigned i = 0; i < events.size() && events[i].type != EventType::EndOfTrack; i++)
@@ -773,7 +806,7 @@ void CalculateWaits(std::vector<Event>& events)
     }
 }
 
-int CalculateCompressionScore(std::vector<Event>& events, int index)
+static int CalculateCompressionScore(std::vector<Event>& events, int index)
 {
     int score = 0;
     std::uint8_t lastParam1 = events[index].param1;
@@ -850,7 +883,33 @@ int CalculateCompressionScore(std::vector<Event>& events, int index)
     return score;
 }
 
-bool IsCompressionMatch(std::vector<Event>& events, int index1, int index2)
+// Hashes the fields IsSameWholeNote compares, so that whole notes that can
+// share a pattern always land in the same bucket.
+static std::uint64_t HashWholeNote(std::vector<Event>& events, int index)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+
+    auto mix = [&hash](std::uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ull;
+    };
+
+    mix(events[index].time);
+    mix((int)events[index].type | (events[index].note << 8) | (events[index].param1 << 16));
+
+    for (int i = index + 1; !IsPatternBoundary(events[i].type); i++)
+    {
+        mix(events[i].time);
+        mix((int)events[i].type | (events[i].note << 8) | (events[i].param1 << 16));
+        mix((std::uint32_t)events[i].param2);
+    }
+
+    return hash;
+}
+
+// Whether two whole notes can share a pattern: their marks agree on
+// everything but the whole note number, and the events up to the next
+// pattern boundary are identical.
+static bool IsSameWholeNote(std::vector<Event>& events, int index1, int index2)
 {
     if (events[index1].type != events[index2].type ||
         events[index1].note != events[index2].note ||
@@ -858,107 +917,129 @@ bool IsCompressionMatch(std::vector<Event>& events, int index1, int index2)
         events[index1].time != events[index2].time)
         return false;
 
-    index1++;
-    index2++;
-
-    do
+    for (;;)
     {
-        if (events[index1] != events[index2])
-            return false;
-
         index1++;
         index2++;
-    } while (!IsPatternBoundary(events[index1].type));
-
-    return IsPatternBoundary(events[index2].type);
-}
 
-void CompressWholeNote(std::vector<Event>& events, int index)
-{
-    for (int j = index + 1; events[j].type != EventType::EndOfTrack; j++)
-    {
-        while (events[j].type != EventType::WholeNoteMark)
-        {
-            j++;
+        bool end1 = IsPatternBoundary(events[index1].type);
+        bool end2 = IsPatternBoundary(events[index2].type);
 
-            if (events[j].type == EventType::EndOfTrack)
-                return;
-        }
+        if (end1 || end2)
+            return end1 && end2;
 
-        if (IsCompressionMatch(events, index, j))
-        {
-            events[j].type = EventType::Pattern;
-            events[j].param2 = events[index].param2 & 0x7FFFFFFF;
-            events[index].param2 |= 0x80000000;
-        }
+        if (events[index1] != events[index2])
+            return false;
     }
 }
 
-void Compress(std::vector<Event>& events)
+// Turns each whole note that repeats an earlier one into a reference to it,
+// if that saves enough space. Rather than comparing every whole note with
+// every later one, whole notes are bucketed by hash and each is compared
+// only with the distinct whole notes already in its bucket. The first
+// occurrence of each distinct whole note becomes its pattern.
+void Converter::Compress()
 {
+    std::vector<Event>& events = m_events;
+
+    m_originals.clear();
+
     for (int i = 0; events[i].type != EventType::EndOfTrack; i++)
     {
-        while (events[i].type != EventType::WholeNoteMark)
-        {
-            i++;
+        if (events[i].type != EventType::WholeNoteMark)
+            continue;
 
-            if (events[i].type == EventType::EndOfTrack)
-                return;
-        }
+        std::vector<Original>& bucket = m_originals[HashWholeNote(events, i)];
+        bool repeated = false;
 
-        if (CalculateCompressionScore(events, i) >= 6)
+        for (Original& original : bucket)
         {
-            CompressWholeNote(events, i);
+            if (IsSameWholeNote(events, original.index, i))
+            {
+                if (original.worthCompressing)
+                {
+                    events[i].type = EventType::Pattern;
+                    events[i].param2 = events[original.index].param2 & 0x7FFFFFFF;
+                    events[original.index].param2 |= 0x80000000;
+                }
+
+                repeated = true;
+                break;
+            }
         }
+
+        if (!repeated)
+            bucket.push_back(Original{ i, CalculateCompressionScore(events, i) >= 6 });
     }
 }
 
-void ReadMidiTracks()
+void Converter::ReadMidiTracks()
 {
-    long trackHeaderStart = 14;
+    std::size_t trackHeaderStart = 14;
 
     ReadMidiTrackHeader(trackHeaderStart);
     ReadSeqEvents();
 
-    g_agbTrack = 1;
+    m_agbTrack = 1;
 
-    for (int midiTrack = 0; midiTrack < g_midiTrackCount; midiTrack++)
+    for (int midiTrack = 0; midiTrack < m_midiTrackCount; midiTrack++)
     {
         trackHeaderStart += ReadMidiTrackHeader(trackHeaderStart);
 
-        for (g_midiChan = 0; g_midiChan < 16; g_midiChan++)
+        for (m_midiChan = 0; m_midiChan < 16; m_midiChan++)
         {
             ReadTrackEvents();
 
-            if (s_minNote != 0xFF)
+            if (m_minNote != 0xFF)
             {
 #ifdef DEBUG
-                printf("Track%d = Midi-Ch.%d\n", g_agbTrack, g_midiChan + 1);
+                printf("Track%d = Midi-Ch.%d\n", m_agbTrack, m_midiChan + 1);
 #endif
 
-                std::unique_ptr<std::vector<Event>> events(MergeEvents());
+                MergeEvents();
 
                 // We don't need TEMPO in anything but track 1.
-                if (g_agbTrack == 1)
+                if (m_agbTrack == 1)
                 {
-                    auto it = std::remove_if(s_seqEvents.begin(), s_seqEvents.end(), [](const Event& event) { return event.type == EventType::Tempo; });
-                    s_seqEvents.erase(it, s_seqEvents.end());
+                    auto it = std::remove_if(m_seqEvents.begin(), m_seqEvents.end(), [](const Event& event) { return event.type == EventType::Tempo; });
+                    m_seqEvents.erase(it, m_seqEvents.end());
                 }
 
-                ConvertTimes(*events);
-                events = InsertTimingEvents(*events);
-                events = CreateTies(*events);
-                std::stable_sort(events->begin(), events->end(), EventCompare);
-                events = SplitTime(*events);
-                CalculateWaits(*events);
+                SortEvents();
+                SplitTime();
+                CalculateWaits();
 
-                if (g_compressionEnabled)
-                    Compress(*events);
+                if (m_options->compressionEnabled)
+                    Compress();
 
-                PrintAgbTrack(*events);
+                m_writer.PrintTrack(m_events, m_agbTrack, m_midiChan, m_initialWait);
 
-                g_agbTrack++;
+                m_agbTrack++;
             }
         }
     }
 }
+
+void Converter::Convert(const std::string& inputFilename, const std::string& outputFilename, const Options& options)
+{
+    ErrorContext context(inputFilename);
+
+    m_options = &options;
+    m_blockCount = 0;
+
+    ReadInputFile(inputFilename);
+
+    std::FILE *outputFile = std::fopen(outputFilename.c_str(), options.objectOutput ? "wb" : "w");
+
+    if (outputFile == nullptr)
+        RaiseError("failed to open \"%s\" for writing", outputFilename.c_str());
+
+    m_writer.Start(outputFile, options);
+
+    ReadMidiFileHeader();
+    m_writer.PrintHeader();
+    ReadMidiTracks();
+    m_writer.PrintFooter(m_agbTrack - 1);
+
+    std::fclose(outputFile);
+}
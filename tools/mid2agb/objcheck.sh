@@ -0,0 +1,54 @@
+#!/bin/bash
+# Checks that the object files mid2agb writes link to the same bytes as its
+# assembly output does once it has been through the assembler. Every song in
+# sound/songs/midi is converted both ways with the options songs.mk gives it,
+# and each object is linked on its own, with the symbols it refers to (the
+# voice group) defined at fixed addresses.
+#
+# Usage (from the repository root; needs devkitARM or arm-none-eabi binutils):
+#     tools/mid2agb/objcheck.sh [MID2AGB]
+
+mid2agb=${1:-tools/mid2agb/mid2agb}
+PREFIX=${PREFIX:-arm-none-eabi-}
+[ -n "$DEVKITARM" ] && PATH=$DEVKITARM/bin:$PATH
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+reverb=$(sed -n 's/^STD_REVERB = //p' songs.mk)
+
+# Links an object at the start of ROM and extracts its data and symbols.
+link() {
+    local object=$1 address=$((0x08800000)) defsyms=() symbol
+    for symbol in $("${PREFIX}nm" -u "$object" | awk '{ print $2 }'); do
+        defsyms+=(--defsym "$symbol=$address")
+        address=$((address + 0x100))
+    done
+    "${PREFIX}ld" -e 0 --section-start=.rodata=0x08000000 "${defsyms[@]}" -o "$object.elf" "$object" &&
+    "${PREFIX}objcopy" -O binary -j .rodata "$object.elf" "$object.bin" &&
+    "${PREFIX}nm" -g "$object.elf" > "$object.syms"
+}
+
+checked=0
+failed=0
+
+while read -r name options; do
+    mid=sound/songs/midi/$name.mid
+    [ -f "$mid" ] || continue
+    options=${options//\$(STD_REVERB)/$reverb}
+    # shellcheck disable=SC2086
+    if "$mid2agb" "$mid" "$workdir/$name.s" $options &&
+       "${PREFIX}as" -mcpu=arm7tdmi -I sound -o "$workdir/$name.s.o" "$workdir/$name.s" &&
+       "$mid2agb" "$mid" "$workdir/$name.o" $options &&
+       link "$workdir/$name.s.o" && link "$workdir/$name.o" &&
+       cmp -s "$workdir/$name.s.o.bin" "$workdir/$name.o.bin" &&
+       cmp -s "$workdir/$name.s.o.syms" "$workdir/$name.o.syms"; then
+        :
+    else
+        echo "$name: object differs from assembled output"
+        failed=$((failed + 1))
+    fi
+    checked=$((checked + 1))
+done < <(sed -n 's/^$(MID_BUILDDIR)\/\([^ ]*\)\.o .*MID_FLAGS := *\(.*\)$/\1 \2/p' songs.mk)
+
+echo "$checked songs checked, $failed differ"
+[ "$failed" -eq 0 ]
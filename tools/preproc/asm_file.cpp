@@ -20,19 +20,26 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstring>
+#include <map>
 #include <stdexcept>
 #include "preproc.h"
 #include "asm_file.h"
 #include "char_util.h"
 #include "utf8.h"
 #include "string_parser.h"
+#include "output_buffer.h"
 
-AsmFile::AsmFile(std::string filename) : m_filename(filename)
+AsmFile::AsmFile(std::string filename) : m_filename(filename), m_ownsBuffer(true), m_deferDiagnostics(false)
 {
     FILE *fp = std::fopen(filename.c_str(), "rb");
 
     if (fp == NULL)
+    {
+        if (g_beforeDiagnostic != nullptr)
+            g_beforeDiagnostic();
         FATAL_ERROR("Failed to open \"%s\" for reading.\n", filename.c_str());
+    }
 
     std::fseek(fp, 0, SEEK_END);
 
@@ -59,20 +66,58 @@ AsmFile::AsmFile(std::string filename) : m_filename(filename)
     RemoveComments();
 }
 
-AsmFile::AsmFile(AsmFile&& other) : m_filename(std::move(other.m_filename))
+AsmFile::AsmFile(AsmFile&& other) : m_filename(std::move(other.m_filename)), m_warnings(std::move(other.m_warnings))
 {
     m_buffer = other.m_buffer;
     m_pos = other.m_pos;
     m_size = other.m_size;
     m_lineNum = other.m_lineNum;
     m_lineStart = other.m_lineStart;
+    m_ownsBuffer = other.m_ownsBuffer;
+    m_deferDiagnostics = other.m_deferDiagnostics;
 
     other.m_buffer = nullptr;
 }
 
+AsmFile::AsmFile(const AsmFile& parent, bool deferDiagnostics) : m_filename(parent.m_filename)
+{
+    m_buffer = parent.m_buffer;
+    m_pos = parent.m_pos;
+    m_size = parent.m_size;
+    m_lineNum = parent.m_lineNum;
+    m_lineStart = parent.m_lineStart;
+    m_ownsBuffer = false;
+    m_deferDiagnostics = deferDiagnostics;
+}
+
 AsmFile::~AsmFile()
 {
-    delete[] m_buffer;
+    if (m_ownsBuffer)
+        delete[] m_buffer;
+}
+
+// Returns a view of this file at the current position that shares its
+// buffer. The view's errors are thrown as AsmFileError and its warnings are
+// collected in GetWarnings(), so that it can be used on another thread. The
+// view must not outlive this file.
+AsmFile AsmFile::MakeDeferredView()
+{
+    return AsmFile(*this, true);
+}
+
+// Moves to the start of the next line without looking at the rest of this
+// one, for a line that has been handed to a deferred view.
+void AsmFile::SkipRestOfLine()
+{
+    while (m_pos < m_size && m_buffer[m_pos] != '\n')
+        m_pos++;
+
+    if (m_pos < m_size)
+    {
+        m_pos++;
+        m_lineStart = m_pos;
+        m_lineNum++;
+    }
 }
 
 // Removes comments to simplify further processing.
@@ -440,7 +485,8 @@ void AsmFile::OutputLine()
         if (m_pos >= m_size)
         {
             RaiseWarning("file doesn't end with newline");
-            puts(&m_buffer[m_lineStart]);
+            g_output.Write(&m_buffer[m_lineStart], m_pos - m_lineStart);
+            g_output.PutChar('\n');
         }
         else
         {
@@ -449,10 +495,8 @@ void AsmFile::OutputLine()
     }
     else
     {
-        m_buffer[m_pos] = 0;
-        puts(&m_buffer[m_lineStart]);
-        m_buffer[m_pos] = '\n';
         m_pos++;
+        g_output.Write(&m_buffer[m_lineStart], m_pos - m_lineStart);
         m_lineStart = m_pos;
         m_lineNum++;
     }
@@ -497,7 +541,11 @@ bool AsmFile::IsAtEnd()
 // Output the current location to set gas's logical file and line numbers.
 void AsmFile::OutputLocation()
 {
-    std::printf("# %ld \"%s\"\n", m_lineNum, m_filename.c_str());
+    g_output.Write("# ", 2);
+    g_output.PutSigned(m_lineNum);
+    g_output.Write(" \"", 2);
+    g_output.Write(m_filename);
+    g_output.Write("\"\n", 2);
 }
 
 // Reports a diagnostic message.
@@ -506,6 +554,22 @@ void AsmFile::ReportDiagnostic(const char* type, const char* format, std::va_lis
     const int bufferSize = 1024;
     char buffer[bufferSize];
     std::vsnprintf(buffer, bufferSize, format, args);
+
+    if (m_deferDiagnostics)
+    {
+        char line[bufferSize + kMaxPath + 64];
+        std::snprintf(line, sizeof(line), "%s:%ld: %s: %s\n", m_filename.c_str(), m_lineNum, type, buffer);
+
+        if (std::strcmp(type, "error") == 0)
+            m_deferredError = line;
+        else
+            m_warnings += line;
+        return;
+    }
+
+    if (g_beforeDiagnostic != nullptr)
+        g_beforeDiagnostic();
+
     std::fprintf(stderr, "%s:%ld: %s: %s\n", m_filename.c_str(), m_lineNum, type, buffer);
 }
 
@@ -518,10 +582,15 @@ do                                        \
     va_end(args);                         \
 } while (0)
 
-// Reports an error diagnostic and terminates the program.
+// Reports an error diagnostic and terminates the program, or in a deferred
+// view, throws AsmFileError.
 void AsmFile::RaiseError(const char* format, ...)
 {
     DO_REPORT("error");
+
+    if (m_deferDiagnostics)
+        throw AsmFileError(m_deferredError);
+
     std::exit(1);
 }
 
@@ -23,9 +23,18 @@
 
 #include <cstdarg>
 #include <cstdint>
+#include <stdexcept>
 #include <string>
 #include "preproc.h"
 
+// Thrown instead of exiting by a deferred view's RaiseError().
+// what() is the complete diagnostic line.
+class AsmFileError : public std::runtime_error
+{
+public:
+    explicit AsmFileError(const std::string& message) : std::runtime_error(message) {}
+};
+
 enum class Directive
 {
     Include,
@@ -41,6 +50,9 @@ public:
     AsmFile(AsmFile&& other);
     AsmFile(const AsmFile&) = delete;
     ~AsmFile();
+    AsmFile MakeDeferredView();
+    void SkipRestOfLine();
+    const std::string& GetWarnings() { return m_warnings; }
     Directive GetDirective();
     std::string GetGlobalLabel();
     std::string ReadPath();
@@ -57,7 +69,12 @@ private:
     long m_lineNum;
     long m_lineStart;
     std::string m_filename;
+    bool m_ownsBuffer;
+    bool m_deferDiagnostics;
+    std::string m_warnings;
+    std::string m_deferredError;
 
+    AsmFile(const AsmFile& parent, bool deferDiagnostics);
     bool ConsumeComma();
     int ReadPadLength();
     void RemoveComments();
@@ -30,6 +30,8 @@
 #include "char_util.h"
 #include "utf8.h"
 #include "string_parser.h"
+#include "output_buffer.h"
+#include "incbin_cache.h"
 
 CFile::CFile(std::string filename) : m_filename(filename)
 {
@@ -85,21 +87,21 @@ void CFile::Preproc()
         {
             if (m_buffer[m_pos] == stringChar)
             {
-                std::putchar(stringChar);
+                g_output.PutChar(stringChar);
                 m_pos++;
                 stringChar = 0;
             }
             else if (m_buffer[m_pos] == '\\' && m_buffer[m_pos + 1] == stringChar)
             {
-                std::putchar('\\');
-                std::putchar(stringChar);
+                g_output.PutChar('\\');
+                g_output.PutChar(stringChar);
                 m_pos += 2;
             }
             else
             {
                 if (m_buffer[m_pos] == '\n')
                     m_lineNum++;
-                std::putchar(m_buffer[m_pos]);
+                g_output.PutChar(m_buffer[m_pos]);
                 m_pos++;
             }
         }
@@ -113,7 +115,7 @@ void CFile::Preproc()
 
             char c = m_buffer[m_pos++];
 
-            std::putchar(c);
+            g_output.PutChar(c);
 
             if (c == '\n')
                 m_lineNum++;
@@ -142,7 +144,7 @@ bool CFile::ConsumeNewline()
     {
         m_pos += 2;
         m_lineNum++;
-        std::putchar('\n');
+        g_output.PutChar('\n');
         return true;
     }
 
@@ -150,7 +152,7 @@ bool CFile::ConsumeNewline()
     {
         m_pos++;
         m_lineNum++;
-        std::putchar('\n');
+        g_output.PutChar('\n');
         return true;
     }
 
@@ -193,7 +195,7 @@ void CFile::TryConvertString()
 
     SkipWhitespace();
 
-    std::printf("{ ");
+    g_output.Write("{ ", 2);
 
     while (1)
     {
@@ -215,7 +217,10 @@ void CFile::TryConvertString()
             }
 
             for (int i = 0; i < length; i++)
-                printf("0x%02X, ", s[i]);
+            {
+                g_output.PutHexByte(s[i]);
+                g_output.Write(", ", 2);
+            }
         }
         else if (m_buffer[m_pos] == ')')
         {
@@ -234,9 +239,9 @@ void CFile::TryConvertString()
     }
 
     if (noTerminator)
-        std::printf(" }");
+        g_output.Write(" }", 2);
     else
-        std::printf("0xFF }");
+        g_output.Write("0xFF }", 6);
 }
 
 bool CFile::CheckIdentifier(const std::string& ident)
@@ -292,6 +297,30 @@ int ExtractData(const std::unique_ptr<unsigned char[]>& buffer, int offset, int
     }
 }
 
+// The incbin cache holds this function's output, so changing its format
+// needs IncbinCache::kFormatVersion to be bumped.
+static void PrintIncbinData(OutputBuffer& out, const std::unique_ptr<unsigned char[]>& buffer, int count, int size, bool isSigned)
+{
+    int offset = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        int data = ExtractData(buffer, offset, size);
+        offset += size;
+
+        if (isSigned)
+        {
+            out.PutSigned(data);
+            out.PutChar(',');
+        }
+        else
+        {
+            out.PutUnsigned(static_cast<unsigned>(data));
+            out.Write("u,", 2);
+        }
+    }
+}
+
 void CFile::TryConvertIncbin()
 {
     std::string idents[6] = { "INCBIN_S8", "INCBIN_U8", "INCBIN_S16", "INCBIN_U16", "INCBIN_S32", "INCBIN_U32" };
@@ -328,7 +357,7 @@ void CFile::TryConvertIncbin()
 
     m_pos++;
 
-    std::printf("{");
+    g_output.PutChar('{');
 
     while (true)
     {
@@ -387,17 +416,32 @@ void CFile::TryConvertIncbin()
             RaiseError("Size %d doesn't evenly divide file size %d.\n", size, fileSize);
 
         int count = fileSize / size;
-        int offset = 0;
 
-        for (int i = 0; i < count; i++)
+        if (g_incbinCache == nullptr)
+        {
+            PrintIncbinData(g_output, buffer, count, size, isSigned);
+        }
+        else
         {
-            int data = ExtractData(buffer, offset, size);
-            offset += size;
+            std::string key = IncbinCache::MakeKey(buffer.get(), fileSize, incbinType);
+            const std::string* text = g_incbinCache->Find(key);
 
-            if (isSigned)
-                std::printf("%d,", data);
+            if (text == nullptr)
+            {
+                std::string formatted;
+                {
+                    OutputBuffer out(-1, 1 << 16);
+                    out.StartCapture(&formatted);
+                    PrintIncbinData(out, buffer, count, size, isSigned);
+                    out.Flush();
+                }
+                g_incbinCache->Store(key, formatted);
+                g_output.Write(formatted);
+            }
             else
-                std::printf("%uu,", data);
+            {
+                g_output.Write(*text);
+            }
         }
 
         SkipWhitespace();
@@ -413,7 +457,7 @@ void CFile::TryConvertIncbin()
 
     m_pos++;
 
-    std::printf("}");
+    g_output.PutChar('}');
 }
 
 // Reports a diagnostic message.
@@ -18,9 +18,11 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdint>
 #include <cstdarg>
+#include <cstring>
 #include "preproc.h"
 #include "charmap.h"
 #include "char_util.h"
@@ -369,16 +371,17 @@ void CharmapReader::SkipWhitespace()
         m_pos++;
 }
 
-Charmap::Charmap(std::string filename)
+Charmap::Charmap(std::string filename) : m_bmpPages(256)
 {
     CharmapReader reader(filename);
+    std::unordered_map<std::string, Entry> constants;
 
     for (;;)
     {
         Lhs lhs = reader.ReadLhs();
 
         if (lhs.type == LhsType::None)
-            return;
+            break;
 
         reader.ExpectEqualsSign();
 
@@ -387,22 +390,168 @@ Charmap::Charmap(std::string filename)
         switch (lhs.type)
         {
         case LhsType::Char:
-            if (m_chars.find(lhs.code) != m_chars.end())
+            if (Char(lhs.code).length != 0)
                 reader.RaiseError("redefining char");
-            m_chars[lhs.code] = sequence;
+            if (lhs.code >= 0 && lhs.code < kNumBmpChars)
+                SetBmpChar(lhs.code, AddToPool(sequence));
+            else
+                m_otherChars[lhs.code] = AddToPool(sequence);
             break;
         case LhsType::Escape:
-            if (m_escapes[lhs.code].length() != 0)
+            if (m_escapes[lhs.code].length != 0)
                 reader.RaiseError("redefining escape");
-            m_escapes[lhs.code] = sequence;
+            m_escapes[lhs.code] = AddToPool(sequence);
             break;
         case LhsType::Constant:
-            if (m_constants.find(lhs.name) != m_constants.end())
+            if (constants.find(lhs.name) != constants.end())
                 reader.RaiseError("redefining constant");
-            m_constants[lhs.name] = sequence;
+            constants[lhs.name] = AddToPool(sequence);
             break;
         }
 
         reader.ExpectEmptyRestOfLine();
     }
+
+    // Sort so that the table doesn't depend on the unordered_map's iteration order.
+    std::vector<std::pair<std::string, Entry>> sortedConstants(constants.begin(), constants.end());
+    std::sort(sortedConstants.begin(), sortedConstants.end(),
+        [](const std::pair<std::string, Entry>& a, const std::pair<std::string, Entry>& b) { return a.first < b.first; });
+    BuildConstantTable(sortedConstants);
+}
+
+Charmap::Entry Charmap::AddToPool(const std::string& bytes)
+{
+    Entry entry;
+
+    entry.offset = m_pool.size();
+    entry.length = bytes.length();
+    m_pool.insert(m_pool.end(), bytes.begin(), bytes.end());
+
+    return entry;
+}
+
+void Charmap::SetBmpChar(std::int32_t code, Entry entry)
+{
+    std::uint16_t& page = m_bmpPageIndex[code >> 8];
+
+    if (page == 0)
+    {
+        page = m_bmpPages.size() / 256;
+        m_bmpPages.resize(m_bmpPages.size() + 256);
+    }
+
+    m_bmpPages[page * 256 + (code & 0xFF)] = entry;
+}
+
+static std::uint64_t HashName(const char* name, std::size_t length)
+{
+    // FNV-1a
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (std::size_t i = 0; i < length; i++)
+    {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+static std::uint32_t SlotHash(std::uint64_t hash, std::uint32_t seed)
+{
+    // splitmix64 finalizer
+    std::uint64_t x = hash + seed * 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<std::uint32_t>(x ^ (x >> 31));
+}
+
+// Builds a perfect hash table with the "hash and displace" method: names are
+// first grouped into buckets by their hash, then for each bucket, largest
+// first, a seed is searched for that sends all of its names to free slots.
+void Charmap::BuildConstantTable(const std::vector<std::pair<std::string, Entry>>& constants)
+{
+    std::size_t numSlots = 1;
+
+    while (numSlots < constants.size() * 2)
+        numSlots *= 2;
+
+    std::size_t numBuckets = constants.size() / 4 + 1;
+    std::vector<std::vector<std::size_t>> buckets(numBuckets);
+    std::vector<std::uint64_t> hashes(constants.size());
+
+    for (std::size_t i = 0; i < constants.size(); i++)
+    {
+        const std::string& name = constants[i].first;
+        hashes[i] = HashName(name.data(), name.length());
+        buckets[hashes[i] % numBuckets].push_back(i);
+    }
+
+    std::vector<std::size_t> order(numBuckets);
+
+    for (std::size_t i = 0; i < numBuckets; i++)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(),
+        [&buckets](std::size_t a, std::size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    m_constantSeeds.assign(numBuckets, 0);
+    m_constantSlots.assign(numSlots, ConstantSlot());
+
+    std::vector<bool> used(numSlots, false);
+    std::vector<std::size_t> slots;
+
+    for (std::size_t bucketIndex : order)
+    {
+        const std::vector<std::size_t>& bucket = buckets[bucketIndex];
+
+        if (bucket.empty())
+            break;
+
+        for (std::uint32_t seed = 0;; seed++)
+        {
+            slots.clear();
+
+            for (std::size_t i : bucket)
+            {
+                std::size_t slot = SlotHash(hashes[i], seed) & (numSlots - 1);
+
+                if (used[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end())
+                    break;
+
+                slots.push_back(slot);
+            }
+
+            if (slots.size() == bucket.size())
+            {
+                m_constantSeeds[bucketIndex] = seed;
+                break;
+            }
+        }
+
+        for (std::size_t j = 0; j < bucket.size(); j++)
+        {
+            const std::pair<std::string, Entry>& constant = constants[bucket[j]];
+            ConstantSlot& slot = m_constantSlots[slots[j]];
+
+            used[slots[j]] = true;
+            slot.name = AddToPool(constant.first);
+            slot.sequence = constant.second;
+        }
+    }
+}
+
+CharmapSpan Charmap::Constant(const char* name, std::size_t length) const
+{
+    if (m_constantSeeds.empty() || length == 0)
+        return ToSpan(Entry());
+
+    std::uint64_t hash = HashName(name, length);
+    std::uint32_t seed = m_constantSeeds[hash % m_constantSeeds.size()];
+    const ConstantSlot& slot = m_constantSlots[SlotHash(hash, seed) & (m_constantSlots.size() - 1)];
+
+    if (slot.name.length != length || std::memcmp(m_pool.data() + slot.name.offset, name, length) != 0)
+        return ToSpan(Entry());
+
+    return ToSpan(slot.sequence);
 }
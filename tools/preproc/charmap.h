@@ -21,44 +21,81 @@
 #ifndef CHARMAP_H
 #define CHARMAP_H
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <vector>
 
+// A byte sequence stored in the charmap's pool. An empty span means that
+// there is no mapping.
+struct CharmapSpan
+{
+    const unsigned char* data;
+    std::size_t length;
+};
+
+// Charmap compiled for lookups that don't allocate. All byte sequences and
+// constant names live in one contiguous pool; code points in the Basic
+// Multilingual Plane are looked up in a dense two-level table (256 pages of
+// 256 code points, with unused pages sharing one empty page) and constants in
+// a perfect hash table built when the charmap is loaded.
 class Charmap
 {
 public:
     Charmap(std::string filename);
 
-    std::string Char(std::int32_t code)
+    CharmapSpan Char(std::int32_t code) const
     {
-        auto it = m_chars.find(code);
+        if (code >= 0 && code < kNumBmpChars)
+            return ToSpan(m_bmpPages[m_bmpPageIndex[code >> 8] * 256 + (code & 0xFF)]);
 
-        if (it == m_chars.end())
-            return std::string();
+        auto it = m_otherChars.find(code);
 
-        return it->second;
+        if (it == m_otherChars.end())
+            return ToSpan(Entry());
+
+        return ToSpan(it->second);
     }
 
-    std::string Escape(unsigned char code)
+    CharmapSpan Escape(unsigned char code) const
     {
-        return m_escapes[code];
+        return ToSpan(m_escapes[code]);
     }
 
-    std::string Constant(std::string identifier)
+    CharmapSpan Constant(const char* name, std::size_t length) const;
+
+private:
+    static const std::int32_t kNumBmpChars = 0x10000;
+
+    struct Entry
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    struct ConstantSlot
     {
-        auto it = m_constants.find(identifier);
+        Entry name;
+        Entry sequence;
+    };
 
-        if (it == m_constants.end())
-            return std::string();
+    std::vector<unsigned char> m_pool;
+    std::uint16_t m_bmpPageIndex[256] = {};
+    std::vector<Entry> m_bmpPages;
+    std::unordered_map<std::int32_t, Entry> m_otherChars;
+    Entry m_escapes[128];
+    std::vector<std::uint32_t> m_constantSeeds;
+    std::vector<ConstantSlot> m_constantSlots;
 
-        return it->second;
+    CharmapSpan ToSpan(Entry entry) const
+    {
+        return { m_pool.data() + entry.offset, entry.length };
     }
-private:
-    std::map<std::int32_t, std::string> m_chars;
-    std::string m_escapes[128];
-    std::map<std::string, std::string> m_constants;
+
+    Entry AddToPool(const std::string& bytes);
+    void SetBmpChar(std::int32_t code, Entry entry);
+    void BuildConstantTable(const std::vector<std::pair<std::string, Entry>>& constants);
 };
 
 #endif // CHARMAP_H
@@ -0,0 +1,127 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <sys/stat.h>
+#include "preproc.h"
+#include "incbin_cache.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define MKDIR(path) _mkdir(path)
+#define GETPID _getpid
+#else
+#include <unistd.h>
+#define MKDIR(path) mkdir(path, 0777)
+#define GETPID getpid
+#endif
+
+IncbinCache* g_incbinCache;
+
+IncbinCache::IncbinCache(std::string directory) : m_directory(directory)
+{
+    if (!m_directory.empty())
+    {
+        if (m_directory.back() != '/')
+            m_directory += '/';
+        MKDIR(m_directory.c_str());
+    }
+}
+
+// The key is the format version, the file size, two independent 64-bit
+// hashes of the contents (FNV-1a and a multiply-rotate hash) and the INCBIN
+// type, since the same bytes expand to different text as S8, U16, etc.
+std::string IncbinCache::MakeKey(const unsigned char* data, int size, int incbinType)
+{
+    std::uint64_t fnv = 0xCBF29CE484222325ULL;
+    std::uint64_t mix = 0x9E3779B97F4A7C15ULL;
+
+    for (int i = 0; i < size; i++)
+    {
+        fnv = (fnv ^ data[i]) * 0x100000001B3ULL;
+        mix = (mix + data[i] + 1) * 0xFF51AFD7ED558CCDULL;
+        mix = (mix << 31) | (mix >> 33);
+    }
+
+    char key[64];
+    std::snprintf(key, sizeof(key), "v%d-%x-%016llx%016llx-%d", kFormatVersion, size,
+        static_cast<unsigned long long>(fnv), static_cast<unsigned long long>(mix), incbinType);
+
+    return key;
+}
+
+std::string IncbinCache::GetEntryPath(const std::string& key)
+{
+    return m_directory + key + ".txt";
+}
+
+const std::string* IncbinCache::Find(const std::string& key)
+{
+    auto it = m_entries.find(key);
+
+    if (it != m_entries.end())
+        return &it->second;
+
+    if (m_directory.empty())
+        return nullptr;
+
+    FILE* fp = std::fopen(GetEntryPath(key).c_str(), "rb");
+
+    if (fp == nullptr)
+        return nullptr;
+
+    std::string text;
+    char buffer[1 << 14];
+    std::size_t count;
+
+    while ((count = std::fread(buffer, 1, sizeof(buffer), fp)) != 0)
+        text.append(buffer, count);
+
+    std::fclose(fp);
+
+    std::string& entry = m_entries[key];
+    entry.swap(text);
+    return &entry;
+}
+
+void IncbinCache::Store(const std::string& key, const std::string& text)
+{
+    m_entries[key] = text;
+
+    if (m_directory.empty())
+        return;
+
+    // Write to a temporary file first so that a concurrent preproc never
+    // reads a partial entry.
+    std::string path = GetEntryPath(key);
+    std::string tmpPath = path + "." + std::to_string(GETPID()) + ".tmp";
+    FILE* fp = std::fopen(tmpPath.c_str(), "wb");
+
+    if (fp == nullptr)
+        return;
+
+    bool ok = std::fwrite(text.data(), 1, text.size(), fp) == text.size();
+    ok = std::fclose(fp) == 0 && ok;
+
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+        std::remove(tmpPath.c_str());
+}
@@ -0,0 +1,56 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef INCBIN_CACHE_H
+#define INCBIN_CACHE_H
+
+#include <string>
+#include <unordered_map>
+
+// Remembers the text that INCBIN expands to, keyed by a hash of the binary's
+// contents and the element type, so that an asset that is INCBIN'd from many
+// translation units is only formatted once. Entries are kept in memory for
+// the lifetime of the process and, if a directory is given, also stored
+// there as one file per entry so that later preproc runs can reuse them.
+class IncbinCache
+{
+public:
+    // Part of every key. Bump it whenever PrintIncbinData's output changes,
+    // so that entries written by an older preproc are no longer found.
+    static const int kFormatVersion = 1;
+
+    explicit IncbinCache(std::string directory);
+
+    static std::string MakeKey(const unsigned char* data, int size, int incbinType);
+
+    // Returns the cached text for key, or nullptr if there isn't any.
+    const std::string* Find(const std::string& key);
+    void Store(const std::string& key, const std::string& text);
+
+private:
+    std::string m_directory;
+    std::unordered_map<std::string, std::string> m_entries;
+
+    std::string GetEntryPath(const std::string& key);
+};
+
+extern IncbinCache* g_incbinCache;
+
+#endif // INCBIN_CACHE_H
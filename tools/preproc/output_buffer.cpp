@@ -0,0 +1,156 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "preproc.h"
+#include "output_buffer.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define WRITE _write
+#else
+#include <unistd.h>
+#define WRITE write
+#endif
+
+OutputBuffer g_output(1);
+
+const char OutputBuffer::s_hexTable[513] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+OutputBuffer::OutputBuffer(int fd, std::size_t capacity)
+    : m_fd(fd), m_capacity(capacity), m_capture(nullptr), m_buffer(new char[capacity]), m_length(0)
+{
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    Flush();
+    delete[] m_buffer;
+}
+
+void OutputBuffer::Write(const char* data, std::size_t length)
+{
+    if (m_capacity - m_length < length)
+    {
+        Flush();
+
+        if (length >= m_capacity)
+        {
+            WriteAll(data, length);
+            return;
+        }
+    }
+
+    std::memcpy(m_buffer + m_length, data, length);
+    m_length += length;
+}
+
+void OutputBuffer::Flush()
+{
+    WriteAll(m_buffer, m_length);
+    m_length = 0;
+}
+
+void OutputBuffer::Redirect(int fd)
+{
+    Flush();
+    m_fd = fd;
+}
+
+void OutputBuffer::StartCapture(std::string* sink)
+{
+    Flush();
+    m_capture = sink;
+}
+
+void OutputBuffer::StopCapture()
+{
+    Flush();
+    m_capture = nullptr;
+}
+
+// Uses _Exit on failure, since this also runs from the destructor during exit().
+void OutputBuffer::WriteAll(const char* data, std::size_t length)
+{
+    if (m_capture != nullptr)
+    {
+        m_capture->append(data, length);
+        return;
+    }
+
+    std::size_t written = 0;
+
+    while (written < length)
+    {
+        long result = WRITE(m_fd, data + written, length - written);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::fprintf(stderr, "Failed to write output: %s\n", std::strerror(errno));
+            std::_Exit(1);
+        }
+
+        written += result;
+    }
+}
+
+void OutputBuffer::PutUnsigned(unsigned long value)
+{
+    char digits[20];
+    int count = 0;
+
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    if (m_capacity - m_length < sizeof(digits))
+        Flush();
+
+    while (count > 0)
+        m_buffer[m_length++] = digits[--count];
+}
+
+void OutputBuffer::PutSigned(long value)
+{
+    if (value < 0)
+    {
+        PutChar('-');
+        PutUnsigned(0UL - static_cast<unsigned long>(value));
+    }
+    else
+    {
+        PutUnsigned(value);
+    }
+}
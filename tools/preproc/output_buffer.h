@@ -0,0 +1,93 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <string>
+
+// Buffered writer for preproc's output. Text is accumulated in one large
+// buffer and handed to the OS with a single write() each time it fills up,
+// instead of going through stdio a character or a number at a time.
+class OutputBuffer
+{
+public:
+    explicit OutputBuffer(int fd, std::size_t capacity = kDefaultCapacity);
+    ~OutputBuffer();
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator =(const OutputBuffer&) = delete;
+
+    void Write(const char* data, std::size_t length);
+    void Flush();
+
+    // Flushes pending output and sends everything after it to fd instead.
+    void Redirect(int fd);
+
+    // Flushes pending output and appends everything after it to sink until
+    // StopCapture() is called.
+    void StartCapture(std::string* sink);
+    void StopCapture();
+
+    void Write(const std::string& s)
+    {
+        Write(s.data(), s.length());
+    }
+
+    void PutChar(char c)
+    {
+        if (m_length == m_capacity)
+            Flush();
+        m_buffer[m_length++] = c;
+    }
+
+    // Writes "0xNN" with uppercase hex digits, like printf("0x%02X").
+    void PutHexByte(unsigned char value)
+    {
+        if (m_capacity - m_length < 4)
+            Flush();
+        const char* digits = &s_hexTable[value * 2];
+        m_buffer[m_length++] = '0';
+        m_buffer[m_length++] = 'x';
+        m_buffer[m_length++] = digits[0];
+        m_buffer[m_length++] = digits[1];
+    }
+
+    void PutSigned(long value);
+    void PutUnsigned(unsigned long value);
+
+private:
+    static const std::size_t kDefaultCapacity = 1 << 20;
+    static const char s_hexTable[513];
+
+    int m_fd;
+    std::size_t m_capacity;
+    std::string* m_capture;
+    char* m_buffer;
+    std::size_t m_length;
+
+    void WriteAll(const char* data, std::size_t length);
+};
+
+// Standard output. It's flushed when the program exits, including through
+// FATAL_ERROR.
+extern OutputBuffer g_output;
+
+#endif // OUTPUT_BUFFER_H
@@ -18,34 +18,269 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <stack>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
 #include "preproc.h"
 #include "asm_file.h"
 #include "c_file.h"
 #include "charmap.h"
+#include "output_buffer.h"
+#include "incbin_cache.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define OPEN _open
+#define CLOSE _close
+#else
+#include <unistd.h>
+#define OPEN open
+#define CLOSE close
+#define O_BINARY 0
+#endif
 
 Charmap* g_charmap;
+void (*g_beforeDiagnostic)();
 
-void PrintAsmBytes(unsigned char *s, int length)
+void PrintAsmBytes(OutputBuffer& out, unsigned char *s, int length)
 {
     if (length > 0)
     {
-        std::printf("\t.byte ");
+        out.Write("\t.byte ", 7);
         for (int i = 0; i < length; i++)
         {
-            std::printf("0x%02X", s[i]);
+            out.PutHexByte(s[i]);
 
             if (i < length - 1)
-                std::printf(", ");
+                out.Write(", ", 2);
         }
-        std::putchar('\n');
+        out.PutChar('\n');
     }
 }
 
+// Converts the .string and .braille lines of an asm file on several threads.
+// The main thread keeps walking the file and hands each such line to a job;
+// everything else it outputs is captured as the text in front of the next job.
+// Jobs are converted in chunks and written out in their original order, so
+// the output is the same as converting them one at a time. If a job fails,
+// its error is reported after the output that precedes it, as it would have
+// been without threads.
+class ParallelStringConverter
+{
+public:
+    explicit ParallelStringConverter(unsigned numThreads) : m_capturing(false), m_generation(0), m_busyWorkers(0), m_quit(false)
+    {
+        s_active = this;
+        g_beforeDiagnostic = DrainActive;
+
+        for (unsigned i = 1; i < numThreads; i++)
+            m_threads.emplace_back(&ParallelStringConverter::WorkerLoop, this);
+    }
+
+    ~ParallelStringConverter()
+    {
+        Drain();
+        g_beforeDiagnostic = nullptr;
+        s_active = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_wake.notify_all();
+
+        for (std::thread& thread : m_threads)
+            thread.join();
+    }
+
+    // Queues the directive at the file's current position. The job keeps a
+    // view into the file's buffer, so a file with pending jobs must be passed
+    // to Retire() rather than destroyed.
+    void AddJob(AsmFile& file, Directive directive)
+    {
+        g_output.Flush();
+
+        Job* job = new Job(file.MakeDeferredView(), directive);
+        job->precedingText.swap(m_text);
+        m_jobs.emplace_back(job);
+
+        // Text is written straight through while no jobs are pending.
+        if (!m_capturing)
+        {
+            g_output.StartCapture(&m_text);
+            m_capturing = true;
+        }
+
+        file.SkipRestOfLine();
+
+        if (m_jobs.size() >= kChunkSize)
+            Drain();
+    }
+
+    // Keeps a finished file's buffer alive until its jobs are drained.
+    void Retire(AsmFile&& file)
+    {
+        if (m_capturing)
+            m_retiredFiles.emplace_back(new AsmFile(std::move(file)));
+    }
+
+    void Drain()
+    {
+        if (!m_capturing)
+            return;
+
+        g_output.StopCapture();
+        m_capturing = false;
+
+        m_next = 0;
+
+        // Small chunks aren't worth waking the workers for.
+        if (m_jobs.size() >= kMinParallelJobs && !m_threads.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busyWorkers = m_threads.size();
+                m_generation++;
+            }
+            m_wake.notify_all();
+
+            Work();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+        }
+        else
+        {
+            Work();
+        }
+
+        for (const std::unique_ptr<Job>& job : m_jobs)
+        {
+            g_output.Write(job->precedingText);
+            std::fputs(job->file.GetWarnings().c_str(), stderr);
+
+            if (job->failed)
+            {
+                g_beforeDiagnostic = nullptr;
+                std::fputs(job->error.c_str(), stderr);
+                std::exit(1);
+            }
+
+            g_output.Write(job->output);
+        }
+
+        m_jobs.clear();
+        m_retiredFiles.clear();
+        g_output.Write(m_text);
+        m_text.clear();
+    }
+
+private:
+    static const std::size_t kChunkSize = 4096;
+    static const std::size_t kMinParallelJobs = 64;
+
+    struct Job
+    {
+        Job(AsmFile&& file, Directive directive) : file(std::move(file)), directive(directive), failed(false) {}
+
+        AsmFile file;
+        Directive directive;
+        std::string precedingText;
+        std::string output;
+        std::string error;
+        bool failed;
+    };
+
+    static ParallelStringConverter* s_active;
+
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    std::vector<std::unique_ptr<AsmFile>> m_retiredFiles;
+    std::string m_text;
+    bool m_capturing;
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    unsigned long m_generation;
+    std::size_t m_busyWorkers;
+    bool m_quit;
+    std::atomic<std::size_t> m_next;
+
+    static void DrainActive()
+    {
+        s_active->Drain();
+    }
+
+    void WorkerLoop()
+    {
+        unsigned long seenGeneration = 0;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_quit || m_generation != seenGeneration; });
+
+                if (m_quit)
+                    return;
+
+                seenGeneration = m_generation;
+            }
+
+            Work();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busyWorkers == 0)
+                m_done.notify_one();
+        }
+    }
+
+    void Work()
+    {
+        OutputBuffer out(-1, 1 << 16);
+
+        for (std::size_t i = m_next++; i < m_jobs.size(); i = m_next++)
+        {
+            Job& job = *m_jobs[i];
+            unsigned char s[kMaxStringLength];
+
+            try
+            {
+                int length = job.directive == Directive::String ? job.file.ReadString(s) : job.file.ReadBraille(s);
+                out.StartCapture(&job.output);
+                PrintAsmBytes(out, s, length);
+                out.StopCapture();
+            }
+            catch (AsmFileError& e)
+            {
+                job.failed = true;
+                job.error = e.what();
+            }
+        }
+    }
+};
+
+ParallelStringConverter* ParallelStringConverter::s_active;
+
+static unsigned s_numThreads = 1;
+
 void PreprocAsmFile(std::string filename)
 {
     std::stack<AsmFile> stack;
+    std::unique_ptr<ParallelStringConverter> converter;
+
+    if (s_numThreads > 1)
+        converter.reset(new ParallelStringConverter(s_numThreads));
 
     stack.push(AsmFile(filename));
 
@@ -53,6 +288,9 @@ void PreprocAsmFile(std::string filename)
     {
         while (stack.top().IsAtEnd())
         {
+            if (converter)
+                converter->Retire(std::move(stack.top()));
+
             stack.pop();
 
             if (stack.empty())
@@ -71,16 +309,26 @@ void PreprocAsmFile(std::string filename)
             break;
         case Directive::String:
         {
+            if (converter)
+            {
+                converter->AddJob(stack.top(), directive);
+                break;
+            }
             unsigned char s[kMaxStringLength];
             int length = stack.top().ReadString(s);
-            PrintAsmBytes(s, length);
+            PrintAsmBytes(g_output, s, length);
             break;
         }
         case Directive::Braille:
         {
+            if (converter)
+            {
+                converter->AddJob(stack.top(), directive);
+                break;
+            }
             unsigned char s[kMaxStringLength];
             int length = stack.top().ReadBraille(s);
-            PrintAsmBytes(s, length);
+            PrintAsmBytes(g_output, s, length);
             break;
         }
         case Directive::Unknown:
@@ -89,8 +337,10 @@ void PreprocAsmFile(std::string filename)
 
             if (globalLabel.length() != 0)
             {
-                const char *s = globalLabel.c_str();
-                std::printf("%s: ; .global %s\n", s, s);
+                g_output.Write(globalLabel);
+                g_output.Write(": ; .global ", 12);
+                g_output.Write(globalLabel);
+                g_output.PutChar('\n');
             }
             else
             {
@@ -130,27 +380,136 @@ char* GetFileExtension(char* filename)
     return extension;
 }
 
+void PreprocFile(char* filename)
+{
+    char* extension = GetFileExtension(filename);
+
+    if (!extension)
+        FATAL_ERROR("\"%s\" has no file extension.\n", filename);
+
+    if ((extension[0] == 's') && extension[1] == 0)
+        PreprocAsmFile(filename);
+    else if ((extension[0] == 'c' || extension[0] == 'i') && extension[1] == 0)
+        PreprocCFile(filename);
+    else
+        FATAL_ERROR("\"%s\" has an unknown file extension of \"%s\".\n", filename, extension);
+}
+
+// Temporary output of the batch job in progress, removed if preproc exits
+// with an error so that a half-written file is never left behind.
+static std::string s_pendingOutputPath;
+
+static void RemovePendingOutput()
+{
+    if (!s_pendingOutputPath.empty())
+        std::remove(s_pendingOutputPath.c_str());
+}
+
+// Processes "SRC_FILE OUTPUT_FILE" pairs, one per line, reusing the charmap
+// that was loaded at startup. When the list is read from stdin, a line
+// "done OUTPUT_FILE" is printed to stdout after each output is written so
+// that a driver process can stream requests to a long-lived preproc.
+void PreprocBatch(const char* listPath)
+{
+    bool streaming = std::strcmp(listPath, "-") == 0;
+    FILE* list = streaming ? stdin : std::fopen(listPath, "r");
+
+    if (list == nullptr)
+        FATAL_ERROR("Failed to open \"%s\" for reading.\n", listPath);
+
+    std::atexit(RemovePendingOutput);
+
+    char line[2 * kMaxPath + 16];
+    int lineNum = 0;
+
+    while (std::fgets(line, sizeof(line), list) != nullptr)
+    {
+        char srcPath[kMaxPath + 1];
+        char outputPath[kMaxPath + 1];
+        char extra;
+
+        lineNum++;
+
+        int count = std::sscanf(line, "%256s %256s %c", srcPath, outputPath, &extra);
+
+        if (count <= 0)
+            continue;
+
+        if (count != 2)
+            FATAL_ERROR("%s:%d: expected \"SRC_FILE OUTPUT_FILE\"\n", listPath, lineNum);
+
+        s_pendingOutputPath = std::string(outputPath) + ".tmp";
+
+        int fd = OPEN(s_pendingOutputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+
+        if (fd < 0)
+            FATAL_ERROR("Failed to open \"%s\" for writing.\n", s_pendingOutputPath.c_str());
+
+        g_output.Redirect(fd);
+        PreprocFile(srcPath);
+        g_output.Redirect(1);
+        CLOSE(fd);
+
+        std::remove(outputPath);
+        if (std::rename(s_pendingOutputPath.c_str(), outputPath) != 0)
+            FATAL_ERROR("Failed to rename \"%s\" to \"%s\".\n", s_pendingOutputPath.c_str(), outputPath);
+        s_pendingOutputPath.clear();
+
+        if (streaming)
+        {
+            std::printf("done %s\n", outputPath);
+            std::fflush(stdout);
+        }
+    }
+
+    if (!streaming)
+        std::fclose(list);
+}
+
 int main(int argc, char **argv)
 {
-    if (argc != 3)
+    const char* program = argv[0];
+
+    std::string incbinCacheDir;
+
+    while (argc >= 3)
     {
-        std::fprintf(stderr, "Usage: %s SRC_FILE CHARMAP_FILE", argv[0]);
-        return 1;
+        if (std::strcmp(argv[1], "-j") == 0)
+        {
+            s_numThreads = std::strtoul(argv[2], nullptr, 10);
+            if (s_numThreads == 0)
+                s_numThreads = std::thread::hardware_concurrency();
+        }
+        else if (std::strcmp(argv[1], "-c") == 0)
+        {
+            incbinCacheDir = argv[2];
+        }
+        else
+        {
+            break;
+        }
+        argc -= 2;
+        argv += 2;
     }
 
-    g_charmap = new Charmap(argv[2]);
+    bool batch = argc == 4 && std::strcmp(argv[1], "-b") == 0;
+
+    if (argc != 3 && !batch)
+    {
+        std::fprintf(stderr, "Usage: %s [-j THREADS] [-c INCBIN_CACHE_DIR] SRC_FILE CHARMAP_FILE\n"
+                             "       %s [-j THREADS] [-c INCBIN_CACHE_DIR] -b LIST_FILE CHARMAP_FILE", program, program);
+        return 1;
+    }
 
-    char* extension = GetFileExtension(argv[1]);
+    g_charmap = new Charmap(argv[argc - 1]);
 
-    if (!extension)
-        FATAL_ERROR("\"%s\" has no file extension.\n", argv[1]);
+    if (!incbinCacheDir.empty())
+        g_incbinCache = new IncbinCache(incbinCacheDir);
 
-    if ((extension[0] == 's') && extension[1] == 0)
-        PreprocAsmFile(argv[1]);
-    else if ((extension[0] == 'c' || extension[0] == 'i') && extension[1] == 0)
-        PreprocCFile(argv[1]);
+    if (batch)
+        PreprocBatch(argv[2]);
     else
-        FATAL_ERROR("\"%s\" has an unknown file extension of \"%s\".\n", argv[1], extension);
+        PreprocFile(argv[1]);
 
     return 0;
 }
@@ -51,4 +51,8 @@ const unsigned long kMaxCharmapSequenceLength = 16;
 
 extern Charmap* g_charmap;
 
+// If set, called before an asm file reports a diagnostic, so that output
+// that is still pending can be written out first.
+extern void (*g_beforeDiagnostic)();
+
 #endif // PREPROC_H
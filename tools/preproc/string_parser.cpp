@@ -27,9 +27,9 @@
 #include "utf8.h"
 
 // Reads a charmap char or escape sequence.
-std::string StringParser::ReadCharOrEscape()
+CharmapSpan StringParser::ReadCharOrEscape()
 {
-    std::string sequence;
+    CharmapSpan sequence;
 
     bool isEscape = (m_buffer[m_pos] == '\\');
 
@@ -41,7 +41,7 @@ std::string StringParser::ReadCharOrEscape()
         {
             sequence = g_charmap->Char('"');
 
-            if (sequence.length() == 0)
+            if (sequence.length == 0)
                 RaiseError("no mapping exists for double quote");
 
             return sequence;
@@ -50,7 +50,7 @@ std::string StringParser::ReadCharOrEscape()
         {
             sequence = g_charmap->Char('\\');
 
-            if (sequence.length() == 0)
+            if (sequence.length == 0)
                 RaiseError("no mapping exists for backslash");
 
             return sequence;
@@ -82,7 +82,7 @@ std::string StringParser::ReadCharOrEscape()
 
     sequence = isEscape ? g_charmap->Escape(code) : g_charmap->Char(code);
 
-    if (sequence.length() == 0)
+    if (sequence.length == 0)
     {
         if (isEscape)
             RaiseError("unknown escape '\\%c'", code);
@@ -93,10 +93,20 @@ std::string StringParser::ReadCharOrEscape()
     return sequence;
 }
 
-// Reads a charmap constant, i.e. "{FOO}".
-std::string StringParser::ReadBracketedConstants()
+// Reads a charmap constant, i.e. "{FOO}", and appends its bytes to dest.
+// If they don't fit, the error is only raised once the whole group has been
+// parsed, so that syntax errors inside the brackets take precedence.
+void StringParser::ReadBracketedConstants(unsigned char* dest, int& destLength)
 {
-    std::string totalSequence;
+    bool overflow = false;
+
+    auto append = [&](unsigned char byte)
+    {
+        if (destLength == kMaxStringLength)
+            overflow = true;
+        else
+            dest[destLength++] = byte;
+    };
 
     m_pos++; // Assume we're on the left curly bracket.
 
@@ -113,15 +123,16 @@ std::string StringParser::ReadBracketedConstants()
             while (IsIdentifierChar(m_buffer[m_pos]))
                 m_pos++;
 
-            std::string sequence = g_charmap->Constant(std::string(&m_buffer[startPos], m_pos - startPos));
+            CharmapSpan sequence = g_charmap->Constant(&m_buffer[startPos], m_pos - startPos);
 
-            if (sequence.length() == 0)
+            if (sequence.length == 0)
             {
                 m_buffer[m_pos] = 0;
                 RaiseError("unknown constant '%s'", &m_buffer[startPos]);
             }
 
-            totalSequence += sequence;
+            for (std::size_t i = 0; i < sequence.length; i++)
+                append(sequence.data[i]);
         }
         else if (IsAsciiDigit(m_buffer[m_pos]))
         {
@@ -130,17 +141,17 @@ std::string StringParser::ReadBracketedConstants()
             switch (integer.size)
             {
             case 1:
-                totalSequence += (unsigned char)integer.value;
+                append((unsigned char)integer.value);
                 break;
             case 2:
-                totalSequence += (unsigned char)integer.value;
-                totalSequence += (unsigned char)(integer.value >> 8);
+                append((unsigned char)integer.value);
+                append((unsigned char)(integer.value >> 8));
                 break;
             case 4:
-                totalSequence += (unsigned char)integer.value;
-                totalSequence += (unsigned char)(integer.value >> 8);
-                totalSequence += (unsigned char)(integer.value >> 16);
-                totalSequence += (unsigned char)(integer.value >> 24);
+                append((unsigned char)integer.value);
+                append((unsigned char)(integer.value >> 8));
+                append((unsigned char)(integer.value >> 16));
+                append((unsigned char)(integer.value >> 24));
                 break;
             }
         }
@@ -162,7 +173,8 @@ std::string StringParser::ReadBracketedConstants()
 
     m_pos++; // Go past the right curly bracket.
 
-    return totalSequence;
+    if (overflow)
+        RaiseError("mapped string longer than %d bytes", kMaxStringLength);
 }
 
 // Reads a charmap string.
@@ -181,14 +193,20 @@ int StringParser::ParseString(long srcPos, unsigned char* dest, int& destLength)
 
     while (m_buffer[m_pos] != '"')
     {
-        std::string sequence = (m_buffer[m_pos] == '{') ? ReadBracketedConstants() : ReadCharOrEscape();
+        if (m_buffer[m_pos] == '{')
+        {
+            ReadBracketedConstants(dest, destLength);
+            continue;
+        }
+
+        CharmapSpan sequence = ReadCharOrEscape();
 
-        for (const char& c : sequence)
+        for (std::size_t i = 0; i < sequence.length; i++)
         {
             if (destLength == kMaxStringLength)
                 RaiseError("mapped string longer than %d bytes", kMaxStringLength);
 
-            dest[destLength++] = c;
+            dest[destLength++] = sequence.data[i];
         }
     }
 
@@ -24,6 +24,7 @@
 #include <cstdint>
 #include <string>
 #include "preproc.h"
+#include "charmap.h"
 
 class StringParser
 {
@@ -45,8 +46,8 @@ private:
     Integer ReadInteger();
     Integer ReadDecimal();
     Integer ReadHex();
-    std::string ReadCharOrEscape();
-    std::string ReadBracketedConstants();
+    CharmapSpan ReadCharOrEscape();
+    void ReadBracketedConstants(unsigned char* dest, int& destLength);
     void SkipWhitespace();
     void SkipRestOfInteger(int radix);
     void RaiseError(const char* format, ...);
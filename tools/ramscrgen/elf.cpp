@@ -1,7 +1,11 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
+#include <cstdlib>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <string>
 #include "ramscrgen.h"
@@ -9,264 +13,268 @@
 
 #define SHN_COMMON 0xFFF2
 
-static std::string s_elfPath;
-static std::string s_archiveFilePath;
-static std::string s_archiveObjectPath;
+// Reads little-endian values from an object in memory, exiting on any read
+// past its end.
+class ElfReader
+{
+public:
+    ElfReader(const ObjectFile& object)
+        : m_path(object.elfPath), m_data(object.data()), m_size(object.size)
+    {
+    }
 
-static FILE *s_file;
+    std::uint32_t ReadInt8(std::size_t offset) const
+    {
+        Check(offset, 1);
+        return m_data[offset];
+    }
 
-static std::uint32_t s_sectionHeaderOffset;
-static int s_sectionHeaderEntrySize;
-static int s_sectionCount;
-static int s_shstrtabIndex;
+    std::uint32_t ReadInt16(std::size_t offset) const
+    {
+        Check(offset, 2);
+        return m_data[offset] | (m_data[offset + 1] << 8);
+    }
 
-static std::uint32_t s_symtabOffset;
-static std::uint32_t s_strtabOffset;
+    std::uint32_t ReadInt32(std::size_t offset) const
+    {
+        Check(offset, 4);
+        return m_data[offset] | (m_data[offset + 1] << 8) | (m_data[offset + 2] << 16) | ((std::uint32_t)m_data[offset + 3] << 24);
+    }
 
-static std::uint32_t s_symbolCount;
-static std::uint32_t s_elfFileOffset;
+    std::string ReadString(std::size_t offset) const
+    {
+        Check(offset, 1);
+        const void *end = std::memchr(m_data + offset, 0, m_size - offset);
 
-struct Symbol
-{
-    std::uint32_t nameOffset;
-    std::uint32_t size;
+        if (end == nullptr)
+            FATAL_ERROR("error: unexpected EOF when reading ELF file \"%s\"\n", m_path.c_str());
+
+        return std::string((const char *)m_data + offset, (const char *)end);
+    }
+
+    bool Matches(std::size_t offset, const void *bytes, std::size_t length) const
+    {
+        return offset + length <= m_size && std::memcmp(m_data + offset, bytes, length) == 0;
+    }
+
+private:
+    void Check(std::size_t offset, std::size_t length) const
+    {
+        if (offset > m_size || length > m_size - offset)
+            FATAL_ERROR("error: unexpected EOF when reading ELF file \"%s\"\n", m_path.c_str());
+    }
+
+    const std::string& m_path;
+    const unsigned char *m_data;
+    std::size_t m_size;
 };
 
-static void Seek(long offset)
+struct Archive
 {
-    if (std::fseek(s_file, s_elfFileOffset + offset, SEEK_SET) != 0)
-        FATAL_ERROR("error: failed to seek to %ld in \"%s\"", offset, s_elfPath.c_str());
-}
+    std::shared_ptr<const std::vector<unsigned char>> buffer;
+    // Offset and size of each member's data, by name.
+    std::unordered_map<std::string, std::pair<std::size_t, std::size_t>> members;
+};
 
-static void Skip(long offset)
-{
-    if (std::fseek(s_file, offset, SEEK_CUR) != 0)
-        FATAL_ERROR("error: failed to skip %ld bytes in \"%s\"", offset, s_elfPath.c_str());
-}
+static std::map<std::string, Archive> s_archives;
 
-static std::uint32_t ReadInt8()
+static std::shared_ptr<std::vector<unsigned char>> ReadWholeFile(const std::string& path)
 {
-    int c = std::fgetc(s_file);
+    FILE *file = std::fopen(path.c_str(), "rb");
 
-    if (c < 0)
-        FATAL_ERROR("error: unexpected EOF when reading ELF file \"%s\"\n", s_elfPath.c_str());
+    if (file == NULL)
+        FATAL_ERROR("error: failed to open \"%s\" for reading\n", path.c_str());
 
-    return c;
-}
+    auto buffer = std::make_shared<std::vector<unsigned char>>();
+    unsigned char chunk[65536];
+    std::size_t count;
 
-static std::uint32_t ReadInt16()
-{
-    std::uint32_t val = 0;
-    val |= ReadInt8();
-    val |= ReadInt8() << 8;
-    return val;
-}
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) != 0)
+        buffer->insert(buffer->end(), chunk, chunk + count);
 
-static std::uint32_t ReadInt32()
-{
-    std::uint32_t val = 0;
-    val |= ReadInt8();
-    val |= ReadInt8() << 8;
-    val |= ReadInt8() << 16;
-    val |= ReadInt8() << 24;
-    return val;
+    if (std::ferror(file))
+        FATAL_ERROR("error: failed to read \"%s\"\n", path.c_str());
+
+    std::fclose(file);
+    return buffer;
 }
 
-static std::string ReadString()
+// Walks the archive's headers once, noting where each member is. Names are
+// either "name/" in the header itself or "/offset" into the "//" member.
+static void IndexArchive(const std::string& path, Archive& archive)
 {
-    std::string s;
-    char c;
+    const std::vector<unsigned char>& data = *archive.buffer;
+    const char expectedMagic[8] = {'!', '<', 'a', 'r', 'c', 'h', '>', '\n'};
+    const char expectedEndMagic[2] = { 0x60, 0x0a };
 
-    while ((c = ReadInt8()) != 0)
-        s += c;
+    if (data.size() < 8 || std::memcmp(data.data(), expectedMagic, 8) != 0)
+        FATAL_ERROR("error: AR magic did not match in \"%s\"\n", path.c_str());
 
-    return s;
-}
+    std::size_t pos = 8;
+    std::string longNames;
 
-static void VerifyElfIdent()
-{
-    char expectedMagic[4] = { 0x7F, 'E', 'L', 'F' };
-    char magic[4];
+    while (pos + 60 <= data.size())
+    {
+        const char *header = (const char *)&data[pos];
 
-    if (std::fread(magic, 4, 1, s_file) != 1)
-        FATAL_ERROR("error: failed to read ELF magic from \"%s\"\n", s_elfPath.c_str());
+        if (std::memcmp(header + 58, expectedEndMagic, 2) != 0)
+            FATAL_ERROR("error: corrupted archive header in \"%s\" at \"%.16s\"\n", path.c_str(), header);
 
-    if (std::memcmp(magic, expectedMagic, 4) != 0)
-        FATAL_ERROR("error: ELF magic did not match in \"%s\"\n", s_elfPath.c_str());
+        std::string name(header, 16);
+        std::size_t size = std::strtoul(std::string(header + 48, 10).c_str(), nullptr, 10);
+        pos += 60;
 
-    if (std::fgetc(s_file) != 1)
-        FATAL_ERROR("error: \"%s\" not 32-bit ELF\n", s_elfPath.c_str());
+        if (size > data.size() - pos)
+            FATAL_ERROR("error: member \"%s\" runs past the end of \"%s\"\n", name.c_str(), path.c_str());
 
-    if (std::fgetc(s_file) != 1)
-        FATAL_ERROR("error: \"%s\" not little-endian ELF\n", s_elfPath.c_str());
-}
+        if (name.compare(0, 2, "//") == 0)
+        {
+            longNames.assign((const char *)&data[pos], size);
+        }
+        else if (name[0] == '/' && name[1] >= '0' && name[1] <= '9')
+        {
+            std::size_t start = std::strtoul(name.c_str() + 1, nullptr, 10);
+            std::size_t end = longNames.find('/', start);
 
-static void VerifyAr()
-{
-    char expectedMagic[8] = {'!', '<', 'a', 'r', 'c', 'h', '>', '\n'};
-    char magic[8];
+            if (start < longNames.size())
+                archive.members.emplace(longNames.substr(start, end - start), std::make_pair(pos, size));
+        }
+        else
+        {
+            std::size_t end = name.find('/');
 
-    if (std::fread(magic, 8, 1, s_file) != 1)
-        FATAL_ERROR("error: failed to read AR magic from \"%s\"\n", s_archiveFilePath.c_str());
+            if (end == std::string::npos)
+                end = name.find_last_not_of(' ') + 1;
 
-    if (std::memcmp(magic, expectedMagic, 8) != 0)
-        FATAL_ERROR("error: AR magic did not match in \"%s\"\n", s_archiveFilePath.c_str());
+            // An empty name is the symbol table.
+            if (end != 0)
+                archive.members.emplace(name.substr(0, end), std::make_pair(pos, size));
+        }
+
+        // Members are padded to an even size.
+        pos += size + (size & 1);
+    }
 }
 
-static void ReadElfHeader()
+// The file that holds an object: the archive for "*ARCHIVE:MEMBER" paths.
+static std::string GetObjectContainerPath(const std::string& sourcePath, const std::string& path)
 {
-    Seek(0x20);
-    s_sectionHeaderOffset = ReadInt32();
-    Seek(0x2E);
-    s_sectionHeaderEntrySize = ReadInt16();
-    s_sectionCount = ReadInt16();
-    s_shstrtabIndex = ReadInt16();
+    if (path[0] != '*')
+        return sourcePath + "/" + path;
+
+    std::size_t colonPos = path.find(':');
+    if (colonPos == std::string::npos)
+        FATAL_ERROR("error: missing colon separator in libfile \"%s\"\n", path.c_str());
+
+    return sourcePath + "/" + path.substr(1, colonPos - 1);
 }
 
-static void FindArObj()
+ObjectFile ReadObjectFile(const std::string& sourcePath, const std::string& path)
 {
-    char file_ident[17] = {0};
-    char filesize_s[11] = {0};
-    char expectedEndMagic[2] = { 0x60, 0x0a };
-    char end_magic[2];
-    std::size_t filesize;
-
-    Seek(8);
-    while (!std::feof(s_file)) {
-        if (std::fread(file_ident, 16, 1, s_file) != 1)
-            FATAL_ERROR("error: failed to read file ident in \"%s\"\n", s_archiveFilePath.c_str());
-        Skip(32);
-        if (std::fread(filesize_s, 10, 1, s_file) != 1)
-            FATAL_ERROR("error: failed to read filesize in \"%s\"\n", s_archiveFilePath.c_str());
-        if (std::fread(end_magic, 2, 1, s_file) != 1)
-            FATAL_ERROR("error: failed to read end sentinel in \"%s\"\n", s_archiveFilePath.c_str());
-        if (std::memcmp(end_magic, expectedEndMagic, 2) != 0)
-            FATAL_ERROR("error: corrupted archive header in \"%s\" at \"%s\"\n", s_archiveFilePath.c_str(), file_ident);
-
-        char * ptr = std::strchr(file_ident, '/');
-        if (ptr != nullptr)
-            *ptr = 0;
-        filesize = std::strtoul(filesize_s, nullptr, 10);
-        if (std::strncmp(s_archiveObjectPath.c_str(), file_ident, 16) == 0) {
-            s_elfFileOffset = std::ftell(s_file);
-            return;
-        }
-        Skip(filesize);
+    ObjectFile object;
+    std::string containerPath = GetObjectContainerPath(sourcePath, path);
+
+    if (path[0] != '*')
+    {
+        object.elfPath = containerPath;
+        object.buffer = ReadWholeFile(containerPath);
+        object.offset = 0;
+        object.size = object.buffer->size();
+        return object;
     }
 
-    FATAL_ERROR("error: could not find object \"%s\" in archive \"%s\"\n", s_archiveObjectPath.c_str(), s_archiveFilePath.c_str());
-}
+    std::string objectName = path.substr(path.find(':') + 1);
+    object.elfPath = sourcePath + "/" + path.substr(1);
 
-static std::string GetSectionName(std::uint32_t shstrtabOffset, int index)
-{
-    Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * index);
-    std::uint32_t nameOffset = ReadInt32();
-    Seek(shstrtabOffset + nameOffset);
-    return ReadString();
+    auto it = s_archives.find(containerPath);
+
+    if (it == s_archives.end())
+    {
+        it = s_archives.emplace(containerPath, Archive()).first;
+        it->second.buffer = ReadWholeFile(containerPath);
+        IndexArchive(containerPath, it->second);
+    }
+
+    const Archive& archive = it->second;
+    auto member = archive.members.find(objectName);
+
+    if (member == archive.members.end())
+        FATAL_ERROR("error: could not find object \"%s\" in archive \"%s\"\n", objectName.c_str(), containerPath.c_str());
+
+    object.buffer = archive.buffer;
+    object.offset = member->second.first;
+    object.size = member->second.second;
+    return object;
 }
 
-static void FindTableOffsets()
+std::map<std::string, std::uint32_t> ParseCommonSymbols(const ObjectFile& object)
 {
-    s_symtabOffset = 0;
-    s_strtabOffset = 0;
+    ElfReader elf(object);
+    const char *path = object.elfPath.c_str();
+    const char expectedMagic[4] = { 0x7F, 'E', 'L', 'F' };
+
+    if (object.size < 4)
+        FATAL_ERROR("error: failed to read ELF magic from \"%s\"\n", path);
+
+    if (!elf.Matches(0, expectedMagic, 4))
+        FATAL_ERROR("error: ELF magic did not match in \"%s\"\n", path);
+
+    if (elf.ReadInt8(4) != 1)
+        FATAL_ERROR("error: \"%s\" not 32-bit ELF\n", path);
+
+    if (elf.ReadInt8(5) != 1)
+        FATAL_ERROR("error: \"%s\" not little-endian ELF\n", path);
 
-    Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * s_shstrtabIndex + 0x10);
-    std::uint32_t shstrtabOffset = ReadInt32();
+    std::uint32_t sectionHeaderOffset = elf.ReadInt32(0x20);
+    int sectionHeaderEntrySize = elf.ReadInt16(0x2E);
+    int sectionCount = elf.ReadInt16(0x30);
+    int shstrtabIndex = elf.ReadInt16(0x32);
 
-    for (int i = 0; i < s_sectionCount; i++)
+    std::uint32_t shstrtabOffset = elf.ReadInt32(sectionHeaderOffset + sectionHeaderEntrySize * shstrtabIndex + 0x10);
+    std::uint32_t symtabOffset = 0;
+    std::uint32_t strtabOffset = 0;
+    std::uint32_t symbolCount = 0;
+
+    for (int i = 0; i < sectionCount; i++)
     {
-        std::string name = GetSectionName(shstrtabOffset, i);
+        std::size_t header = sectionHeaderOffset + sectionHeaderEntrySize * i;
+        std::string name = elf.ReadString(shstrtabOffset + elf.ReadInt32(header));
 
         if (name == ".symtab")
         {
-            if (s_symtabOffset)
-                FATAL_ERROR("error: mutiple .symtab sections found in \"%s\"\n", s_elfPath.c_str());
-            Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * i + 0x10);
-            s_symtabOffset = ReadInt32();
-            std::uint32_t size = ReadInt32();
-            s_symbolCount = size / 16;
+            if (symtabOffset)
+                FATAL_ERROR("error: mutiple .symtab sections found in \"%s\"\n", path);
+            symtabOffset = elf.ReadInt32(header + 0x10);
+            symbolCount = elf.ReadInt32(header + 0x14) / 16;
         }
         else if (name == ".strtab")
         {
-            if (s_strtabOffset)
-                FATAL_ERROR("error: mutiple .strtab sections found in \"%s\"\n", s_elfPath.c_str());
-            Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * i + 0x10);
-            s_strtabOffset = ReadInt32();
+            if (strtabOffset)
+                FATAL_ERROR("error: mutiple .strtab sections found in \"%s\"\n", path);
+            strtabOffset = elf.ReadInt32(header + 0x10);
         }
     }
 
-    if (!s_symtabOffset)
-        FATAL_ERROR("error: couldn't find .symtab section in \"%s\"\n", s_elfPath.c_str());
+    if (!symtabOffset)
+        FATAL_ERROR("error: couldn't find .symtab section in \"%s\"\n", path);
 
-    if (!s_strtabOffset)
-        FATAL_ERROR("error: couldn't find .strtab section in \"%s\"\n", s_elfPath.c_str());
-}
-
-static std::map<std::string, std::uint32_t> GetCommonSymbols_Shared()
-{
-    VerifyElfIdent();
-    ReadElfHeader();
-    FindTableOffsets();
+    if (!strtabOffset)
+        FATAL_ERROR("error: couldn't find .strtab section in \"%s\"\n", path);
 
     std::map<std::string, std::uint32_t> commonSymbols;
 
-    std::vector<Symbol> commonSymbolVec;
-
-    Seek(s_symtabOffset);
-
-    for (std::uint32_t i = 0; i < s_symbolCount; i++)
+    for (std::uint32_t i = 0; i < symbolCount; i++)
     {
-        Symbol sym;
-        sym.nameOffset = ReadInt32();
-        Skip(4);
-        sym.size = ReadInt32();
-        Skip(2);
-        std::uint16_t sectionIndex = ReadInt16();
-        if (sectionIndex == SHN_COMMON)
-            commonSymbolVec.push_back(sym);
-    }
+        std::size_t symbol = symtabOffset + 16 * i;
 
-    for (const Symbol& sym : commonSymbolVec)
-    {
-        Seek(s_strtabOffset + sym.nameOffset);
-        std::string name = ReadString();
-        commonSymbols[name] = sym.size;
+        if (elf.ReadInt16(symbol + 14) == SHN_COMMON)
+            commonSymbols[elf.ReadString(strtabOffset + elf.ReadInt32(symbol))] = elf.ReadInt32(symbol + 8);
     }
 
     return commonSymbols;
 }
 
-std::map<std::string, std::uint32_t> GetCommonSymbolsFromLib(std::string sourcePath, std::string libpath)
-{
-    std::size_t colonPos = libpath.find(':');
-    if (colonPos == std::string::npos)
-        FATAL_ERROR("error: missing colon separator in libfile \"%s\"\n", s_elfPath.c_str());
-
-    s_archiveObjectPath = libpath.substr(colonPos + 1);
-    s_archiveFilePath = sourcePath + "/" + libpath.substr(1, colonPos - 1);
-    s_elfPath = sourcePath + "/" + libpath.substr(1);
-
-    s_file = std::fopen(s_archiveFilePath.c_str(), "rb");
-
-    if (s_file == NULL)
-        FATAL_ERROR("error: failed to open \"%s\" for reading\n", s_archiveFilePath.c_str());
-
-    VerifyAr();
-    FindArObj();
-    return GetCommonSymbols_Shared();
-}
-
 std::map<std::string, std::uint32_t> GetCommonSymbols(std::string sourcePath, std::string path)
 {
-    s_elfFileOffset = 0;
-    if (path[0] == '*')
-        return GetCommonSymbolsFromLib(sourcePath, path);
-
-    s_elfPath = sourcePath + "/" + path;
-    s_file = std::fopen(s_elfPath.c_str(), "rb");
-
-    if (s_file == NULL)
-        FATAL_ERROR("error: failed to open \"%s\" for reading\n", path.c_str());
-
-    return GetCommonSymbols_Shared();
+    return ParseCommonSymbols(ReadObjectFile(sourcePath, path));
 }
@@ -21,9 +21,29 @@
 #ifndef ELF_H
 #define ELF_H
 
+#include <cstddef>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
+
+// An object file read into memory, which may be a member of an archive.
+struct ObjectFile
+{
+    std::string elfPath;
+    std::shared_ptr<const std::vector<unsigned char>> buffer;
+    std::size_t offset;
+    std::size_t size;
+
+    const unsigned char *data() const { return buffer->data() + offset; }
+};
+
+// Reads an object, given either as a path or as "*ARCHIVE:MEMBER". Each
+// archive is read and indexed once, and kept in memory for later members.
+ObjectFile ReadObjectFile(const std::string& sourcePath, const std::string& path);
+
+std::map<std::string, std::uint32_t> ParseCommonSymbols(const ObjectFile& object);
 
 std::map<std::string, std::uint32_t> GetCommonSymbols(std::string sourcePath, std::string path);
 
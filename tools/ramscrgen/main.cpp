@@ -24,10 +24,13 @@
 #include "ramscrgen.h"
 #include "sym_file.h"
 #include "elf.h"
+#include "symbol_cache.h"
+
+static SymbolCache s_symbolCache;
 
 void HandleCommonInclude(std::string filename, std::string sourcePath, std::string symOrderPath, std::string lang)
 {
-    auto commonSymbols = GetCommonSymbols(sourcePath, filename);
+    const auto& commonSymbols = s_symbolCache.Get(sourcePath, filename);
     std::size_t dotIndex;
 
     if (filename[0] == '*') {
@@ -62,9 +65,10 @@ void HandleCommonInclude(std::string filename, std::string sourcePath, std::stri
         }
         else
         {
-            if (commonSymbols.count(label) == 0)
+            auto symbol = commonSymbols.find(label);
+            if (symbol == commonSymbols.end())
                 symFile.RaiseError("no common symbol named \"%s\"", label.c_str());
-            unsigned long size = commonSymbols[label];
+            unsigned long size = symbol->second;
             int alignment = 4;
             if (size > 4)
                 alignment = 8;
@@ -144,7 +148,7 @@ int main(int argc, char **argv)
 {
     if (argc < 4)
     {
-        fprintf(stderr, "Usage: %s SECTION_NAME SYM_FILE LANG [-c SRC_PATH,COMMON_SYM_PATH]", argv[0]);
+        fprintf(stderr, "Usage: %s SECTION_NAME SYM_FILE LANG [-c SRC_PATH,COMMON_SYM_PATH[,LIB_SRC_PATH]] [--cache CACHE_FILE]", argv[0]);
         return 1;
     }
 
@@ -155,17 +159,27 @@ int main(int argc, char **argv)
     std::string sourcePath;
     std::string commonSymPath;
     std::string libSourcePath;
+    std::string cachePath;
 
-    if (argc > 4)
+    for (int i = 4; i < argc; i++)
     {
-        if (std::strcmp(argv[4], "-c") != 0)
-            FATAL_ERROR("error: unrecognized argument \"%s\"\n", argv[4]);
+        if (std::strcmp(argv[i], "--cache") == 0)
+        {
+            if (i + 1 >= argc)
+                FATAL_ERROR("error: missing CACHE_FILE after \"--cache\"\n");
+
+            cachePath = argv[++i];
+            continue;
+        }
 
-        if (argc < 6)
+        if (std::strcmp(argv[i], "-c") != 0)
+            FATAL_ERROR("error: unrecognized argument \"%s\"\n", argv[i]);
+
+        if (i + 1 >= argc)
             FATAL_ERROR("error: missing SRC_PATH,COMMON_SYM_PATH after \"-c\"\n");
 
         common = true;
-        std::string paths = std::string(argv[5]);
+        std::string paths = std::string(argv[++i]);
         std::size_t commaPos = paths.find(',');
 
         if (commaPos == std::string::npos)
@@ -182,6 +196,13 @@ int main(int argc, char **argv)
         }
     }
 
+    if (!cachePath.empty())
+        s_symbolCache.Load(cachePath);
+
     ConvertSymFile(symFileName, sectionName, lang, common, sourcePath, commonSymPath, libSourcePath);
+
+    if (!cachePath.empty())
+        s_symbolCache.Save(cachePath);
+
     return 0;
 }
@@ -0,0 +1,153 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include "ramscrgen.h"
+#include "elf.h"
+#include "symbol_cache.h"
+
+static const char *const CACHE_MAGIC = "ramscrgen-cache 2";
+
+// Parses a whole field as an unsigned number, failing on anything else.
+static bool ParseNumber(const std::string& field, int base, unsigned long long& value)
+{
+    if (field.empty() || field[0] == '-' || field[0] == '+' || field[0] == ' ')
+        return false;
+
+    char *end;
+    errno = 0;
+    value = std::strtoull(field.c_str(), &end, base);
+    return errno == 0 && *end == '\0';
+}
+
+static std::uint64_t HashBytes(const unsigned char *data, std::size_t size)
+{
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (std::size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 0x100000001B3ULL;
+
+    return hash;
+}
+
+// Cache format, one record per line, fields separated by tabs:
+//   F <path> <hash>
+//   S <symbol> <size>
+// S lines belong to the most recent F line. A cache that doesn't parse is
+// ignored as a whole.
+void SymbolCache::Load(const std::string& path)
+{
+    std::ifstream in(path);
+
+    if (!in)
+        return;
+
+    std::string line;
+
+    if (!std::getline(in, line) || line != CACHE_MAGIC)
+        return;
+
+    std::map<std::string, SymbolEntry> entries;
+    SymbolEntry *entry = nullptr;
+
+    while (std::getline(in, line))
+    {
+        if (line.size() < 2 || line[1] != '\t')
+            return;
+
+        std::string rest = line.substr(2);
+        std::size_t tab = rest.find('\t');
+        unsigned long long value;
+
+        if (tab == std::string::npos)
+            return;
+
+        if (line[0] == 'F')
+        {
+            if (!ParseNumber(rest.substr(tab + 1), 16, value))
+                return;
+
+            entry = &entries[rest.substr(0, tab)];
+            entry->hash = value;
+        }
+        else if (line[0] == 'S' && entry != nullptr)
+        {
+            if (!ParseNumber(rest.substr(tab + 1), 10, value) || value > 0xFFFFFFFFULL)
+                return;
+
+            entry->commonSymbols[rest.substr(0, tab)] = value;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    m_entries.swap(entries);
+}
+
+void SymbolCache::Save(const std::string& path)
+{
+    if (!m_dirty)
+        return;
+
+    std::string tmpPath = path + ".tmp";
+    FILE *fp = std::fopen(tmpPath.c_str(), "wb");
+
+    if (fp == NULL)
+        FATAL_ERROR("error: failed to open \"%s\" for writing\n", tmpPath.c_str());
+
+    std::fprintf(fp, "%s\n", CACHE_MAGIC);
+
+    for (const auto& pair : m_entries)
+    {
+        const SymbolEntry& entry = pair.second;
+
+        std::fprintf(fp, "F\t%s\t%016llx\n", pair.first.c_str(), (unsigned long long)entry.hash);
+        for (const auto& symbol : entry.commonSymbols)
+            std::fprintf(fp, "S\t%s\t%lu\n", symbol.first.c_str(), (unsigned long)symbol.second);
+    }
+
+    std::fclose(fp);
+
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+        FATAL_ERROR("error: failed to rename \"%s\" to \"%s\"\n", tmpPath.c_str(), path.c_str());
+}
+
+const std::map<std::string, std::uint32_t>& SymbolCache::Get(const std::string& sourcePath, const std::string& path)
+{
+    std::string key = sourcePath + "/" + (path[0] == '*' ? path.substr(1) : path);
+    ObjectFile object = ReadObjectFile(sourcePath, path);
+    std::uint64_t hash = HashBytes(object.data(), object.size);
+    auto it = m_entries.find(key);
+
+    if (it != m_entries.end() && it->second.hash == hash)
+        return it->second.commonSymbols;
+
+    SymbolEntry& entry = m_entries[key];
+    entry.hash = hash;
+    entry.commonSymbols = ParseCommonSymbols(object);
+    m_dirty = true;
+    return entry.commonSymbols;
+}
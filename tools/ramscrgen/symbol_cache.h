@@ -0,0 +1,52 @@
+// Copyright(c) 2016 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SYMBOL_CACHE_H
+#define SYMBOL_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+// The common symbols of one object file.
+struct SymbolEntry
+{
+    std::uint64_t hash;
+    std::map<std::string, std::uint32_t> commonSymbols;
+};
+
+// Remembers each object's common symbols on disk, so that regenerating the
+// linker script only parses objects that have changed. Entries are keyed by
+// path and hold a hash of the object's contents. Every object is still read
+// and hashed, since a changed common symbol size need not change the file's
+// size, but its symbols are only parsed again if the hash differs.
+class SymbolCache
+{
+public:
+    void Load(const std::string& path);
+    void Save(const std::string& path);
+    const std::map<std::string, std::uint32_t>& Get(const std::string& sourcePath, const std::string& path);
+
+private:
+    std::map<std::string, SymbolEntry> m_entries;
+    bool m_dirty = false;
+};
+
+#endif // SYMBOL_CACHE_H
@@ -18,40 +18,39 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <cstdio>
 #include <string>
 #include "scaninc.h"
 #include "asm_file.h"
+#include "byte_set.h"
 
-AsmFile::AsmFile(std::string path)
+AsmFile::AsmFile(std::string path) : m_file(path, false)
 {
     m_path = path;
-
-    FILE *fp = std::fopen(path.c_str(), "rb");
-
-    if (fp == NULL)
-        FATAL_ERROR("Failed to open \"%s\" for reading.\n", path.c_str());
-
-    std::fseek(fp, 0, SEEK_END);
-
-    m_size = std::ftell(fp);
-
-    m_buffer = new char[m_size];
-
-    std::rewind(fp);
-
-    if (std::fread(m_buffer, m_size, 1, fp) != 1)
-        FATAL_ERROR("Failed to read \"%s\".\n", path.c_str());
-
-    std::fclose(fp);
-
+    m_buffer = m_file.Data();
+    m_size = m_file.Size();
     m_pos = 0;
     m_lineNum = 1;
 }
 
 AsmFile::~AsmFile()
 {
-    delete[] m_buffer;
+}
+
+// Bytes that GetChar() or the callers below react to. '\xFF' is included
+// because GetChar() sign-extends it to -1, which reads as end of file.
+static const ByteSet s_lineStopBytes{';', '/', '"', '\n', '\r', '\xFF'};
+static const ByteSet s_lineCommentStopBytes{'\n', '\r', '\xFF'};
+static const ByteSet s_blockCommentStopBytes{'*', '\r', '\xFF'};
+static const ByteSet s_stringStopBytes{'"', '\\', '\r', '\xFF'};
+
+void AsmFile::SkipUntil(const ByteSet& stopBytes)
+{
+    int next = stopBytes.FindFirst(m_buffer, m_pos, m_size);
+
+    m_lineNum += std::count(m_buffer + m_pos, m_buffer + next, '\n');
+    m_pos = next;
 }
 
 IncDirectiveType AsmFile::ReadUntilIncDirective(std::string &path)
@@ -77,6 +76,8 @@ IncDirectiveType AsmFile::ReadUntilIncDirective(std::string &path)
 
         for (;;)
         {
+            SkipUntil(s_lineStopBytes);
+
             int c = GetChar();
 
             if (c == -1)
@@ -147,6 +148,7 @@ void AsmFile::SkipEndOfLineComment()
 
     do
     {
+        SkipUntil(s_lineCommentStopBytes);
         c = GetChar();
     } while (c != -1 && c != '\n');
 }
@@ -155,6 +157,8 @@ void AsmFile::SkipMultiLineComment()
 {
     for (;;)
     {
+        SkipUntil(s_blockCommentStopBytes);
+
         int c = GetChar();
 
         if (c == '*')
@@ -176,6 +180,8 @@ void AsmFile::SkipString()
 {
     for (;;)
     {
+        SkipUntil(s_stringStopBytes);
+
         int c = GetChar();
 
         if (c == '"')
@@ -22,7 +22,11 @@
 #define ASM_FILE_H
 
 #include <string>
+#include <string_view>
 #include "scaninc.h"
+#include "mapped_file.h"
+
+class ByteSet;
 
 enum class IncDirectiveType
 {
@@ -39,7 +43,8 @@ public:
     IncDirectiveType ReadUntilIncDirective(std::string& path);
 
 private:
-    char *m_buffer;
+    MappedFile m_file;
+    const char *m_buffer;
     int m_pos;
     int m_size;
     int m_lineNum;
@@ -86,7 +91,7 @@ private:
             m_pos++;
     }
 
-    bool MatchIncDirective(std::string directiveName, std::string& path)
+    bool MatchIncDirective(std::string_view directiveName, std::string& path)
     {
         int length = directiveName.length();
         int i;
@@ -103,13 +108,17 @@ private:
         SkipTabsAndSpaces();
 
         if (GetChar() != '"')
-            FATAL_INPUT_ERROR("no path after \".%s\" directive\n", directiveName.c_str());
+            FATAL_INPUT_ERROR("no path after \".%.*s\" directive\n", (int)directiveName.size(), directiveName.data());
 
         path = ReadPath();
 
         return true;
     }
 
+    // Advances to the next byte in stopBytes without returning it, counting
+    // the newlines that were skipped over.
+    void SkipUntil(const ByteSet& stopBytes);
+
     std::string ReadPath();
     void SkipEndOfLineComment();
     void SkipMultiLineComment();
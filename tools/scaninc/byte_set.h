@@ -0,0 +1,95 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef BYTE_SET_H
+#define BYTE_SET_H
+
+#include <cstddef>
+#include <initializer_list>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A small set of byte values that can be searched for like memchr. The
+// scanners use it to skip over runs of bytes that can't affect their state.
+class ByteSet
+{
+public:
+    ByteSet(std::initializer_list<char> bytes) : m_table(), m_count(0)
+    {
+        for (char c : bytes)
+        {
+            m_table[static_cast<unsigned char>(c)] = true;
+            if (m_count < kMaxBytes)
+                m_bytes[m_count] = c;
+            m_count++;
+        }
+    }
+
+    bool Contains(char c) const
+    {
+        return m_table[static_cast<unsigned char>(c)];
+    }
+
+    // Returns the position of the first byte in [pos, end) that is in the
+    // set, or end if there isn't one.
+    int FindFirst(const char *data, int pos, int end) const
+    {
+#ifdef __SSE2__
+        if (m_count <= kMaxBytes)
+        {
+            __m128i needles[kMaxBytes];
+
+            for (int i = 0; i < m_count; i++)
+                needles[i] = _mm_set1_epi8(m_bytes[i]);
+
+            while (pos + 16 <= end)
+            {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+                __m128i hits = _mm_cmpeq_epi8(chunk, needles[0]);
+
+                for (int i = 1; i < m_count; i++)
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[i]));
+
+                int mask = _mm_movemask_epi8(hits);
+
+                if (mask != 0)
+                    return pos + __builtin_ctz(mask);
+
+                pos += 16;
+            }
+        }
+#endif
+        while (pos < end && !Contains(data[pos]))
+            pos++;
+
+        return pos;
+    }
+
+private:
+    static const int kMaxBytes = 8;
+
+    bool m_table[256];
+    char m_bytes[kMaxBytes];
+    int m_count;
+};
+
+#endif // BYTE_SET_H
@@ -18,38 +18,35 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include "c_file.h"
+#include "byte_set.h"
 
-CFile::CFile(std::string path)
+CFile::CFile(std::string path) : m_file(path, true)
 {
     m_path = path;
-
-    FILE *fp = std::fopen(path.c_str(), "rb");
-
-    if (fp == NULL)
-        FATAL_ERROR("Failed to open \"%s\" for reading.\n", path.c_str());
-
-    std::fseek(fp, 0, SEEK_END);
-
-    m_size = std::ftell(fp);
-
-    m_buffer = new char[m_size + 1];
-    m_buffer[m_size] = 0;
-
-    std::rewind(fp);
-
-    if (std::fread(m_buffer, m_size, 1, fp) != 1)
-        FATAL_ERROR("Failed to read \"%s\".\n", path.c_str());
-
-    std::fclose(fp);
-
+    m_buffer = m_file.Data();
+    m_size = m_file.Size();
     m_pos = 0;
     m_lineNum = 1;
 }
 
 CFile::~CFile()
 {
-    delete[] m_buffer;
+}
+
+// Bytes that can change the scanner's state outside of a string literal.
+// Anything else is consumed one character at a time with no other effect, so
+// runs of such bytes are skipped in bulk (counting the newlines in them).
+static const ByteSet s_codeStopBytes{'"', '\'', '/', '#', 'I', '\0'};
+
+// Inside a string literal only the closing quote and escapes matter.
+static const ByteSet s_doubleQuoteStopBytes{'"', '\\'};
+static const ByteSet s_singleQuoteStopBytes{'\'', '\\'};
+
+static int CountNewlines(const char *data, int start, int end)
+{
+    return std::count(data + start, data + end, '\n');
 }
 
 void CFile::FindIncbins()
@@ -60,6 +57,14 @@ void CFile::FindIncbins()
     {
         if (stringChar)
         {
+            int next = (stringChar == '"' ? s_doubleQuoteStopBytes : s_singleQuoteStopBytes).FindFirst(m_buffer, m_pos, m_size);
+
+            m_lineNum += CountNewlines(m_buffer, m_pos, next);
+            m_pos = next;
+
+            if (m_pos >= m_size)
+                break;
+
             if (m_buffer[m_pos] == stringChar)
             {
                 m_pos++;
@@ -78,6 +83,11 @@ void CFile::FindIncbins()
         }
         else
         {
+            int next = s_codeStopBytes.FindFirst(m_buffer, m_pos, m_size);
+
+            m_lineNum += CountNewlines(m_buffer, m_pos, next);
+            m_pos = next;
+
             SkipWhitespace();
             CheckInclude();
             CheckIncbin();
@@ -165,7 +175,7 @@ void CFile::SkipWhitespace()
         ;
 }
 
-bool CFile::CheckIdentifier(const std::string& ident)
+bool CFile::CheckIdentifier(std::string_view ident)
 {
     unsigned int i;
 
@@ -181,7 +191,7 @@ void CFile::CheckInclude()
     if (m_buffer[m_pos] != '#')
         return;
 
-    std::string ident = "#include";
+    std::string_view ident = "#include";
 
     if (!CheckIdentifier(ident))
     {
@@ -213,7 +223,7 @@ void CFile::CheckIncbin()
             return;
     }
 
-    std::string idents[6] = { "INCBIN_S8", "INCBIN_U8", "INCBIN_S16", "INCBIN_U16", "INCBIN_S32", "INCBIN_U32" };
+    static const std::string_view idents[6] = { "INCBIN_S8", "INCBIN_U8", "INCBIN_S16", "INCBIN_U16", "INCBIN_S32", "INCBIN_U32" };
     int incbinType = -1;
 
     for (int i = 0; i < 6; i++)
@@ -24,7 +24,9 @@
 #include <string>
 #include <set>
 #include <memory>
+#include <string_view>
 #include "scaninc.h"
+#include "mapped_file.h"
 
 class CFile
 {
@@ -36,7 +38,8 @@ public:
     const std::set<std::string>& GetIncludes() { return m_includes; }
 
 private:
-    char *m_buffer;
+    MappedFile m_file;
+    const char *m_buffer;
     int m_pos;
     int m_size;
     int m_lineNum;
@@ -48,7 +51,7 @@ private:
     bool ConsumeNewline();
     bool ConsumeComment();
     void SkipWhitespace();
-    bool CheckIdentifier(const std::string& ident);
+    bool CheckIdentifier(std::string_view ident);
     void CheckInclude();
     void CheckIncbin();
     std::string ReadPath();
@@ -0,0 +1,68 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <dirent.h>
+#include "include_index.h"
+
+const std::unordered_set<std::string>& IncludeIndex::GetDirListing(const std::string& dir)
+{
+    auto it = m_dirs.find(dir);
+
+    if (it != m_dirs.end())
+        return it->second;
+
+    std::unordered_set<std::string>& names = m_dirs[dir];
+    DIR *dp = opendir(dir.empty() ? "." : dir.c_str());
+
+    m_listings++;
+
+    if (dp == NULL)
+        return names;
+
+    struct dirent *entry;
+
+    while ((entry = readdir(dp)) != NULL)
+        names.insert(entry->d_name);
+
+    closedir(dp);
+
+    return names;
+}
+
+bool IncludeIndex::Exists(const std::string& path)
+{
+    std::size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    std::string name = path.substr(slash + 1);
+
+    m_lookups++;
+
+    if (name.empty() || name == "." || name == "..")
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetDirListing(dir).count(name) != 0;
+}
+
+void IncludeIndex::PrintStats(FILE *fp)
+{
+    std::fprintf(fp, "scaninc: %ld include probes answered from %ld directory listings\n",
+        (long)m_lookups, (long)m_listings);
+}
@@ -0,0 +1,50 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef INCLUDE_INDEX_H
+#define INCLUDE_INDEX_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include "scaninc.h"
+
+// Answers "does this file exist?" from directory listings instead of probing
+// the file system once per candidate path. Each directory is listed at most
+// once, and directories that don't exist are remembered as empty.
+class IncludeIndex
+{
+public:
+    IncludeIndex() : m_lookups(0), m_listings(0) {}
+    bool Exists(const std::string& path);
+    void PrintStats(FILE *fp);
+
+private:
+    std::map<std::string, std::unordered_set<std::string>> m_dirs;
+    std::mutex m_mutex;
+    std::atomic<long> m_lookups;
+    std::atomic<long> m_listings;
+
+    const std::unordered_set<std::string>& GetDirListing(const std::string& dir);
+};
+
+#endif // INCLUDE_INDEX_H
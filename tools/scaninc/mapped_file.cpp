@@ -0,0 +1,99 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cstdio>
+#include "mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path, bool nulTerminated)
+    : m_data(nullptr), m_size(0), m_mapping(nullptr), m_mappingSize(0), m_heapBuffer(nullptr)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        FATAL_ERROR("Failed to open \"%s\" for reading.\n", path.c_str());
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0)
+        FATAL_ERROR("Failed to read \"%s\".\n", path.c_str());
+
+    m_size = st.st_size;
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+
+    // The tail of the last page is zero-filled, so a file whose size isn't a
+    // multiple of the page size is already NUL-terminated in memory.
+    bool canMap = m_size > 0 && (!nulTerminated || m_size % pageSize != 0);
+
+    if (canMap)
+    {
+        void *mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping != MAP_FAILED)
+        {
+            m_mapping = mapping;
+            m_mappingSize = m_size;
+            m_data = static_cast<const char *>(mapping);
+            close(fd);
+            return;
+        }
+    }
+
+    close(fd);
+#endif
+
+    FILE *fp = std::fopen(path.c_str(), "rb");
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\" for reading.\n", path.c_str());
+
+    std::fseek(fp, 0, SEEK_END);
+
+    m_size = std::ftell(fp);
+
+    m_heapBuffer = new char[m_size + 1];
+    m_heapBuffer[m_size] = 0;
+
+    std::rewind(fp);
+
+    if (m_size > 0 && std::fread(m_heapBuffer, m_size, 1, fp) != 1)
+        FATAL_ERROR("Failed to read \"%s\".\n", path.c_str());
+
+    std::fclose(fp);
+
+    m_data = m_heapBuffer;
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (m_mapping != nullptr)
+        munmap(m_mapping, m_mappingSize);
+#endif
+    delete[] m_heapBuffer;
+}
@@ -0,0 +1,51 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "scaninc.h"
+
+// Read-only view of a whole file. The file is memory-mapped where possible
+// and read into a heap buffer otherwise. If nulTerminated is set, the byte at
+// Size() is guaranteed to be 0, which the C scanner relies on.
+class MappedFile
+{
+public:
+    MappedFile(const std::string& path, bool nulTerminated);
+    ~MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator =(MappedFile const&) = delete;
+    const char *Data() const { return m_data; }
+    int Size() const { return m_size; }
+    std::string_view View() const { return std::string_view(m_data, m_size); }
+
+private:
+    const char *m_data;
+    int m_size;
+    void *m_mapping;
+    std::size_t m_mappingSize;
+    char *m_heapBuffer;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,196 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include "parallel_scan.h"
+
+namespace {
+
+// Set of paths already queued, split into shards to reduce lock contention.
+class VisitedSet
+{
+public:
+    bool Insert(const std::string& path)
+    {
+        Shard& shard = m_shards[std::hash<std::string>()(path) % kNumShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.paths.insert(path).second;
+    }
+
+private:
+    static const int kNumShards = 64;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_set<std::string> paths;
+    } m_shards[kNumShards];
+};
+
+// A worker pops from the back of its own queue and steals from the front of
+// the others' queues when its own is empty.
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<std::string> paths;
+};
+
+class Prescanner
+{
+public:
+    Prescanner(const std::vector<std::string>& includeDirs, ScanCache& cache, unsigned numThreads)
+        : m_includeDirs(includeDirs), m_cache(cache), m_queues(numThreads), m_pending(0), m_queued(0)
+    {
+    }
+
+    void Push(unsigned worker, const std::string& path)
+    {
+        if (!m_visited.Insert(path))
+            return;
+
+        m_pending++;
+
+        {
+            WorkQueue& queue = m_queues[worker];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.paths.push_back(path);
+        }
+
+        m_queued++;
+        Wake(false);
+    }
+
+    void Run()
+    {
+        std::vector<std::thread> threads;
+
+        for (unsigned i = 1; i < m_queues.size(); i++)
+            threads.emplace_back(&Prescanner::Work, this, i);
+
+        Work(0);
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+private:
+    const std::vector<std::string>& m_includeDirs;
+    ScanCache& m_cache;
+    std::vector<WorkQueue> m_queues;
+    VisitedSet m_visited;
+    std::atomic<long> m_pending; // paths queued or being scanned
+    std::atomic<long> m_queued;  // paths in the queues
+    std::mutex m_idleMutex;
+    std::condition_variable m_idle;
+
+    // Wakes idle workers. Taking the mutex first means a worker that has
+    // just checked for work and found none is already waiting.
+    void Wake(bool all)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+        }
+
+        if (all)
+            m_idle.notify_all();
+        else
+            m_idle.notify_one();
+    }
+
+    bool Pop(unsigned worker, std::string& path)
+    {
+        for (std::size_t i = 0; i < m_queues.size(); i++)
+        {
+            WorkQueue& queue = m_queues[(worker + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.paths.empty())
+                continue;
+
+            if (i == 0)
+            {
+                path = std::move(queue.paths.back());
+                queue.paths.pop_back();
+            }
+            else
+            {
+                path = std::move(queue.paths.front());
+                queue.paths.pop_front();
+            }
+
+            m_queued--;
+            return true;
+        }
+
+        return false;
+    }
+
+    void Work(unsigned worker)
+    {
+        std::string path;
+
+        while (m_pending > 0)
+        {
+            if (!Pop(worker, path))
+            {
+                // Sleep until there's work to steal or everything is done.
+                std::unique_lock<std::mutex> lock(m_idleMutex);
+                m_idle.wait(lock, [this] { return m_queued > 0 || m_pending == 0; });
+                continue;
+            }
+
+            const ScanEntry& file = m_cache.Get(path);
+
+            for (const std::string& include : file.includes)
+            {
+                std::string resolved;
+
+                if (ResolveInclude(m_includeDirs, file.srcDir, include, resolved))
+                    Push(worker, resolved);
+            }
+
+            // Only finish the item after its children are queued, so the
+            // count can't reach zero while there's still work to discover.
+            if (--m_pending == 0)
+                Wake(true);
+        }
+    }
+};
+
+} // namespace
+
+void PrescanParallel(const std::vector<std::string>& roots, const std::vector<std::string>& includeDirs, ScanCache& cache, unsigned numThreads)
+{
+    if (numThreads == 0)
+        numThreads = 1;
+
+    Prescanner prescanner(includeDirs, cache, numThreads);
+
+    for (std::size_t i = 0; i < roots.size(); i++)
+        prescanner.Push(i % numThreads, roots[i]);
+
+    prescanner.Run();
+}
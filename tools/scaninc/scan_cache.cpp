@@ -0,0 +1,202 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <utility>
+#include "scan_cache.h"
+
+static const char *const CACHE_MAGIC = "scaninc-cache 2";
+
+// Stands in for the mtime of an entry that mustn't be trusted on a later run.
+static const std::int64_t UNTRUSTED_MTIME = INT64_MIN;
+
+// Files modified this recently (in nanoseconds) may still change without
+// their mtime moving on, if the file system's clock is coarse.
+static const std::int64_t RACY_INTERVAL = 2000000000;
+
+// Gets the file's mtime in nanoseconds.
+static bool StatFile(const std::string& path, std::int64_t& mtime, std::int64_t& size)
+{
+    struct stat st;
+
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+
+#if defined(__APPLE__)
+    mtime = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    mtime = st.st_mtime * 1000000000LL;
+#else
+    mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    size = st.st_size;
+    return true;
+}
+
+static std::int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Cache format, one record per line, fields separated by tabs:
+//   F <path> <mtime in nanoseconds> <size> <type>
+//   I <include>
+//   B <incbin>
+// I and B lines belong to the most recent F line.
+void ScanCache::Load(const std::string& path)
+{
+    std::ifstream in(path);
+
+    if (!in)
+        return;
+
+    std::string line;
+
+    if (!std::getline(in, line) || line != CACHE_MAGIC)
+        return;
+
+    ScanEntry *entry = nullptr;
+
+    while (std::getline(in, line))
+    {
+        if (line.size() < 2 || line[1] != '\t')
+            return;
+
+        std::string rest = line.substr(2);
+
+        if (line[0] == 'F')
+        {
+            std::size_t a = rest.find('\t');
+            std::size_t b = a == std::string::npos ? a : rest.find('\t', a + 1);
+            std::size_t c = b == std::string::npos ? b : rest.find('\t', b + 1);
+
+            if (c == std::string::npos)
+                return;
+
+            std::string filePath = rest.substr(0, a);
+            entry = &m_entries[filePath];
+            entry->mtime = std::stoll(rest.substr(a + 1, b - a - 1));
+            entry->size = std::stoll(rest.substr(b + 1, c - b - 1));
+            entry->fileType = static_cast<SourceFileType>(std::stoi(rest.substr(c + 1)));
+            entry->srcDir = GetDir(filePath);
+        }
+        else if (entry == nullptr)
+        {
+            return;
+        }
+        else if (line[0] == 'I')
+        {
+            entry->includes.insert(rest);
+        }
+        else if (line[0] == 'B')
+        {
+            entry->incbins.insert(rest);
+        }
+    }
+}
+
+void ScanCache::Save(const std::string& path)
+{
+    if (!m_dirty)
+        return;
+
+    std::string tmpPath = path + ".tmp";
+    FILE *fp = std::fopen(tmpPath.c_str(), "wb");
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\" for writing.\n", tmpPath.c_str());
+
+    std::fprintf(fp, "%s\n", CACHE_MAGIC);
+
+    for (const auto& pair : m_entries)
+    {
+        const ScanEntry& entry = pair.second;
+
+        std::fprintf(fp, "F\t%s\t%lld\t%lld\t%d\n", pair.first.c_str(),
+            (long long)entry.mtime, (long long)entry.size, static_cast<int>(entry.fileType));
+        for (const std::string& include : entry.includes)
+            std::fprintf(fp, "I\t%s\n", include.c_str());
+        for (const std::string& incbin : entry.incbins)
+            std::fprintf(fp, "B\t%s\n", incbin.c_str());
+    }
+
+    std::fclose(fp);
+
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+        FATAL_ERROR("Failed to rename \"%s\" to \"%s\".\n", tmpPath.c_str(), path.c_str());
+}
+
+const ScanEntry& ScanCache::Get(std::string path)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(path);
+
+    if (it != m_entries.end() && m_validated.count(path))
+        return it->second;
+
+    bool haveEntry = it != m_entries.end();
+    std::int64_t cachedMtime = haveEntry ? it->second.mtime : -1;
+    std::int64_t cachedSize = haveEntry ? it->second.size : -1;
+
+    lock.unlock();
+
+    std::int64_t mtime = -1;
+    std::int64_t size = -1;
+
+    StatFile(path, mtime, size);
+
+    if (haveEntry && cachedMtime != UNTRUSTED_MTIME && cachedMtime == mtime && cachedSize == size)
+    {
+        lock.lock();
+        m_validated.insert(path);
+        return m_entries[path];
+    }
+
+    // Parse outside the lock so that other threads can make progress.
+    SourceFile file(path);
+    ScanEntry parsed;
+
+    // A file written within the last moment could be rewritten again with
+    // the same size and mtime, so it will be parsed again next time, as git
+    // does for "racily clean" files.
+    parsed.mtime = mtime > Now() - RACY_INTERVAL ? UNTRUSTED_MTIME : mtime;
+    parsed.size = size;
+    parsed.fileType = file.FileType();
+    parsed.srcDir = file.GetSrcDir();
+    parsed.includes = file.GetIncludes();
+    parsed.incbins = file.GetIncbins();
+
+    lock.lock();
+
+    // Another thread may have finished the same file first.
+    if (m_validated.insert(path).second)
+    {
+        m_entries[path] = std::move(parsed);
+        m_dirty = true;
+    }
+
+    return m_entries[path];
+}
@@ -0,0 +1,63 @@
+// Copyright(c) 2015-2017 YamaArashi
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SCAN_CACHE_H
+#define SCAN_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include "scaninc.h"
+#include "source_file.h"
+
+// The directives found in a single source file, independent of which file
+// included it or which include paths are in effect.
+struct ScanEntry
+{
+    std::int64_t mtime;
+    std::int64_t size;
+    SourceFileType fileType;
+    std::string srcDir;
+    std::set<std::string> includes;
+    std::set<std::string> incbins;
+};
+
+// Parses each source file at most once per process, and remembers the
+// results on disk so that unchanged files are not parsed again on later runs.
+// Entries are keyed by path and validated against the file's mtime (to the
+// nanosecond) and size.
+// Get() may be called from several threads at once.
+class ScanCache
+{
+public:
+    void Load(const std::string& path);
+    void Save(const std::string& path);
+    const ScanEntry& Get(std::string path);
+
+private:
+    std::map<std::string, ScanEntry> m_entries;
+    std::set<std::string> m_validated;
+    bool m_dirty = false;
+    std::mutex m_mutex;
+};
+
+#endif // SCAN_CACHE_H
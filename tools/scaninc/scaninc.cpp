@@ -18,39 +18,151 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <list>
 #include <queue>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
 #include "scaninc.h"
 #include "source_file.h"
+#include "scan_cache.h"
+#include "parallel_scan.h"
+#include "include_index.h"
 
-bool CanOpenFile(std::string path)
-{
-    FILE *fp = std::fopen(path.c_str(), "rb");
+#ifdef _WIN32
+#include <direct.h>
+#define MKDIR(path) _mkdir(path)
+#else
+#define MKDIR(path) mkdir(path, 0777)
+#endif
 
-    if (fp == NULL)
-        return false;
+static IncludeIndex s_includeIndex;
 
-    std::fclose(fp);
-    return true;
+// Searches the include paths, followed by the including file's directory.
+// On failure, path is left as the last candidate that was tried.
+bool ResolveInclude(const std::vector<std::string>& includeDirs, const std::string& srcDir, const std::string& include, std::string& path)
+{
+    for (auto includeDir : includeDirs)
+    {
+        path = includeDir + include;
+        if (s_includeIndex.Exists(path))
+            return true;
+    }
+    path = srcDir + include;
+    return s_includeIndex.Exists(path);
 }
 
-const char *const USAGE = "Usage: scaninc [-I INCLUDE_PATH] FILE_PATH\n";
+const char *const USAGE = "Usage: scaninc [--stats] [-j THREADS] [-I INCLUDE_PATH] FILE_PATH\n"
+                          "       scaninc -M OBJ_DIR [-c CACHE_FILE] [--stats] [-j THREADS] [-I INCLUDE_PATH] FILE_PATH...\n";
 
-int main(int argc, char **argv)
+std::set<std::string> ScanDependencies(const std::string& initialPath, const std::vector<std::string>& includeDirs, ScanCache& cache)
 {
     std::queue<std::string> filesToProcess;
     std::set<std::string> dependencies;
 
+    filesToProcess.push(initialPath);
+
+    while (!filesToProcess.empty())
+    {
+        const ScanEntry& file = cache.Get(filesToProcess.front());
+        filesToProcess.pop();
+
+        for (auto incbin : file.incbins)
+        {
+            dependencies.insert(incbin);
+        }
+        for (auto include : file.includes)
+        {
+            std::string path("");
+            bool exists = ResolveInclude(includeDirs, file.srcDir, include, path);
+            if (!exists && (file.fileType == SourceFileType::Asm || file.fileType == SourceFileType::Inc))
+            {
+                path = include;
+            }
+            bool inserted = dependencies.insert(path).second;
+            if (inserted && exists)
+            {
+                filesToProcess.push(path);
+            }
+        }
+    }
+
+    return dependencies;
+}
+
+void MakeParentDirs(const std::string& path)
+{
+    for (std::size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+    {
+        std::string dir = path.substr(0, slash);
+        if (MKDIR(dir.c_str()) != 0 && errno != EEXIST)
+            FATAL_ERROR("Failed to create directory \"%s\".\n", dir.c_str());
+    }
+}
+
+// Writes a make rule "OBJ_DIR/FILE.o: deps..." to OBJ_DIR/FILE.d, followed by an
+// empty rule for each dependency so that deleting a header doesn't break the build.
+// The depfile is left untouched if its contents haven't changed.
+void WriteDepFile(const std::string& objDir, const std::string& sourcePath, const std::set<std::string>& dependencies)
+{
+    std::string stem = objDir + sourcePath.substr(0, sourcePath.find_last_of('.'));
+    std::string depPath = stem + ".d";
+    std::string text = stem + ".o: " + sourcePath;
+
+    for (const std::string& path : dependencies)
+        text += " \\\n " + path;
+    text += "\n";
+    for (const std::string& path : dependencies)
+        text += "\n" + path + ":\n";
+
+    FILE *fp = std::fopen(depPath.c_str(), "rb");
+
+    if (fp != NULL)
+    {
+        std::string oldText;
+        char buffer[4096];
+        std::size_t count;
+
+        while ((count = std::fread(buffer, 1, sizeof(buffer), fp)) != 0)
+            oldText.append(buffer, count);
+        std::fclose(fp);
+
+        if (oldText == text)
+            return;
+    }
+
+    MakeParentDirs(depPath);
+
+    fp = std::fopen(depPath.c_str(), "wb");
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\" for writing.\n", depPath.c_str());
+
+    std::fwrite(text.data(), 1, text.size(), fp);
+    std::fclose(fp);
+}
+
+int main(int argc, char **argv)
+{
     std::vector<std::string> includeDirs;
+    std::vector<std::string> sourcePaths;
+    std::string objDir;
+    std::string cachePath;
+    bool batchMode = false;
+    bool printStats = false;
+    unsigned numThreads = std::thread::hardware_concurrency();
 
     argc--;
     argv++;
 
-    while (argc > 1)
+    while (argc > 0)
     {
         std::string arg(argv[0]);
         if (arg.substr(0, 2) == "-I")
@@ -60,6 +172,8 @@ int main(int argc, char **argv)
             {
                 argc--;
                 argv++;
+                if (argc == 0)
+                    FATAL_ERROR(USAGE);
                 includeDir = std::string(argv[0]);
             }
             if (!includeDir.empty() && includeDir.back() != '/')
@@ -68,61 +182,77 @@ int main(int argc, char **argv)
             }
             includeDirs.push_back(includeDir);
         }
-        else
+        else if (arg == "--stats")
+        {
+            printStats = true;
+        }
+        else if (arg == "-j")
+        {
+            argc--;
+            argv++;
+            if (argc == 0)
+                FATAL_ERROR(USAGE);
+            numThreads = std::strtoul(argv[0], NULL, 10);
+        }
+        else if (arg == "-M" || arg == "-c")
+        {
+            argc--;
+            argv++;
+            if (argc == 0)
+                FATAL_ERROR(USAGE);
+            if (arg == "-M")
+            {
+                objDir = std::string(argv[0]);
+                if (!objDir.empty() && objDir.back() != '/')
+                    objDir += '/';
+                batchMode = true;
+            }
+            else
+            {
+                cachePath = std::string(argv[0]);
+            }
+        }
+        else if (!arg.empty() && arg[0] == '-')
         {
             FATAL_ERROR(USAGE);
         }
+        else
+        {
+            sourcePaths.push_back(arg);
+        }
         argc--;
         argv++;
     }
 
-    if (argc != 1) {
+    if (batchMode ? sourcePaths.empty() : sourcePaths.size() != 1) {
         FATAL_ERROR(USAGE);
     }
 
-    std::string initialPath(argv[0]);
+    ScanCache cache;
 
-    filesToProcess.push(initialPath);
+    if (!cachePath.empty())
+        cache.Load(cachePath);
 
-    while (!filesToProcess.empty())
-    {
-        std::string filePath = filesToProcess.front();
-        SourceFile file(filePath);
-        filesToProcess.pop();
+    PrescanParallel(sourcePaths, includeDirs, cache, numThreads);
 
-        includeDirs.push_back(file.GetSrcDir());
-        for (auto incbin : file.GetIncbins())
+    if (!batchMode)
+    {
+        for (const std::string &path : ScanDependencies(sourcePaths[0], includeDirs, cache))
         {
-            dependencies.insert(incbin);
+            std::printf("%s\n", path.c_str());
         }
-        for (auto include : file.GetIncludes())
+    }
+    else
+    {
+        for (const std::string &sourcePath : sourcePaths)
         {
-            bool exists = false;
-            std::string path("");
-            for (auto includeDir : includeDirs)
-            {
-                path = includeDir + include;
-                if (CanOpenFile(path))
-                {
-                    exists = true;
-                    break;
-                }
-            }
-            if (!exists && (file.FileType() == SourceFileType::Asm || file.FileType() == SourceFileType::Inc))
-            {
-                path = include;
-            }
-            bool inserted = dependencies.insert(path).second;
-            if (inserted && exists)
-            {
-                filesToProcess.push(path);
-            }
+            WriteDepFile(objDir, sourcePath, ScanDependencies(sourcePath, includeDirs, cache));
         }
-        includeDirs.pop_back();
     }
 
-    for (const std::string &path : dependencies)
-    {
-        std::printf("%s\n", path.c_str());
-    }
+    if (!cachePath.empty())
+        cache.Save(cachePath);
+
+    if (printStats)
+        s_includeIndex.PrintStats(stderr);
 }
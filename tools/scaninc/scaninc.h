@@ -23,6 +23,8 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <string>
+#include <vector>
 
 #ifdef _MSC_VER
 
@@ -56,4 +58,6 @@ do {                                        \
 
 #define SCANINC_MAX_PATH 255
 
+bool ResolveInclude(const std::vector<std::string>& includeDirs, const std::string& srcDir, const std::string& include, std::string& path);
+
 #endif // SCANINC_H
@@ -35,6 +35,7 @@ enum class SourceFileType
 };
 
 SourceFileType GetFileType(std::string& path);
+std::string GetDir(std::string& path);
 
 class SourceFile
 {